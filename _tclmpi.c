@@ -36,7 +36,15 @@
 #include <mpi.h>
 #include <tcl.h>
 
+/* the shared state is protected by Tcl mutexes, which are no-ops otherwise */
+#ifndef TCL_THREADS
+#error "TclMPI must be compiled with -DTCL_THREADS=1"
+#endif
+
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /*! \page userguide TclMPI User's Guide
@@ -326,18 +334,20 @@
  * the first will broadcast the size of the data set being sent (so that
  * sufficiently sized buffers can be allocated) and then the second call
  * will finally send the data for real. Similarly, tclmpi::recv will be
- * converted into calling MPI_Probe() and then MPI_Recv() for the purpose
- * of determining the amount of temporary storage required. The second call
- * will also use the MPI_SOURCE and MPI_TAG flags from the MPI_Status object
- * created for MPI_Probe() to make certain, the correct data is received.
+ * converted into calling MPI_Mprobe() and then MPI_Mrecv() for the purpose
+ * of determining the amount of temporary storage required. The message
+ * handle from MPI_Mprobe() makes certain, that the probed message is
+ * the one that is received, even with tclmpi::any_source. With MPI
+ * versions before 3.0, MPI_Probe() and MPI_Recv() with the MPI_SOURCE
+ * and MPI_TAG from the MPI_Status object are used instead.
  *
  * Things get even more complicated with with non-blocking receives. Since
  * we need to know the size of the message to receive, a non-blocking receive
  * can only be posted, if the corresponding send is already pending. This is
- * being determined by calling MPI_Iprobe() and when this shows no (matching)
+ * being determined by calling MPI_Improbe() and when this shows no (matching)
  * pending message, the parameters for the receive will be cached and the
- * then MPI_Probe() followed by MPI_Recv() will be called as part of
- * tclmpi::wait. The blocking/non-blocking behavior of the Tcl script
+ * then MPI_Mprobe() followed by MPI_Imrecv() will be called as part of
+ * tclmpi::wait, unless the maximum size of the message is given. The blocking/non-blocking behavior of the Tcl script
  * should be very close to the corresponding C bindings, but probably not
  * as efficient.
  *
@@ -388,23 +398,75 @@
  * communicator to the list.
  * Correspondingly \ref tclmpi_del_comm will remove a communicator entry
  * from the lest, based on its Tcl string representation.
+ * Tcl objects holding a communicator name are converted to the
+ * "tclmpi::comm" type by \ref tclmpi_get_comm on first use, which caches
+ * the pointer to the list entry, so that later lookups do not need to
+ * search the list. The entry also caches rank and size of the communicator
+ * (see \ref tclmpi_comm_info).
  *
  * \subsection tclreq Mapping MPI Requests
  * MPI requests are represented in TclMPI by strings of the form
  * "tclmpi::req%d", with "%d" being replaced by a unique integer.
- * Internally this map is maintained in a simple linked list to which
- * new requests are appended and from which completed requests are
- * removed as needed.
+ * Internally this map is maintained in a hash table indexed by that
+ * integer, so that the cost of handling a request does not depend on
+ * the number of outstanding requests. The Tcl objects returned for
+ * requests are of the "tclmpi::request" type which caches the number,
+ * so that the string does not have to be parsed again.
  * The function \ref tclmpi_find_req is used to locate a specific request
- * and its associated data from its string label. In addition,
- * \ref tclmpi_add_req will  append a new request to the list, and
+ * and its associated data from its Tcl object. In addition,
+ * \ref tclmpi_add_req will add a new request to the table, and
  * \ref tclmpi_del_req will remove (completed) requests.
  *
+ * \subsection tclthread Thread Support
+ * By default MPI is initialized with MPI_THREAD_SINGLE. With
+ * "tclmpi::init -thread multiple" several interpreters of the Tcl Thread
+ * package can load TclMPI and communicate concurrently. The communicator
+ * list and the request table are shared by all interpreters, so that
+ * communicators and requests can be passed between threads as strings,
+ * and are protected by a mutex each. The data conversion error handler
+ * is kept per interpreter with Tcl_SetAssocData() (see
+ * \ref tclmpi_interp_state) and the handlers of the event source for
+ * tclmpi::onmessage and tclmpi::oncomplete are kept per thread, since
+ * each thread runs its own Tcl event loop.
+ * With "tclmpi::init -progress <usec>" an additional background thread
+ * periodically calls into MPI, so that outstanding transfers progress
+ * while the script computes (see \ref tclmpi_progress_proc).
+ *
  * \subsection tcldata Mapping Data Types
  * The helper function \ref tclmpi_datatype is used to convert string
  * constants representing specific data types into integer constants
- * for convenient branching. Data types in TclMPI are somewhat different
+ * for convenient branching. Like \ref tclmpi_get_op for reduction
+ * operators, it uses Tcl_GetIndexFromObj() so that the result is cached
+ * in the Tcl object holding the constant and the string comparisons are
+ * only needed the first time. Data types in TclMPI are somewhat different
  * from MPI data types to match better the spirit of Tcl scripting.
+ * For example, tclmpi::auto transfers the string representation of
+ * a Tcl object, while tclmpi::bytes transfers its byte array representation
+ * as MPI_BYTE without any intermediate buffer.
+ *
+ * \subsection tclvec Native Data Vectors
+ * Data of type tclmpi::int or tclmpi::double that is received or
+ * computed by TclMPI commands is returned as a Tcl object of the custom
+ * type "tclmpi::vector". Its internal representation is a contiguous,
+ * reference counted block of native data that is used directly as MPI
+ * receive buffer, and its string representation, which looks exactly like
+ * a list of numbers, is only generated when the script accesses it.
+ * When such an object is passed to another TclMPI command with a matching
+ * data type, its data is handed to MPI without any per-element conversion.
+ * With Tcl 9 the type implements the abstract list interface, so that
+ * llength, lindex, lrange and lreverse operate on the native data and
+ * only create Tcl objects for the elements that are actually used.
+ * Tcl 8.6 has no abstract lists, so vectors handed to a script are
+ * converted into regular Tcl lists directly from the native data
+ * (see \ref tclmpi_vec_result).
+ * The function \ref tclmpi_new_vector creates a new vector object and
+ * \ref tclmpi_get_vector provides a vector for any data argument,
+ * converting Tcl lists as needed while honoring the conversion
+ * error handler. List elements that already are integers or doubles
+ * are read directly from their internal representation. Since this does
+ * not call into Tcl, very large lists are split over several threads
+ * when enabled with "tclmpi::init -convthreads <num>" (see
+ * \ref tclmpi_conv_fast).
  *
  * \subsection tclerr Common Error Message Processing
  * There is a significant redundancy in checking for and reporting
@@ -446,6 +508,8 @@ struct tclmpi_comm {
     const char *label;   /*!< String representing the communicator in Tcl */
     MPI_Comm comm;       /*!< MPI communicator corresponding of this entry */
     int valid;           /*!< Non-zero if communicator is valid */
+    int rank;            /*!< Cached rank on the communicator or -1 */
+    int size;            /*!< Cached size of the communicator or -1 */
     tclmpi_comm_t *next; /*!< Pointer to next element in linked list */
 };
 
@@ -455,6 +519,10 @@ static tclmpi_comm_t *first_comm = NULL;
 static tclmpi_comm_t *last_comm = NULL;
 /*! Communicator counter. Incremented to get unique strings */
 static int tclmpi_comm_cntr = 0;
+/*! Communicator generation. Incremented when a communicator is freed */
+static int tclmpi_comm_gen = 0;
+/*! Mutex protecting the communicator map list across threads */
+TCL_DECLARE_MUTEX(tclmpi_comm_mutex)
 /*! Size of stringbuffer for tclmpi labels */
 #define TCLMPI_LABEL_SIZE 32
 
@@ -468,7 +536,7 @@ static MPI_Comm MPI_COMM_INVALID;
  * This function will search through the linked list of known communicators
  * until it finds the (first) match and then returns the string label to
  * the calling function. If a NULL is returned, the communicator does not
- * yet exist in the linked list.
+ * yet exist in the linked list. Must be called with tclmpi_comm_mutex held.
  */
 static const char *mpi2tcl_comm(MPI_Comm comm)
 {
@@ -489,32 +557,106 @@ static const char *mpi2tcl_comm(MPI_Comm comm)
     return NULL;
 }
 
-/*! Translate a Tcl communicator label into the MPI communicator it represents.
- * \param label the Tcl name for the communicator
- * \return the matching MPI communicator or MPI_COMM_INVALID
+/*! Tcl object type for communicators.
  *
- * This function will search through the linked list of known communicators
- * until it finds the (first) match and then returns the string label to
- * the calling function. If a NULL is returned, the communicator does not
- * yet exist in the linked list.
+ * The internal representation caches a pointer to the linked list entry
+ * of the communicator and the value of tclmpi_comm_gen at the time it was
+ * cached. Since entries are only ever removed by TclMPI_Comm_free, which
+ * increments tclmpi_comm_gen, a cached pointer with the current generation
+ * is always valid. The string representation is never invalidated, so
+ * no updateStringProc is needed. */
+static const Tcl_ObjType tclmpi_comm_type = {
+    "tclmpi::comm", /* name */
+    NULL,           /* freeIntRepProc */
+    NULL,           /* dupIntRepProc */
+    NULL,           /* updateStringProc */
+    NULL,           /* setFromAnyProc */
+};
+
+/*! Translate a Tcl communicator object into its linked list entry.
+ * \param obj the Tcl object with the name of the communicator
+ * \return pointer to the matching entry or NULL.
+ *
+ * If the object does not yet have a valid cached entry, this function
+ * will search through the linked list of known communicators until it
+ * finds the (first) match and then caches it in the Tcl object, so that
+ * subsequent lookups only need to dereference a pointer. If a NULL is
+ * returned, the communicator does not exist in the linked list.
+ * Must be called with tclmpi_comm_mutex held, since the generation
+ * and the entries are shared by all threads.
  */
-static MPI_Comm tcl2mpi_comm(const char *label)
+static tclmpi_comm_t *tclmpi_get_comm(Tcl_Obj *obj)
 {
     tclmpi_comm_t *next;
+    const char *label;
 
-    next = first_comm;
+    if ((obj->typePtr == &tclmpi_comm_type) && ((size_t)obj->internalRep.twoPtrValue.ptr2 == (size_t)tclmpi_comm_gen))
+        return (tclmpi_comm_t *)obj->internalRep.twoPtrValue.ptr1;
+
+    label = Tcl_GetString(obj);
+    next  = first_comm;
     while (next) {
-        if (strcmp(next->label, label) == 0) {
-            if (next->valid != 0) {
-                return next->comm;
-            } else {
-                return MPI_COMM_INVALID;
-            }
-        } else {
-            next = next->next;
-        }
+        if (strcmp(next->label, label) == 0) break;
+        next = next->next;
+    }
+    if (next == NULL) return NULL;
+
+    if (obj->typePtr && obj->typePtr->freeIntRepProc) obj->typePtr->freeIntRepProc(obj);
+    obj->internalRep.twoPtrValue.ptr1 = next;
+    obj->internalRep.twoPtrValue.ptr2 = (void *)(size_t)tclmpi_comm_gen;
+    obj->typePtr                      = &tclmpi_comm_type;
+    return next;
+}
+
+/*! Translate a Tcl communicator object into the MPI communicator it represents.
+ * \param obj the Tcl object with the name of the communicator
+ * \return the matching MPI communicator or MPI_COMM_INVALID
+ *
+ * This function looks up the communicator via tclmpi_get_comm and returns
+ * the corresponding MPI communicator, if the entry is valid.
+ */
+static MPI_Comm tcl2mpi_comm(Tcl_Obj *obj)
+{
+    tclmpi_comm_t *entry;
+    MPI_Comm comm = MPI_COMM_INVALID;
+
+    Tcl_MutexLock(&tclmpi_comm_mutex);
+    entry = tclmpi_get_comm(obj);
+    if ((entry != NULL) && (entry->valid != 0)) comm = entry->comm;
+    Tcl_MutexUnlock(&tclmpi_comm_mutex);
+    return comm;
+}
+
+/*! Get rank and size of the process on a communicator
+ * \param obj the Tcl object with the name of the communicator
+ * \param rank pointer to location for storing the rank or NULL
+ * \param size pointer to location for storing the size or NULL
+ * \return MPI_SUCCESS or an MPI error code
+ *
+ * Rank and size cannot change during the lifetime of a communicator,
+ * so they are only queried from MPI the first time they are needed
+ * and cached in the linked list entry afterwards.
+ */
+static int tclmpi_comm_info(Tcl_Obj *obj, int *rank, int *size)
+{
+    tclmpi_comm_t *entry;
+    int ierr = MPI_SUCCESS;
+
+    Tcl_MutexLock(&tclmpi_comm_mutex);
+    entry = tclmpi_get_comm(obj);
+    if (entry == NULL) {
+        ierr = MPI_ERR_COMM;
+    } else if (entry->size < 0) {
+        ierr = MPI_Comm_size(entry->comm, &entry->size);
+        if (ierr == MPI_SUCCESS) ierr = MPI_Comm_rank(entry->comm, &entry->rank);
+        if (ierr != MPI_SUCCESS) entry->size = entry->rank = -1;
     }
-    return MPI_COMM_INVALID;
+    if (ierr == MPI_SUCCESS) {
+        if (rank) *rank = entry->rank;
+        if (size) *size = entry->size;
+    }
+    Tcl_MutexUnlock(&tclmpi_comm_mutex);
+    return ierr;
 }
 
 /*! Add an MPI communicator to the linked list of communicators, if needed.
@@ -534,19 +676,26 @@ static const char *tclmpi_add_comm(MPI_Comm comm)
     char *label;
     const char *oldlabel;
 
+    Tcl_MutexLock(&tclmpi_comm_mutex);
     oldlabel = mpi2tcl_comm(comm);
-    if (oldlabel != NULL) return oldlabel;
+    if (oldlabel != NULL) {
+        Tcl_MutexUnlock(&tclmpi_comm_mutex);
+        return oldlabel;
+    }
 
     next        = (tclmpi_comm_t *)Tcl_Alloc(sizeof(tclmpi_comm_t));
     next->next  = NULL;
     next->comm  = comm;
     next->valid = 1;
+    next->rank  = -1;
+    next->size  = -1;
     label       = (char *)Tcl_Alloc(TCLMPI_LABEL_SIZE);
     snprintf(label, TCLMPI_LABEL_SIZE, "tclmpi::comm%d", tclmpi_comm_cntr);
     next->label = label;
     ++tclmpi_comm_cntr;
     last_comm->next = next;
     last_comm       = next;
+    Tcl_MutexUnlock(&tclmpi_comm_mutex);
     return next->label;
 }
 
@@ -556,20 +705,22 @@ static const char *tclmpi_add_comm(MPI_Comm comm)
  *
  * This function will find the entry in the linked list that matches
  * the Tcl label string, remove it and free the associated resources.
+ * Incrementing tclmpi_comm_gen invalidates all cached entries in Tcl
+ * objects of the "tclmpi::comm" type.
  */
 static int tclmpi_del_comm(const char *label)
 {
     tclmpi_comm_t *next, *prev;
 
+    Tcl_MutexLock(&tclmpi_comm_mutex);
     prev = first_comm;
-    if (prev->next != NULL)
-        next = prev->next;
-    else
-        return TCL_ERROR;
-
+    next = prev->next;
     while (next) {
         if (strcmp(label, next->label) == 0) {
             prev->next = next->next;
+            if (last_comm == next) last_comm = prev;
+            ++tclmpi_comm_gen;
+            Tcl_MutexUnlock(&tclmpi_comm_mutex);
             Tcl_Free((char *)next->label);
             Tcl_Free((char *)next);
             return TCL_OK;
@@ -577,6 +728,7 @@ static int tclmpi_del_comm(const char *label)
         prev = next;
         next = next->next;
     }
+    Tcl_MutexUnlock(&tclmpi_comm_mutex);
     return TCL_ERROR;
 }
 
@@ -608,77 +760,154 @@ struct tclmpi_intint {
 #define TCLMPI_INT_INT 3    /*!< data type for pairs of integers */
 #define TCLMPI_DOUBLE 4     /*!< floating point data type */
 #define TCLMPI_DOUBLE_INT 5 /*!< data type for double/integer pair */
+#define TCLMPI_BYTES 6      /*!< binary data in a Tcl byte array */
+
+/*! Size of the payload in bytes that TclMPI_Bcast sends together with
+ *  the length of the data, so that small messages need one broadcast */
+#define TCLMPI_EAGER_SIZE 1024
+/*! Size of the payload in bytes per process that TclMPI_Scatter and
+ *  TclMPI_Allgather send together with the length of the data */
+#define TCLMPI_EAGER_SLOT 64
+
+#define TCLMPI_SCAN 0           /*!< inclusive prefix reduction */
+#define TCLMPI_EXSCAN 1         /*!< exclusive prefix reduction */
+#define TCLMPI_REDUCE_SCATTER 2 /*!< reduction scattered in equal blocks */
+
+#define TCLMPI_SEND_INIT 1 /*!< persistent send request */
+#define TCLMPI_RECV_INIT 2 /*!< persistent receive request */
+
+#define TCLMPI_POLL_MIN 100   /*!< shortest interval for polling MPI events in microseconds */
+#define TCLMPI_POLL_MAX 20000 /*!< longest interval for polling MPI events in microseconds */
+
+/*! Message type for sending the length of the data with an eager payload */
+typedef struct tclmpi_eager tclmpi_eager_t;
+/*! Length of the data followed by the data, if it is small enough */
+struct tclmpi_eager {
+    int len;                      /*!< number of data items */
+    int type;                     /*!< TclMPI data type of the data items */
+    char data[TCLMPI_EAGER_SLOT]; /*!< data items, if they fit */
+};
 
-/*! Translate TclMPI strings to MPI constants for reductions
- * \param opstr string constant describing the operator
+/*! Names of the TclMPI reduction operators in the order of tclmpi_get_op */
+static const char *const tclmpi_opnames[] = {"tclmpi::max",  "tclmpi::min",  "tclmpi::sum",    "tclmpi::prod",
+                                             "tclmpi::land", "tclmpi::band", "tclmpi::lor",    "tclmpi::bor",
+                                             "tclmpi::lxor", "tclmpi::bxor", "tclmpi::maxloc", "tclmpi::minloc",
+                                             NULL};
+
+/*! Translate TclMPI constants to MPI constants for reductions
+ * \param obj Tcl object with the string constant describing the operator
  * \param op pointer to location for storing the MPI constant
  * \return TCL_OK if the string was recognized else TCL_ERROR
  *
  * This is a convenience function to consistently convert
  * TclMPI string constants representing reduction operators
- * to their corresponding MPI counterparts.
+ * to their corresponding MPI counterparts. The string is looked up
+ * with Tcl_GetIndexFromObj(), which caches the result in the Tcl
+ * object, so that the string comparisons are only done once.
  */
-static int tclmpi_get_op(const char *opstr, MPI_Op *op)
+static int tclmpi_get_op(Tcl_Obj *obj, MPI_Op *op)
 {
-    if (op == NULL) return TCL_ERROR;
+    MPI_Op ops[] = {MPI_MAX, MPI_MIN, MPI_SUM,  MPI_PROD, MPI_LAND,   MPI_BAND,
+                    MPI_LOR, MPI_BOR, MPI_LXOR, MPI_BXOR, MPI_MAXLOC, MPI_MINLOC};
+    int idx;
 
-    if (strcmp(opstr, "tclmpi::max") == 0)
-        *op = MPI_MAX;
-    else if (strcmp(opstr, "tclmpi::min") == 0)
-        *op = MPI_MIN;
-    else if (strcmp(opstr, "tclmpi::sum") == 0)
-        *op = MPI_SUM;
-    else if (strcmp(opstr, "tclmpi::prod") == 0)
-        *op = MPI_PROD;
-    else if (strcmp(opstr, "tclmpi::land") == 0)
-        *op = MPI_LAND;
-    else if (strcmp(opstr, "tclmpi::band") == 0)
-        *op = MPI_BAND;
-    else if (strcmp(opstr, "tclmpi::lor") == 0)
-        *op = MPI_LOR;
-    else if (strcmp(opstr, "tclmpi::bor") == 0)
-        *op = MPI_BOR;
-    else if (strcmp(opstr, "tclmpi::lxor") == 0)
-        *op = MPI_LXOR;
-    else if (strcmp(opstr, "tclmpi::bxor") == 0)
-        *op = MPI_BXOR;
-    else if (strcmp(opstr, "tclmpi::maxloc") == 0)
-        *op = MPI_MAXLOC;
-    else if (strcmp(opstr, "tclmpi::minloc") == 0)
-        *op = MPI_MINLOC;
-    else
-        return TCL_ERROR;
+    if (op == NULL) return TCL_ERROR;
+    if (Tcl_GetIndexFromObj(NULL, obj, tclmpi_opnames, "operator", TCL_EXACT, &idx) != TCL_OK) return TCL_ERROR;
 
+    *op = ops[idx];
     return TCL_OK;
 }
 
 /* translate MPI requests to Tcl strings and back "tclmpi::req%d" */
 
-/*! Linked list entry type for managing MPI requests */
+/*! Hash table entry type for managing MPI requests */
 typedef struct tclmpi_req tclmpi_req_t;
 
-/*! Linked list entry to map MPI requests to "tclmpi::req%d" strings. */
+/*! Hash table entry to map MPI requests to "tclmpi::req%d" strings. */
 struct tclmpi_req {
-    const char *label;  /*!< identifier of this request */
-    void *data;         /*!< pointer to send or receive data buffer */
-    int len;            /*!< size of data block */
-    int type;           /*!< data type of send data */
-    int source;         /*!< source rank of non-blocking receive */
-    int tag;            /*!< tag selector of non-blocking receive */
-    MPI_Request *req;   /*!< pointer MPI request handle generated by MPI */
-    MPI_Comm comm;      /*!< communicator for non-blocking receive */
-    tclmpi_req_t *next; /*!< pointer to next struct */
+    int id;              /*!< unique number of this request */
+    void *data;          /*!< pointer to send or receive data buffer */
+    int len;             /*!< size of data block */
+    int type;            /*!< data type of send data */
+    int source;          /*!< source rank of non-blocking receive */
+    int tag;             /*!< tag selector of non-blocking receive */
+    MPI_Request *req;    /*!< pointer to the MPI request handle, points to handle */
+    MPI_Request handle;  /*!< storage for the MPI request handle generated by MPI */
+    MPI_Comm comm;       /*!< communicator for non-blocking receive */
+    Tcl_Obj *obj;        /*!< Tcl object owning the receive buffer or NULL */
+    Tcl_Obj *sobj;       /*!< Tcl object owning the send buffer or NULL */
+    int coll;            /*!< non-zero for non-blocking collectives */
+    int persist;         /*!< kind of persistent request or 0 */
+    int active;          /*!< non-zero while a persistent request is started */
+    int listed;          /*!< non-zero while a list of requests is checked for duplicates */
+    Tcl_HashEntry *hash; /*!< pointer to hash table entry of this request */
+    tclmpi_req_t *next;  /*!< next unused request in the request pool */
 };
 
-/*! First element of the list of generated requests */
-static tclmpi_req_t *first_req = NULL;
+/*! Table of generated requests indexed by their unique number */
+static Tcl_HashTable tclmpi_req_table;
+/*! Flag indicating whether the request table has been initialized by tclmpi_init_api */
+static int tclmpi_req_init = 0;
 /*! Request counter. Incremented to get unique strings */
 static int tclmpi_req_cntr = 0;
+/*! Mutex protecting the request table and counter across threads */
+TCL_DECLARE_MUTEX(tclmpi_req_mutex)
+/*! Number of request structs allocated at once for the request pool */
+#define TCLMPI_REQ_SLAB 64
+/*! Linked list of unused request structs */
+static tclmpi_req_t *tclmpi_req_pool = NULL;
+
+/*! Per interpreter state of TclMPI */
+typedef struct tclmpi_interp tclmpi_interp_t;
+
+/*! State that is private to each interpreter that loaded TclMPI */
+struct tclmpi_interp {
+    int conv_handler;    /*!< what to do when a data element cannot be converted. default is TCLMPI_ERROR */
+    char *scratch;       /*!< scratch buffer for temporary data of blocking calls */
+    size_t scratch_size; /*!< size of the scratch buffer in bytes */
+};
+
+/*! Key for the per interpreter state stored with Tcl_SetAssocData() */
+#define TCLMPI_ASSOC_KEY "tclmpi"
+
+/*! Get the TclMPI state of an interpreter
+ * \param interp current Tcl interpreter
+ * \return pointer to the state attached to the interpreter
+ */
+static tclmpi_interp_t *tclmpi_interp_state(Tcl_Interp *interp)
+{
+    return (tclmpi_interp_t *)Tcl_GetAssocData(interp, TCLMPI_ASSOC_KEY, NULL);
+}
 
-/*! Selects what to do when a data element in a list cannot
- *  be successfully converted to the desired data type.
- *  Default is to throw a Tcl error. */
-static int tclmpi_conv_handler = TCLMPI_ERROR;
+/*! Minimum size of the scratch buffer in bytes */
+#define TCLMPI_SCRATCH_MIN 4096
+/*! Round up the size of a part of the scratch buffer for alignment */
+#define TCLMPI_SCRATCH_ALIGN(size) (((size) + 15) & ~(size_t)15)
+
+/*! Get the scratch buffer of an interpreter
+ * \param interp current Tcl interpreter
+ * \param size required size of the buffer in bytes
+ * \return pointer to the scratch buffer
+ *
+ * Blocking calls need temporary storage only until they return. Instead
+ * of allocating and freeing it for every call, each interpreter keeps a
+ * scratch buffer that only grows to the largest size requested so far.
+ * Its contents are not preserved when it grows. The buffer may only be
+ * used by one function at a time and not across evaluating Tcl code.
+ * It is released when the interpreter is deleted.
+ */
+static void *tclmpi_scratch(Tcl_Interp *interp, size_t size)
+{
+    tclmpi_interp_t *state = tclmpi_interp_state(interp);
+
+    if (size < TCLMPI_SCRATCH_MIN) size = TCLMPI_SCRATCH_MIN;
+    if (size > state->scratch_size) {
+        if (state->scratch) Tcl_Free(state->scratch);
+        state->scratch      = Tcl_Alloc(size);
+        state->scratch_size = size;
+    }
+    return state->scratch;
+}
 
 /*! Data conversion with with error handling
  * \param type Tcl data type for calling Tcl_Get<Type>FromObj()
@@ -687,7 +916,7 @@ static int tclmpi_conv_handler = TCLMPI_ERROR;
  * \param assign target to assign a zero to for TCLMPI_TOZERO
  *
  * This macro enables consistent handling of data conversions.
- * It also queries the tclmpi_conv_handler variable to jump to
+ * It also queries the conversion handler of the interpreter to jump to
  * the selected conversion error behavior. For TCLMPI_ERROR
  * (the default) a Tcl error is raised and TclMPI returns to
  * the calling function. For TCLMPI_ABORT and error message
@@ -697,10 +926,11 @@ static int tclmpi_conv_handler = TCLMPI_ERROR;
  * in as assign parameter is set to zero. */
 #define TCLMPI_CONV_CHECK(type, in, out, assign)                                               \
     if (Tcl_Get##type##FromObj(interp, in, out) != TCL_OK) {                                   \
-        if (tclmpi_conv_handler == TCLMPI_TOZERO) {                                            \
+        int handler = tclmpi_interp_state(interp)->conv_handler;                               \
+        if (handler == TCLMPI_TOZERO) {                                                        \
             Tcl_ResetResult(interp);                                                           \
             assign = 0;                                                                        \
-        } else if (tclmpi_conv_handler == TCLMPI_ABORT) {                                      \
+        } else if (handler == TCLMPI_ABORT) {                                                  \
             fprintf(stderr, "Error on data element %d: %s\n", i, Tcl_GetStringResult(interp)); \
             MPI_Abort(comm, i);                                                                \
         } else {                                                                               \
@@ -708,130 +938,225 @@ static int tclmpi_conv_handler = TCLMPI_ERROR;
         }                                                                                      \
     }
 
-/*! Allocate and add an entry to the request map linked list
- * \return the corresponding string label or NULL.
+/*! Generate the string representation of a "tclmpi::request" object
+ * \param obj pointer to Tcl object
+ */
+static void tclmpi_req_string(Tcl_Obj *obj)
+{
+    char label[TCLMPI_LABEL_SIZE];
+
+    obj->length = snprintf(label, TCLMPI_LABEL_SIZE, "tclmpi::req%ld", obj->internalRep.longValue);
+    obj->bytes  = Tcl_Alloc(obj->length + 1);
+    memcpy(obj->bytes, label, obj->length + 1);
+}
+
+/*! Convert a Tcl object to the "tclmpi::request" type
+ * \param interp current Tcl interpreter or NULL
+ * \param obj pointer to Tcl object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * Only strings of the form "tclmpi::req%d" can be converted. The number
+ * is cached in the internal representation, so that looking up requests
+ * later does not require parsing the string again.
+ */
+static int tclmpi_req_from_any(Tcl_Interp *interp, Tcl_Obj *obj);
+
+/*! Tcl object type for request handles. */
+static const Tcl_ObjType tclmpi_request_type = {
+    "tclmpi::request",   /* name */
+    NULL,                /* freeIntRepProc */
+    NULL,                /* dupIntRepProc */
+    tclmpi_req_string,   /* updateStringProc */
+    tclmpi_req_from_any, /* setFromAnyProc */
+};
+
+static int tclmpi_req_from_any(Tcl_Interp *interp, Tcl_Obj *obj)
+{
+    const char *label, *num;
+    char *end;
+    long id;
+
+    label = Tcl_GetString(obj);
+    if (strncmp(label, "tclmpi::req", 11) != 0) return TCL_ERROR;
+    num = label + 11;
+    if ((*num < '0') || (*num > '9')) return TCL_ERROR;
+    id = strtol(num, &end, 10);
+    if (*end != '\0') return TCL_ERROR;
+
+    if (obj->typePtr && obj->typePtr->freeIntRepProc) obj->typePtr->freeIntRepProc(obj);
+    obj->internalRep.longValue = id;
+    obj->typePtr               = &tclmpi_request_type;
+    return TCL_OK;
+}
+
+/*! Allocate and add an entry to the request map hash table
+ * \return a pointer to the new tclmpi_req_t structure or NULL.
  *
- * This function will allocate and initialize a new linked list entry
+ * This function will allocate and initialize a new hash table entry
  * for the translation between MPI requests and their string
- * representation passed to Tcl scripts. The assigned label of the
- * for "tclmpi::req%d" will be returned. The (global/static) variable
- * tclmpi_req_cntr is incremented every time to make the communicator
- * label unique.
+ * representation passed to Tcl scripts. The (global/static) variable
+ * tclmpi_req_cntr is incremented every time to make the request
+ * number unique. The hash table is keyed by this number, so that
+ * adding, finding, and removing a request takes constant time
+ * independent of the number of outstanding requests.
+ *
+ * The request structs are taken from a pool, that is refilled with
+ * TCLMPI_REQ_SLAB structs at a time, and tclmpi_del_req returns them
+ * to the pool. The MPI request handle is stored in the struct itself.
+ * So creating a request usually does not need any memory allocation.
  */
-static const char *tclmpi_add_req()
+static tclmpi_req_t *tclmpi_add_req()
 {
     tclmpi_req_t *next;
-    char *label;
-
-    next = (tclmpi_req_t *)Tcl_Alloc(sizeof(tclmpi_req_t));
-    if (next == NULL) return NULL;
-    memset(next, 0, sizeof(tclmpi_req_t));
-
-    next->req = (MPI_Request *)Tcl_Alloc(sizeof(MPI_Request));
-    if (next->req == NULL) {
-        Tcl_Free((char *)next);
-        return NULL;
+    int i, isnew;
+
+    Tcl_MutexLock(&tclmpi_req_mutex);
+    if (tclmpi_req_pool == NULL) {
+        tclmpi_req_t *slab = (tclmpi_req_t *)Tcl_Alloc(TCLMPI_REQ_SLAB * sizeof(tclmpi_req_t));
+        if (slab == NULL) {
+            Tcl_MutexUnlock(&tclmpi_req_mutex);
+            return NULL;
+        }
+        for (i = 0; i < TCLMPI_REQ_SLAB; ++i) {
+            slab[i].next    = tclmpi_req_pool;
+            tclmpi_req_pool = slab + i;
+        }
     }
+    next            = tclmpi_req_pool;
+    tclmpi_req_pool = next->next;
+    memset(next, 0, sizeof(tclmpi_req_t));
 
-    label = (char *)Tcl_Alloc(TCLMPI_LABEL_SIZE);
-    if (label == NULL) {
-        Tcl_Free((char *)next->req);
-        Tcl_Free((char *)next);
-        return NULL;
-    }
+    next->req    = &next->handle;
+    next->handle = MPI_REQUEST_NULL;
+    next->type   = TCLMPI_NONE;
+    next->len    = TCLMPI_INVALID;
 
-    snprintf(label, TCLMPI_LABEL_SIZE, "tclmpi::req%d", tclmpi_req_cntr);
-    next->label = label;
-    next->type  = TCLMPI_NONE;
-    next->len   = TCLMPI_INVALID;
+    next->id   = tclmpi_req_cntr;
+    next->hash = Tcl_CreateHashEntry(&tclmpi_req_table, (const char *)(size_t)next->id, &isnew);
+    Tcl_SetHashValue(next->hash, next);
     ++tclmpi_req_cntr;
+    Tcl_MutexUnlock(&tclmpi_req_mutex);
 
-    if (first_req == NULL) {
-        first_req = next;
-    } else {
-        tclmpi_req_t *req;
-        req = first_req;
-        while (req->next) req = req->next;
-        req->next = next;
-    }
+    return next;
+}
 
-    return next->label;
+/*! create a Tcl object representing a request
+ * \param req pointer to the tclmpi_req_t structure of the request
+ * \return a new Tcl object of type "tclmpi::request"
+ *
+ * The string representation "tclmpi::req%d" is generated on demand.
+ */
+static Tcl_Obj *tclmpi_req_obj(tclmpi_req_t *req)
+{
+    Tcl_Obj *obj = Tcl_NewObj();
+
+    Tcl_InvalidateStringRep(obj);
+    obj->internalRep.longValue = req->id;
+    obj->typePtr               = &tclmpi_request_type;
+    return obj;
+}
+
+/*! look up a request by its unique number
+ * \param id unique number of the request
+ * \return a pointer to the matching tclmpi_req_t structure or NULL
+ */
+static tclmpi_req_t *tclmpi_get_req(int id)
+{
+    Tcl_HashEntry *entry;
+    tclmpi_req_t *req = NULL;
+
+    Tcl_MutexLock(&tclmpi_req_mutex);
+    entry = Tcl_FindHashEntry(&tclmpi_req_table, (const char *)(size_t)id);
+    if (entry != NULL) req = (tclmpi_req_t *)Tcl_GetHashValue(entry);
+    Tcl_MutexUnlock(&tclmpi_req_mutex);
+    return req;
 }
 
 /*! translate Tcl representation of an MPI request to request itself.
- * \param label the Tcl name for the communicator
+ * \param obj the Tcl object with the name of the request
  * \return a pointer to the matching tclmpi_req_t structure
  *
- * This function will search through the linked list of known MPI requests
- * until it finds the (first) match and then returns a pointer to this data.
- * If NULL is returned, the communicator does not exist in the linked list.
+ * This function will convert the Tcl object to a request handle, if
+ * needed, and then look up the request by its number in the hash table.
+ * If NULL is returned, the request does not exist (anymore).
  */
-static tclmpi_req_t *tclmpi_find_req(const char *label)
+static tclmpi_req_t *tclmpi_find_req(Tcl_Obj *obj)
 {
-    tclmpi_req_t *req;
-
-    req = first_req;
-    while (req) {
-        if (strcmp(req->label, label) == 0)
-            return req;
-        else
-            req = req->next;
+    if (obj->typePtr != &tclmpi_request_type) {
+        if (Tcl_ConvertToType(NULL, obj, &tclmpi_request_type) != TCL_OK) return NULL;
     }
-    return NULL;
+    return tclmpi_get_req(obj->internalRep.longValue);
 }
 
-/*! remove tclmpi_req_t entry from the request linked list
+/*! remove tclmpi_req_t entry from the request hash table
  * \param req a pointer to the request in question
  * \return TCL_OK on succes, TCL_ERROR on failure
  *
- * This function will search through the linked list of known MPI requests
- * until it finds the (first) match and then will remove it from the linked
- * and free the allocated storage.
- * If TCL_ERROR is returned, the request did not exist in the linked list.
+ * This function will remove the request from the hash table, free the
+ * data buffer, or the references to the Tcl objects that own the data
+ * buffers, and return the request struct to the request pool.
  */
 static int tclmpi_del_req(tclmpi_req_t *req)
 {
     if (req == NULL) return TCL_ERROR;
 
-    if (req == first_req) {
-        first_req = req->next;
-        return TCL_OK;
-    } else {
-        tclmpi_req_t *prev = first_req;
-        while (prev->next) {
-            if (prev->next == req) {
-                prev->next = prev->next->next;
-                Tcl_Free((char *)req->label);
-                Tcl_Free((char *)req->req);
-                Tcl_Free((char *)req);
-                return TCL_OK;
-            }
-            prev = prev->next;
-        }
-    }
-    return TCL_ERROR;
+    Tcl_MutexLock(&tclmpi_req_mutex);
+    Tcl_DeleteHashEntry(req->hash);
+    Tcl_MutexUnlock(&tclmpi_req_mutex);
+
+    /* release the data buffer or the Tcl objects that own them */
+    if (req->sobj) Tcl_DecrRefCount(req->sobj);
+    if (req->obj)
+        Tcl_DecrRefCount(req->obj);
+    else if (req->data)
+        Tcl_Free((char *)req->data);
+
+    Tcl_MutexLock(&tclmpi_req_mutex);
+    req->next       = tclmpi_req_pool;
+    tclmpi_req_pool = req;
+    Tcl_MutexUnlock(&tclmpi_req_mutex);
+    return TCL_OK;
+}
+
+/*! Names of the TclMPI data types in the order of tclmpi_typecodes */
+static const char *const tclmpi_typenames[] = {"tclmpi::int",  "tclmpi::double", "tclmpi::dblint", "tclmpi::intint",
+                                               "tclmpi::auto", "tclmpi::bytes",  NULL};
+/*! Numeric representations of the TclMPI data types in tclmpi_typenames */
+static const int tclmpi_typecodes[] = {TCLMPI_INT,  TCLMPI_DOUBLE, TCLMPI_DOUBLE_INT, TCLMPI_INT_INT,
+                                       TCLMPI_AUTO, TCLMPI_BYTES};
+
+/*! convert a Tcl object describing a data type to a numeric representation
+ *
+ * The lookup is done with Tcl_GetIndexFromObj(), which caches the result
+ * in the Tcl object, so that repeated calls with the same constant only
+ * need to read the internal representation. */
+static int tclmpi_datatype(Tcl_Obj *obj)
+{
+    int idx;
+
+    if (Tcl_GetIndexFromObj(NULL, obj, tclmpi_typenames, "type", TCL_EXACT, &idx) != TCL_OK) return TCLMPI_NONE;
+    return tclmpi_typecodes[idx];
 }
 
-/*! convert a string describing a data type to a numeric representation */
-static int tclmpi_datatype(const char *type)
+/*! convert a TclMPI data type constant into the matching MPI data type */
+static MPI_Datatype tclmpi_mpitype(int type)
 {
-    if (strcmp(type, "tclmpi::int") == 0)
-        return TCLMPI_INT;
-    else if (strcmp(type, "tclmpi::double") == 0)
-        return TCLMPI_DOUBLE;
-    else if (strcmp(type, "tclmpi::dblint") == 0)
-        return TCLMPI_DOUBLE_INT;
-    else if (strcmp(type, "tclmpi::intint") == 0)
-        return TCLMPI_INT_INT;
-    else if (strcmp(type, "tclmpi::auto") == 0)
-        return TCLMPI_AUTO;
+    if (type == TCLMPI_AUTO)
+        return MPI_CHAR;
+    else if (type == TCLMPI_BYTES)
+        return MPI_BYTE;
+    else if (type == TCLMPI_INT)
+        return MPI_INT;
+    else if (type == TCLMPI_INT_INT)
+        return MPI_2INT;
+    else if (type == TCLMPI_DOUBLE)
+        return MPI_DOUBLE;
+    else if (type == TCLMPI_DOUBLE_INT)
+        return MPI_DOUBLE_INT;
     else
-        return TCLMPI_NONE;
+        return MPI_DATATYPE_NULL;
 }
 
-/*! buffer for error messages. */
-static char tclmpi_errmsg[MPI_MAX_ERROR_STRING];
-
 /*! convert MPI error code to Tcl error error message and append to result
  * \param interp current Tcl interpreter
  * \param ierr MPI error number. return value of an MPI call.
@@ -849,10 +1174,11 @@ static char tclmpi_errmsg[MPI_MAX_ERROR_STRING];
 static int tclmpi_errcheck(Tcl_Interp *interp, int ierr, Tcl_Obj *obj)
 {
     if (ierr != MPI_SUCCESS) {
+        char errmsg[MPI_MAX_ERROR_STRING];
         int len, eclass;
         MPI_Error_class(ierr, &eclass);
-        MPI_Error_string(eclass, tclmpi_errmsg, &len);
-        Tcl_AppendResult(interp, Tcl_GetString(obj), ": ", tclmpi_errmsg, NULL);
+        MPI_Error_string(eclass, errmsg, &len);
+        Tcl_AppendResult(interp, Tcl_GetString(obj), ": ", errmsg, NULL);
         return TCL_ERROR;
     } else
         return TCL_OK;
@@ -890,1776 +1216,5940 @@ static int tclmpi_typecheck(Tcl_Interp *interp, int type, Tcl_Obj *obj0, Tcl_Obj
         return TCL_OK;
 }
 
-/*!
- * @}
- */
+/* parallel data conversion for large lists */
+
+/*! Minimum number of list elements per conversion thread */
+#define TCLMPI_CONV_CHUNK 262144
+/*! Maximum number of threads for data conversions */
+#define TCLMPI_CONV_MAXTHREADS 256
+
+/*! Maximum number of threads for data conversions. Set by tclmpi::init */
+static int tclmpi_conv_threads = 1;
+/*! Tcl object type of integers, used to read them without conversion */
+static const Tcl_ObjType *tclmpi_int_objtype = NULL;
+/*! Tcl object type of doubles, used to read them without conversion */
+static const Tcl_ObjType *tclmpi_double_objtype = NULL;
+#if TCL_MAJOR_VERSION < 9
+/*! Tcl object type of lists, used to expand vectors in lists of results */
+static const Tcl_ObjType *tclmpi_list_objtype = NULL;
+#endif
 
-/*!
- * \defgroup wrappers TclMPI wrapper functions
- * @{
- */
+/*! Access the value of a Tcl integer object */
+#if TCL_MAJOR_VERSION >= 9
+#define TCLMPI_INTREP(obj) ((obj)->internalRep.wideValue)
+#else
+#define TCLMPI_INTREP(obj) ((obj)->internalRep.longValue)
+#endif
 
-/*! wrapper for MPI_Initialized()
- * \return TCL_OK or TCL_ERROR
+/*! Part of a data conversion that is done by one thread */
+typedef struct tclmpi_task tclmpi_task_t;
+
+/*! Range of elements to convert and the result */
+struct tclmpi_task {
+    Tcl_ThreadId id; /*!< thread id of the worker or NULL */
+    int type;        /*!< TclMPI data type (TCLMPI_INT or TCLMPI_DOUBLE) */
+    int first;       /*!< index of the first element */
+    int last;        /*!< index after the last element */
+    int stop;        /*!< index of the first element that could not be converted */
+    Tcl_Obj **ilist; /*!< list elements to be converted to native data */
+    void *data;      /*!< native data */
+    char *buf;       /*!< string representation of the native data */
+    int buflen;      /*!< length of the string representation */
+};
+
+/*! Convert list elements that are already integers or doubles
+ * \param task range of elements and storage for the native data
  *
- * This function checks whether the MPI environment has been initialized.
+ * Only the internal representation of the Tcl objects is read, which
+ * makes this safe to call from worker threads. Conversion stops at the
+ * first element that is of a different type or out of range, so that
+ * the caller can continue with the regular Tcl API at task->stop.
  */
-int TclMPI_Initialized(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static void tclmpi_conv_fast(tclmpi_task_t *task)
 {
-    Tcl_Obj *result;
-    int tclmpi_init_done;
+    Tcl_Obj **ilist = task->ilist;
+    int i;
+
+    if (task->type == TCLMPI_DOUBLE) {
+        double *odata = (double *)task->data;
+        for (i = task->first; i < task->last; ++i) {
+            if (ilist[i]->typePtr == NULL) break;
+            if (ilist[i]->typePtr == tclmpi_double_objtype) {
+                odata[i] = ilist[i]->internalRep.doubleValue;
+                if (odata[i] != odata[i]) break; /* NaN is an error in Tcl */
+            } else if (ilist[i]->typePtr == tclmpi_int_objtype) {
+                odata[i] = (double)TCLMPI_INTREP(ilist[i]);
+            } else
+                break;
+        }
+    } else {
+        int *odata = (int *)task->data;
+        for (i = task->first; i < task->last; ++i) {
+            if ((ilist[i]->typePtr == NULL) || (ilist[i]->typePtr != tclmpi_int_objtype)) break;
+            if ((TCLMPI_INTREP(ilist[i]) < INT_MIN) || (TCLMPI_INTREP(ilist[i]) > INT_MAX)) break;
+            odata[i] = (int)TCLMPI_INTREP(ilist[i]);
+        }
+    }
+    task->stop = i;
+}
 
-    if (objc != 1) {
-        Tcl_WrongNumArgs(interp, 1, objv, NULL);
-        return TCL_ERROR;
+/*! Format native integers as a Tcl list
+ * \param task range of elements and the resulting string
+ */
+static void tclmpi_format_int(tclmpi_task_t *task)
+{
+    int *idata = (int *)task->data;
+    char *ptr;
+    int i;
+
+    task->buf = ptr = Tcl_Alloc((size_t)(task->last - task->first) * (TCL_INTEGER_SPACE + 1) + 1);
+    for (i = task->first; i < task->last; ++i) {
+        if (i > task->first) *ptr++ = ' ';
+        ptr += sprintf(ptr, "%d", idata[i]);
     }
+    *ptr         = '\0';
+    task->buflen = ptr - task->buf;
+}
 
-    MPI_Initialized(&tclmpi_init_done);
-    result = Tcl_NewIntObj(tclmpi_init_done);
-    Tcl_SetObjResult(interp, result);
-    return TCL_OK;
+/*! Thread function for tclmpi_conv_fast
+ * \param data pointer to the tclmpi_task_t of the thread
+ */
+static Tcl_ThreadCreateType tclmpi_conv_proc(ClientData data)
+{
+    tclmpi_conv_fast((tclmpi_task_t *)data);
+    TCL_THREAD_CREATE_RETURN;
 }
 
-/*! wrapper for MPI_Finalized()
- * \return TCL_OK or TCL_ERROR
- *
- * This function checks whether the MPI environment has been shut down.
+/*! Thread function for tclmpi_format_int
+ * \param data pointer to the tclmpi_task_t of the thread
  */
-int TclMPI_Finalized(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static Tcl_ThreadCreateType tclmpi_format_proc(ClientData data)
 {
-    Tcl_Obj *result;
-    int tclmpi_init_done;
+    tclmpi_format_int((tclmpi_task_t *)data);
+    TCL_THREAD_CREATE_RETURN;
+}
 
-    if (objc != 1) {
-        Tcl_WrongNumArgs(interp, 1, objv, NULL);
-        return TCL_ERROR;
+/*! Split a data conversion into tasks
+ * \param len number of elements
+ * \param num pointer to location for storing the number of tasks
+ * \param single storage for a single task
+ * \return list of tasks, to be released with tclmpi_free_tasks()
+ *
+ * Each task gets at least TCLMPI_CONV_CHUNK elements, so that
+ * small lists are always converted by the calling thread alone
+ * and without allocating memory. At most tclmpi_conv_threads tasks
+ * are created.
+ */
+static tclmpi_task_t *tclmpi_split_tasks(int len, int *num, tclmpi_task_t *single)
+{
+    tclmpi_task_t *tasks = single;
+    int i;
+
+    *num = len / TCLMPI_CONV_CHUNK;
+    if (*num > tclmpi_conv_threads) *num = tclmpi_conv_threads;
+    if (*num < 1) *num = 1;
+    if (*num > 1) tasks = (tclmpi_task_t *)Tcl_Alloc(*num * sizeof(tclmpi_task_t));
+
+    memset(tasks, 0, *num * sizeof(tclmpi_task_t));
+    for (i = 0; i < *num; ++i) {
+        tasks[i].first = (int)((double)len * i / *num);
+        tasks[i].last  = (int)((double)len * (i + 1) / *num);
     }
+    return tasks;
+}
 
-    MPI_Finalized(&tclmpi_init_done);
-    result = Tcl_NewIntObj(tclmpi_init_done);
-    Tcl_SetObjResult(interp, result);
-    return TCL_OK;
+/*! Release a list of tasks created by tclmpi_split_tasks()
+ * \param tasks list of tasks
+ * \param single storage for a single task that was passed to tclmpi_split_tasks()
+ */
+static void tclmpi_free_tasks(tclmpi_task_t *tasks, tclmpi_task_t *single)
+{
+    if (tasks != single) Tcl_Free((char *)tasks);
 }
 
-/*! wrapper for MPI_Init()
- * \param nodata ignored
- * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK or TCL_ERROR
+/*! Run tasks on worker threads
+ * \param proc thread function
+ * \param func the same function to be called directly
+ * \param num number of tasks
+ * \param tasks list of tasks
  *
- * This function does a little more work than just calling MPI_Init().
- * First of it tries to detect whether MPI_Init() has been called before
- * (from Tcl) and then creates a (catchable) Tcl error instead of an
- * (uncatchable) MPI error. It will also try to pass the argument vector
- * to the script from the Tcl generated 'argv' array to the underlying
- * MPI_Init() call and reset argv as needed.
+ * The first task is processed by the calling thread. If a worker thread
+ * cannot be created, its task is processed by the calling thread as well.
+ * Worker threads only live for the duration of one call. Tasks are only
+ * split for lists of at least 2*TCLMPI_CONV_CHUNK elements, where the
+ * cost of creating a thread is negligible compared to the conversion.
  */
-int TclMPI_Init(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static void tclmpi_run_tasks(Tcl_ThreadCreateProc *proc, void (*func)(tclmpi_task_t *), int num,
+                             tclmpi_task_t *tasks)
 {
-    Tcl_Obj *result, *argobj, **args;
-    int argc, narg, i, ierr, tlevel;
-    int tclmpi_init_done;
-    char **argv;
+    int i, result;
 
-    if (objc != 1) {
-        Tcl_WrongNumArgs(interp, 1, objv, NULL);
-        return TCL_ERROR;
+    for (i = 1; i < num; ++i) {
+        if (Tcl_CreateThread(&tasks[i].id, proc, tasks + i, TCL_THREAD_STACK_DEFAULT, TCL_THREAD_JOINABLE) != TCL_OK)
+            tasks[i].id = NULL;
     }
-
-    /* convert "command line arguments" back to standard C stuff. */
-    argobj = Tcl_GetVar2Ex(interp, "argv", NULL, TCL_GLOBAL_ONLY);
-    Tcl_ListObjGetElements(interp, argobj, &narg, &args);
-
-    argv = (char **)Tcl_Alloc((narg + 1) * sizeof(char *));
-    for (argc = 1; argc <= narg; ++argc) {
-        Tcl_IncrRefCount(args[argc - 1]);
-        argv[argc] = Tcl_GetString(args[argc - 1]);
+    func(tasks);
+    for (i = 1; i < num; ++i) {
+        if (tasks[i].id)
+            Tcl_JoinThread(tasks[i].id, &result);
+        else
+            func(tasks + i);
     }
+}
 
-    argobj = Tcl_GetVar2Ex(interp, "argv0", NULL, TCL_GLOBAL_ONLY);
-    Tcl_IncrRefCount(argobj);
-    argv[0] = Tcl_GetString(argobj);
+/* native data vectors. "tclmpi::vector" Tcl object type */
 
-    MPI_Initialized(&tclmpi_init_done);
-    if (tclmpi_init_done != 0) {
-        Tcl_AppendResult(interp, "Calling ", Tcl_GetString(objv[0]), " multiple times is erroneous.", NULL);
-        return TCL_ERROR;
-    }
+/*! Shared native data buffer of a "tclmpi::vector" Tcl object */
+typedef struct tclmpi_vec tclmpi_vec_t;
 
-    ierr = MPI_Init_thread(&argc, &argv, MPI_THREAD_SINGLE, &tlevel);
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+/*! Contiguous block of native int or double data. */
+struct tclmpi_vec {
+    int refcnt; /*!< number of Tcl objects sharing this buffer */
+    int type;   /*!< data type of the elements (TCLMPI_INT or TCLMPI_DOUBLE) */
+    int len;    /*!< number of data elements */
+    void *data; /*!< pointer to the data elements */
+};
 
-    /* change default error handler, so we can convert
-       MPI errors into 'catch'able Tcl errors */
-    MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
+/*! Access the internal representation of a "tclmpi::vector" object */
+#define TCLMPI_VEC(obj) ((tclmpi_vec_t *)(obj)->internalRep.twoPtrValue.ptr1)
+
+static void tclmpi_vec_free(Tcl_Obj *obj);
+static void tclmpi_vec_dup(Tcl_Obj *src, Tcl_Obj *dup);
+static void tclmpi_vec_string(Tcl_Obj *obj);
+#if TCL_MAJOR_VERSION >= 9
+static Tcl_Size tclmpi_vec_length(Tcl_Obj *obj);
+static int tclmpi_vec_index(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_Size idx, Tcl_Obj **elem);
+static int tclmpi_vec_slice(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_Size from, Tcl_Size to, Tcl_Obj **slice);
+static int tclmpi_vec_reverse(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_Obj **rev);
+#endif
 
-    /* build new argv list */
-    result = Tcl_NewListObj(0, NULL);
-    for (i = 1; i < argc; ++i) { Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj(argv[i], -1)); }
-    for (i = 0; i < narg; ++i) Tcl_DecrRefCount(args[i]);
-    Tcl_DecrRefCount(argobj);
+/*! Tcl object type for data vectors received from or passed to MPI
+ *
+ * The internal representation is a reference counted, contiguous buffer
+ * of native data that can be handed to MPI calls without any conversion.
+ * The string (and thus the list) representation is only generated when
+ * a script actually accesses the data. There is no setFromAny function,
+ * since objects of this type are only created by TclMPI commands.
+ * With Tcl 9 the type also implements the abstract list interface, so
+ * that llength, lindex and lrange work on the native data directly and
+ * element objects are only created for the elements that are accessed. */
+static const Tcl_ObjType tclmpi_vector_type = {
+    "tclmpi::vector",  /* name */
+    tclmpi_vec_free,   /* freeIntRepProc */
+    tclmpi_vec_dup,    /* dupIntRepProc */
+    tclmpi_vec_string, /* updateStringProc */
+    NULL,              /* setFromAnyProc */
+#if TCL_MAJOR_VERSION >= 9
+    TCL_OBJTYPE_V2(tclmpi_vec_length,  /* lengthProc */
+                   tclmpi_vec_index,   /* indexProc */
+                   tclmpi_vec_slice,   /* sliceProc */
+                   tclmpi_vec_reverse, /* reverseProc */
+                   NULL,               /* getElementsProc */
+                   NULL,               /* setElementProc */
+                   NULL,               /* replaceProc */
+                   NULL)               /* inOperProc */
+#endif
+};
 
-    Tcl_SetVar2Ex(interp, "argv", NULL, result, TCL_GLOBAL_ONLY);
-    Tcl_SetVar2Ex(interp, "argc", NULL, Tcl_NewIntObj(argc - 1), TCL_GLOBAL_ONLY);
+/*! Release the internal representation of a "tclmpi::vector" object
+ * \param obj pointer to Tcl object
+ *
+ * The data buffer is shared between duplicated objects and only
+ * deleted when the last reference to it is released. */
+static void tclmpi_vec_free(Tcl_Obj *obj)
+{
+    tclmpi_vec_t *vec = TCLMPI_VEC(obj);
 
-    Tcl_Free((char *)argv);
-    Tcl_ResetResult(interp);
-    return TCL_OK;
+    if (--vec->refcnt <= 0) Tcl_Free((char *)vec);
+    obj->typePtr = NULL;
 }
 
-/*! Set error handler for data conversions in TclMPI
- * \param nodata ignored
- * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK or TCL_ERROR
+/*! Duplicate the internal representation of a "tclmpi::vector" object
+ * \param src pointer to Tcl object that is duplicated
+ * \param dup pointer to new Tcl object
  *
- * This function sets what action TclMPI should take if a conversion
- * of a data element to the requested integer or double data type fails.
- * There are currently three handlers implemented: \ref TCLMPI_ERROR,
- * \ref TCLMPI_ABORT, and \ref TCLMPI_TOZERO.
+ * Data buffers are never modified once the vector object has been
+ * handed to Tcl, so duplicates can share the same buffer. */
+static void tclmpi_vec_dup(Tcl_Obj *src, Tcl_Obj *dup)
+{
+    tclmpi_vec_t *vec = TCLMPI_VEC(src);
+
+    ++vec->refcnt;
+    dup->internalRep.twoPtrValue.ptr1 = vec;
+    dup->internalRep.twoPtrValue.ptr2 = NULL;
+    dup->typePtr                      = &tclmpi_vector_type;
+}
+
+/*! Generate the string representation of a "tclmpi::vector" object
+ * \param obj pointer to Tcl object
  *
- * For \ref TCLMPI_ERROR a Tcl error is raised and TclMPI returns to the
- * calling function. For \ref TCLMPI_ABORT an error message is written to the
- * error output and parallel execution on the current communicator is
- * terminated via MPI_Abort(). For \ref TCLMPI_TOZERO the error is silently
- * ignored and the data element set to zero.
- *
- * There is no equivalent MPI function for this, since there are
- * no data conversions in C or C++.
- */
-int TclMPI_Conv_set(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+ * The string is formatted exactly like a Tcl list of int or double
+ * objects, so that scripts cannot tell the difference. Large integer
+ * vectors are formatted by multiple threads. Doubles are always formatted
+ * by the calling thread, since Tcl_PrintDouble() depends on the
+ * tcl_precision setting of the thread. Like Tcl itself, this panics
+ * if the string could exceed the maximum size of a Tcl value. */
+static void tclmpi_vec_string(Tcl_Obj *obj)
 {
-    Tcl_Obj *result;
-    const char *handler;
-
-    if (objc != 2) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<handler>");
-        return TCL_ERROR;
+    tclmpi_vec_t *vec = TCLMPI_VEC(obj);
+    char *buf, *ptr;
+    size_t size;
+    int i, maxlen;
+
+    maxlen = (vec->type == TCLMPI_DOUBLE) ? TCL_DOUBLE_SPACE : TCL_INTEGER_SPACE;
+    size   = (size_t)vec->len * (maxlen + 1) + 1;
+    if (size > INT_MAX) Tcl_Panic("max size for a Tcl value (%d bytes) exceeded", INT_MAX);
+
+    if ((vec->type == TCLMPI_INT) && (vec->len >= 2 * TCLMPI_CONV_CHUNK) && (tclmpi_conv_threads > 1)) {
+        tclmpi_task_t single, *tasks;
+        int num;
+
+        tasks = tclmpi_split_tasks(vec->len, &num, &single);
+        for (i = 0; i < num; ++i) tasks[i].data = vec->data;
+        tclmpi_run_tasks(tclmpi_format_proc, tclmpi_format_int, num, tasks);
+        for (size = 0, i = 0; i < num; ++i) size += tasks[i].buflen + 1;
+        buf = ptr = Tcl_Alloc(size);
+        for (i = 0; i < num; ++i) {
+            if (i > 0) *ptr++ = ' ';
+            memcpy(ptr, tasks[i].buf, tasks[i].buflen);
+            ptr += tasks[i].buflen;
+            Tcl_Free(tasks[i].buf);
+        }
+        tclmpi_free_tasks(tasks, &single);
+        *ptr        = '\0';
+        obj->length = ptr - buf;
+        obj->bytes  = buf;
+        return;
     }
 
-    handler = Tcl_GetString(objv[1]);
+    buf = ptr = Tcl_Alloc(size);
 
-    if (strcmp(handler, "tclmpi::error") == 0)
-        tclmpi_conv_handler = TCLMPI_ERROR;
-    else if (strcmp(handler, "tclmpi::abort") == 0)
-        tclmpi_conv_handler = TCLMPI_ABORT;
-    else if (strcmp(handler, "tclmpi::tozero") == 0)
-        tclmpi_conv_handler = TCLMPI_TOZERO;
-    else {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown conversion error handler: ", handler, NULL);
-        return TCL_ERROR;
+    if (vec->type == TCLMPI_DOUBLE) {
+        double *data = (double *)vec->data;
+        for (i = 0; i < vec->len; ++i) {
+            if (i > 0) *ptr++ = ' ';
+            Tcl_PrintDouble(NULL, data[i], ptr);
+            ptr += strlen(ptr);
+        }
+    } else {
+        int *data = (int *)vec->data;
+        for (i = 0; i < vec->len; ++i) {
+            if (i > 0) *ptr++ = ' ';
+            ptr += sprintf(ptr, "%d", data[i]);
+        }
     }
+    *ptr        = '\0';
+    obj->length = ptr - buf;
+    obj->bytes  = Tcl_Realloc(buf, obj->length + 1);
+}
 
-    Tcl_ResetResult(interp);
-    return TCL_OK;
+/*! Create a new "tclmpi::vector" object with uninitialized data
+ * \param type TclMPI data type of the elements (TCLMPI_INT or TCLMPI_DOUBLE)
+ * \param len number of data elements
+ * \param data pointer to location for storing the address of the data buffer
+ * \return the new Tcl object
+ *
+ * The caller is expected to fill in the data, e.g. by using the buffer
+ * as receive buffer for an MPI call, before the object is passed on. */
+static Tcl_Obj *tclmpi_new_vector(int type, int len, void **data)
+{
+    tclmpi_vec_t *vec;
+    Tcl_Obj *obj;
+    int size;
+
+    if (len < 0) len = 0;
+    size = (type == TCLMPI_DOUBLE) ? sizeof(double) : sizeof(int);
+#if TCL_MAJOR_VERSION < 9
+    /* Tcl_Alloc() of Tcl 8.6 takes the size as unsigned int */
+    if ((size_t)len * size > UINT_MAX - sizeof(tclmpi_vec_t))
+        Tcl_Panic("unable to alloc %lu bytes", (unsigned long)((size_t)len * size + sizeof(tclmpi_vec_t)));
+#endif
+    vec         = (tclmpi_vec_t *)Tcl_Alloc(sizeof(tclmpi_vec_t) + (size_t)len * size);
+    vec->refcnt = 1;
+    vec->type   = type;
+    vec->len    = len;
+    vec->data   = (void *)(vec + 1);
+
+    obj = Tcl_NewObj();
+    Tcl_InvalidateStringRep(obj);
+    obj->internalRep.twoPtrValue.ptr1 = vec;
+    obj->internalRep.twoPtrValue.ptr2 = NULL;
+    obj->typePtr                      = &tclmpi_vector_type;
+
+    if (data) *data = vec->data;
+    return obj;
 }
 
-/*! Get error handler string for data conversions in TclMPI
- * \param nodata ignored
- * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK
+/*! Create a private reference to the data buffer of a "tclmpi::vector" object
+ * \param obj pointer to Tcl object with a "tclmpi::vector" representation
+ * \return a new Tcl object sharing the data buffer of obj
  *
- * This function returns which error handler is currently active
- * for data conversions in TclMPI. For details see \ref TclMPI_Conv_set().
+ * The internal representation of a Tcl object can be freed at any time
+ * when the object is converted to a different type, even if it is
+ * shared. A private object, that is never handed to a script, keeps
+ * the data buffer alive without copying it or its string representation
+ * as Tcl_DuplicateObj would. */
+static Tcl_Obj *tclmpi_ref_vector(Tcl_Obj *obj)
+{
+    Tcl_Obj *ref = Tcl_NewObj();
+
+    Tcl_InvalidateStringRep(ref);
+    tclmpi_vec_dup(obj, ref);
+    return ref;
+}
+
+/*! Prepare a "tclmpi::vector" object for being handed to a script
+ * \param obj pointer to Tcl object with the result of a TclMPI command
+ * \return obj
  *
- * There is no equivalent MPI function for this, since there are
- * no data conversions in C or C++.
+ * With Tcl 9 vectors are abstract lists and are passed on unchanged.
+ * Tcl 8.6 has no way for a custom type to provide list elements, so
+ * the first list operation would generate the string representation
+ * of the whole vector and parse it back. Instead, the vector is
+ * converted in place into a regular list with one Tcl object per
+ * element created directly from the native data. This keeps its value
+ * and thus also works on shared objects. Vectors in a list of results,
+ * e.g. from tclmpi::gatherv, are converted as well.
  */
-int TclMPI_Conv_get(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static Tcl_Obj *tclmpi_vec_result(Tcl_Obj *obj)
 {
-    if (objc != 1) {
-        Tcl_WrongNumArgs(interp, 0, objv, NULL);
-        return TCL_ERROR;
+#if TCL_MAJOR_VERSION < 9
+    tclmpi_vec_t *vec;
+    Tcl_Obj **elems, *list;
+    int i, num;
+
+    if ((obj->typePtr != NULL) && (obj->typePtr == tclmpi_list_objtype)) {
+        if (Tcl_ListObjGetElements(NULL, obj, &num, &elems) != TCL_OK) return obj;
+        for (i = 0; i < num; ++i)
+            if (elems[i]->typePtr == &tclmpi_vector_type) tclmpi_vec_result(elems[i]);
+        return obj;
     }
-
-    if (tclmpi_conv_handler == TCLMPI_ABORT) {
-        Tcl_SetObjResult(interp, Tcl_NewStringObj("tclmpi::abort", -1));
-    } else if (tclmpi_conv_handler == TCLMPI_TOZERO) {
-        Tcl_SetObjResult(interp, Tcl_NewStringObj("tclmpi::tozero", -1));
+    if (obj->typePtr != &tclmpi_vector_type) return obj;
+    vec = TCLMPI_VEC(obj);
+    if (vec->len == 0) return obj;
+
+    elems = (Tcl_Obj **)Tcl_Alloc((size_t)vec->len * sizeof(Tcl_Obj *));
+    if (vec->type == TCLMPI_DOUBLE) {
+        double *data = (double *)vec->data;
+        for (i = 0; i < vec->len; ++i) elems[i] = Tcl_NewDoubleObj(data[i]);
     } else {
-        Tcl_SetObjResult(interp, Tcl_NewStringObj("tclmpi::error", -1));
+        int *data = (int *)vec->data;
+        for (i = 0; i < vec->len; ++i) elems[i] = Tcl_NewIntObj(data[i]);
     }
-    return TCL_OK;
+    list = Tcl_NewListObj(vec->len, elems);
+    Tcl_IncrRefCount(list);
+    Tcl_Free((char *)elems);
+
+    /* share the list representation, as Tcl_DuplicateObj() does */
+    tclmpi_vec_free(obj);
+    list->typePtr->dupIntRepProc(list, obj);
+    Tcl_DecrRefCount(list);
+#endif
+    return obj;
 }
 
-/*! wrapper for MPI_Finalize()
- * \param nodata ignored
+#if TCL_MAJOR_VERSION >= 9
+/*! Return the number of elements of a "tclmpi::vector" object
+ * \param obj pointer to Tcl object
+ * \return number of elements
+ */
+static Tcl_Size tclmpi_vec_length(Tcl_Obj *obj)
+{
+    return TCLMPI_VEC(obj)->len;
+}
+
+/*! Create a Tcl object for a single element of a "tclmpi::vector" object
  * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK or TCL_ERROR
- *
- * This function does a little more than just calling MPI_Finalize(). It
- * also tries to detect whether MPI_Init() or MPI_Finialize() have been
- * called before (from Tcl) and then creates a (catchable) Tcl error
- * instead of an (uncatchable) MPI error.
+ * \param obj pointer to Tcl object
+ * \param idx index of the element
+ * \param elem pointer to location for storing the new element or NULL if out of range
+ * \return TCL_OK
  */
-int TclMPI_Finalize(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static int tclmpi_vec_index(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_Size idx, Tcl_Obj **elem)
 {
-    int tclmpi_init_done;
-    if (objc != 1) {
-        Tcl_WrongNumArgs(interp, 1, objv, NULL);
-        return TCL_ERROR;
-    }
+    tclmpi_vec_t *vec = TCLMPI_VEC(obj);
 
-    MPI_Finalized(&tclmpi_init_done);
-    if (tclmpi_init_done != 0) {
-        Tcl_AppendResult(interp, "Calling ", Tcl_GetString(objv[0]), " twice is erroneous.", NULL);
-        return TCL_ERROR;
-    }
+    if ((idx < 0) || (idx >= vec->len))
+        *elem = NULL;
+    else if (vec->type == TCLMPI_DOUBLE)
+        *elem = Tcl_NewDoubleObj(((double *)vec->data)[idx]);
+    else
+        *elem = Tcl_NewIntObj(((int *)vec->data)[idx]);
+    return TCL_OK;
+}
 
-    MPI_Initialized(&tclmpi_init_done);
-    if (tclmpi_init_done == 0) {
-        Tcl_AppendResult(interp, "Calling ", Tcl_GetString(objv[0]), " before tclmpi::init is erroneous.", NULL);
-        return TCL_ERROR;
-    }
+/*! Create a new "tclmpi::vector" object from a range of elements
+ * \param interp current Tcl interpreter
+ * \param obj pointer to Tcl object
+ * \param from index of the first element
+ * \param to index of the last element
+ * \param slice pointer to location for storing the new vector object
+ * \return TCL_OK
+ */
+static int tclmpi_vec_slice(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_Size from, Tcl_Size to, Tcl_Obj **slice)
+{
+    tclmpi_vec_t *vec = TCLMPI_VEC(obj);
+    int size          = (vec->type == TCLMPI_DOUBLE) ? sizeof(double) : sizeof(int);
+    void *data;
 
-    MPI_Finalize();
-    tclmpi_init_done = -1;
+    if (from < 0) from = 0;
+    if (to >= vec->len) to = vec->len - 1;
+    if (to < from) to = from - 1;
 
+    *slice = tclmpi_new_vector(vec->type, to - from + 1, &data);
+    memcpy(data, (char *)vec->data + (size_t)from * size, (size_t)(to - from + 1) * size);
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Abort()
- * \param nodata ignored
+/*! Create a new "tclmpi::vector" object with the elements in reverse order
  * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK or TCL_ERROR
- *
- * This function translates the Tcl string representing a communicator
- * into the corresponding MPI communicator and then calls MPI_Abort().
+ * \param obj pointer to Tcl object
+ * \param rev pointer to location for storing the new vector object
+ * \return TCL_OK
  */
-int TclMPI_Abort(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static int tclmpi_vec_reverse(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_Obj **rev)
 {
-    MPI_Comm comm;
-    int ierr;
+    tclmpi_vec_t *vec = TCLMPI_VEC(obj);
+    void *data;
+    int i;
 
-    if (objc != 3) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<comm> <errorcode>");
-        return TCL_ERROR;
+    *rev = tclmpi_new_vector(vec->type, vec->len, &data);
+    if (vec->type == TCLMPI_DOUBLE) {
+        double *idata = (double *)vec->data, *odata = (double *)data;
+        for (i = 0; i < vec->len; ++i) odata[i] = idata[vec->len - i - 1];
+    } else {
+        int *idata = (int *)vec->data, *odata = (int *)data;
+        for (i = 0; i < vec->len; ++i) odata[i] = idata[vec->len - i - 1];
     }
-
-    comm = tcl2mpi_comm(Tcl_GetString(objv[1]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
-
-    if (Tcl_GetIntFromObj(interp, objv[2], &ierr) != TCL_OK) { return TCL_ERROR; }
-
-    MPI_Abort(comm, ierr);
     return TCL_OK;
 }
+#endif
 
-/*! wrapper for MPI_Comm_size()
- * \param nodata ignored
+/*! Convert the list elements of a task that tclmpi_conv_fast() skipped
  * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
+ * \param comm MPI communicator used for MPI_Abort()
+ * \param task range of elements and storage for the native data
  * \return TCL_OK or TCL_ERROR
- *
- * This function translates the Tcl string representing a communicator
- * into the corresponding MPI communicator and then calls MPI_Comm_size()
- * on it. The resulting number is passed to Tcl as result or the MPI error
- * message is passed up similarly.
  */
-int TclMPI_Comm_size(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static int tclmpi_conv_rest(Tcl_Interp *interp, MPI_Comm comm, tclmpi_task_t *task)
 {
-    Tcl_Obj *result;
-    MPI_Comm comm;
-    int commsize, ierr;
+    Tcl_Obj **ilist = task->ilist;
+    int i;
 
-    if (objc != 2) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<comm>");
-        return TCL_ERROR;
+    while ((i = task->stop) < task->last) {
+        if (task->type == TCLMPI_DOUBLE) {
+            double *idata = (double *)task->data;
+            TCLMPI_CONV_CHECK(Double, ilist[i], idata + i, idata[i]);
+        } else {
+            int *idata = (int *)task->data;
+            TCLMPI_CONV_CHECK(Int, ilist[i], idata + i, idata[i]);
+        }
+        task->first = i + 1;
+        tclmpi_conv_fast(task);
     }
-
-    comm = tcl2mpi_comm(Tcl_GetString(objv[1]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
-
-    ierr = MPI_Comm_size(comm, &commsize);
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
-
-    result = Tcl_NewIntObj(commsize);
-    Tcl_SetObjResult(interp, result);
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Comm_rank()
- * \param nodata ignored
+/*! Convert list elements to native integers
  * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
+ * \param comm MPI communicator used for MPI_Abort()
+ * \param ilist array of Tcl objects
+ * \param len number of elements in ilist
+ * \param idata storage for the converted data
  * \return TCL_OK or TCL_ERROR
  *
- * This function translates the Tcl string representing a communicator
- * into the corresponding MPI communicator and then calls MPI_Comm_rank()
- * on it. The resulting number is passed to Tcl as result or the MPI error
- * message is passed up similarly.
+ * Elements that already are integers are read directly, for large lists
+ * by multiple threads (see tclmpi_conv_fast). All other elements are
+ * converted with Tcl_GetIntFromObj() by the calling thread in order.
  */
-int TclMPI_Comm_rank(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static int tclmpi_conv_int(Tcl_Interp *interp, MPI_Comm comm, Tcl_Obj **ilist, int len, int *idata)
 {
-    Tcl_Obj *result;
-    MPI_Comm comm;
-    int commrank, ierr;
-
-    if (objc != 2) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<comm>");
-        return TCL_ERROR;
+    tclmpi_task_t single, *tasks;
+    int t, num, result = TCL_OK;
+
+    tasks = tclmpi_split_tasks(len, &num, &single);
+    for (t = 0; t < num; ++t) {
+        tasks[t].type  = TCLMPI_INT;
+        tasks[t].ilist = ilist;
+        tasks[t].data  = idata;
     }
+    tclmpi_run_tasks(tclmpi_conv_proc, tclmpi_conv_fast, num, tasks);
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[1]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
-
-    ierr = MPI_Comm_rank(comm, &commrank);
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
-
-    result = Tcl_NewIntObj(commrank);
-    Tcl_SetObjResult(interp, result);
-    return TCL_OK;
+    for (t = 0; (t < num) && (result == TCL_OK); ++t) result = tclmpi_conv_rest(interp, comm, tasks + t);
+    tclmpi_free_tasks(tasks, &single);
+    return result;
 }
 
-/*! wrapper for MPI_Comm_split()
- * \param nodata ignored
+/*! Convert list elements to native doubles
  * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
+ * \param comm MPI communicator used for MPI_Abort()
+ * \param ilist array of Tcl objects
+ * \param len number of elements in ilist
+ * \param idata storage for the converted data
  * \return TCL_OK or TCL_ERROR
  *
- * This function translates the Tcl string representing a communicator
- * into the corresponding MPI communicator also checks and converts the
- * values for 'color' and 'key' and then calls MPI_Comm_split().
- * The resulting communicator is added to the internal communicator map
- * linked list and its string representation is passed to Tcl as result.
- * If the MPI call failed, the MPI error message is passed up similarly.
+ * Elements that already are integers or doubles are read directly, for
+ * large lists by multiple threads (see tclmpi_conv_fast). All other
+ * elements are converted with Tcl_GetDoubleFromObj() by the calling
+ * thread in order.
  */
-int TclMPI_Comm_split(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static int tclmpi_conv_double(Tcl_Interp *interp, MPI_Comm comm, Tcl_Obj **ilist, int len, double *idata)
 {
-    Tcl_Obj *result;
-    MPI_Comm comm, newcomm;
-    int color, key, ierr;
+    tclmpi_task_t single, *tasks;
+    int t, num, result = TCL_OK;
+
+    tasks = tclmpi_split_tasks(len, &num, &single);
+    for (t = 0; t < num; ++t) {
+        tasks[t].type  = TCLMPI_DOUBLE;
+        tasks[t].ilist = ilist;
+        tasks[t].data  = idata;
+    }
+    tclmpi_run_tasks(tclmpi_conv_proc, tclmpi_conv_fast, num, tasks);
 
-    if (objc != 4) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<comm> <color> <key>");
-        return TCL_ERROR;
+    for (t = 0; (t < num) && (result == TCL_OK); ++t) result = tclmpi_conv_rest(interp, comm, tasks + t);
+    tclmpi_free_tasks(tasks, &single);
+    return result;
+}
+
+/* bulk parser for lists of numbers in their string representation */
+
+/*! Character classes for tclmpi_parse_vector */
+enum tclmpi_char_class {
+    TCLMPI_CHAR_OTHER = 0, /*!< character that is not part of a plain number */
+    TCLMPI_CHAR_SPACE,     /*!< list element separator */
+    TCLMPI_CHAR_DIGIT,     /*!< decimal digit */
+    TCLMPI_CHAR_SIGN,      /*!< plus or minus sign */
+    TCLMPI_CHAR_FLOAT      /*!< decimal point or exponent marker */
+};
+
+/*! Lookup table for the character classes used by tclmpi_parse_vector */
+static const unsigned char tclmpi_char_class[256] = {
+    [' '] = TCLMPI_CHAR_SPACE, ['\t'] = TCLMPI_CHAR_SPACE, ['\n'] = TCLMPI_CHAR_SPACE, ['\v'] = TCLMPI_CHAR_SPACE,
+    ['\f'] = TCLMPI_CHAR_SPACE, ['\r'] = TCLMPI_CHAR_SPACE, ['0'] = TCLMPI_CHAR_DIGIT, ['1'] = TCLMPI_CHAR_DIGIT,
+    ['2'] = TCLMPI_CHAR_DIGIT, ['3'] = TCLMPI_CHAR_DIGIT, ['4'] = TCLMPI_CHAR_DIGIT, ['5'] = TCLMPI_CHAR_DIGIT,
+    ['6'] = TCLMPI_CHAR_DIGIT, ['7'] = TCLMPI_CHAR_DIGIT, ['8'] = TCLMPI_CHAR_DIGIT, ['9'] = TCLMPI_CHAR_DIGIT,
+    ['+'] = TCLMPI_CHAR_SIGN,  ['-'] = TCLMPI_CHAR_SIGN,  ['.'] = TCLMPI_CHAR_FLOAT, ['e'] = TCLMPI_CHAR_FLOAT,
+    ['E'] = TCLMPI_CHAR_FLOAT};
+
+/*! Character class of a character */
+#define TCLMPI_CHAR(c) (tclmpi_char_class[(unsigned char)(c)])
+
+/*! Parse a plain decimal integer
+ * \param ptr first character of the number
+ * \param end character after the number
+ * \param val storage for the result
+ * \return 1 on success, 0 if the number needs to be parsed by Tcl
+ */
+static int tclmpi_parse_int(const char *ptr, const char *end, int *val)
+{
+    long long num = 0;
+    int neg       = 0;
+
+    if (TCLMPI_CHAR(*ptr) == TCLMPI_CHAR_SIGN) neg = (*ptr++ == '-');
+    if ((ptr == end) || ((*ptr == '0') && (end - ptr > 1))) return 0;
+    for (; ptr < end; ++ptr) {
+        if (TCLMPI_CHAR(*ptr) != TCLMPI_CHAR_DIGIT) return 0;
+        num = 10 * num + (*ptr - '0');
+        if (num > (long long)INT_MAX + 1) return 0;
     }
+    if (neg) num = -num;
+    if (num > INT_MAX) return 0;
+    *val = (int)num;
+    return 1;
+}
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[1]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+/*! Parse a plain decimal floating-point number
+ * \param ptr first character of the number
+ * \param end character after the number
+ * \param val storage for the result
+ * \return 1 on success, 0 if the number needs to be parsed by Tcl
+ *
+ * Numbers with leading zeros are left to Tcl, since they may be octal.
+ */
+static int tclmpi_parse_double(const char *ptr, const char *end, double *val)
+{
+    const char *num = ptr;
+    char *stop;
+
+    if (TCLMPI_CHAR(*num) == TCLMPI_CHAR_SIGN) ++num;
+    if ((num < end - 1) && (num[0] == '0') && (TCLMPI_CHAR(num[1]) == TCLMPI_CHAR_DIGIT)) return 0;
+    errno = 0;
+    *val  = strtod(ptr, &stop);
+    return ((stop == end) && (errno == 0));
+}
 
-    if (strcmp(Tcl_GetString(objv[2]), "tclmpi::undefined") == 0)
-        color = MPI_UNDEFINED;
-    else {
-        if (Tcl_GetIntFromObj(interp, objv[2], &color) != TCL_OK) return TCL_ERROR;
+/*! Count the numbers in the string representation of a list of numbers
+ * \param obj Tcl object with the list
+ * \param type TclMPI data type of the elements (TCLMPI_INT or TCLMPI_DOUBLE)
+ * \return number of list elements or -1 if the string cannot be parsed directly
+ *
+ * Lists read from files or sockets are pure strings. Instead of splitting
+ * them into a list of element objects and converting each of them with
+ * the generic Tcl number parser, plain decimal numbers separated by white
+ * space are parsed directly into native data with tclmpi_parse_data,
+ * and the object is left unchanged. A lookup table for character classes
+ * rejects everything else in a single pass before any number is parsed.
+ * Then the caller processes the object as a list with the regular
+ * conversion and error handling instead.
+ */
+static int tclmpi_parse_count(Tcl_Obj *obj, int type)
+{
+    const char *ptr, *end;
+    int len, prev;
+
+    if ((obj->typePtr != NULL) || (obj->bytes == NULL)) return -1;
+
+    end  = obj->bytes + obj->length;
+    len  = 0;
+    prev = TCLMPI_CHAR_SPACE;
+    for (ptr = obj->bytes; ptr < end; ++ptr) {
+        int c = TCLMPI_CHAR(*ptr);
+        if ((c == TCLMPI_CHAR_OTHER) || ((c == TCLMPI_CHAR_FLOAT) && (type != TCLMPI_DOUBLE))) return -1;
+        if ((c != TCLMPI_CHAR_SPACE) && (prev == TCLMPI_CHAR_SPACE)) ++len;
+        prev = c;
     }
-    if (Tcl_GetIntFromObj(interp, objv[3], &key) != TCL_OK) return TCL_ERROR;
+    return len;
+}
 
-    /* several MPI applications do not catch this. so we got to do it */
-    if (color < 0 && color != MPI_UNDEFINED) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid color argument", NULL);
-        return TCL_ERROR;
+/*! Parse the string representation of a list of numbers into native data
+ * \param obj Tcl object with the list
+ * \param type TclMPI data type of the elements (TCLMPI_INT or TCLMPI_DOUBLE)
+ * \param len number of elements as determined by tclmpi_parse_count
+ * \param data storage for the converted data
+ * \return 1 on success, 0 if the list has to be converted by Tcl
+ *
+ * Numbers that Tcl would interpret differently, like integers with
+ * leading zeros or out of range, or that cannot be parsed, make the
+ * parse fail, so that the caller can fall back to the regular conversion.
+ */
+static int tclmpi_parse_data(Tcl_Obj *obj, int type, int len, void *data)
+{
+    const char *ptr, *end, *num;
+    int i, ok;
+
+    end = obj->bytes + obj->length;
+    ptr = obj->bytes;
+    for (i = 0; i < len; ++i) {
+        while (TCLMPI_CHAR(*ptr) == TCLMPI_CHAR_SPACE) ++ptr;
+        num = ptr;
+        while ((ptr < end) && (TCLMPI_CHAR(*ptr) != TCLMPI_CHAR_SPACE)) ++ptr;
+        if (type == TCLMPI_DOUBLE)
+            ok = tclmpi_parse_double(num, ptr, (double *)data + i);
+        else
+            ok = tclmpi_parse_int(num, ptr, (int *)data + i);
+        if (!ok) return 0;
     }
+    return 1;
+}
 
-    ierr = MPI_Comm_split(comm, color, key, &newcomm);
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+/*! Convert the string representation of a list of numbers to a vector
+ * \param obj Tcl object with the list
+ * \param type TclMPI data type of the elements (TCLMPI_INT or TCLMPI_DOUBLE)
+ * \return vector object or NULL if the string cannot be parsed directly
+ */
+static Tcl_Obj *tclmpi_parse_vector(Tcl_Obj *obj, int type)
+{
+    Tcl_Obj *result;
+    void *data;
+    int len;
 
-    /* change default error handler on new communicator, so that
-       we can convert MPI errors into 'catch'able Tcl errors */
-    MPI_Comm_set_errhandler(newcomm, MPI_ERRORS_RETURN);
+    len = tclmpi_parse_count(obj, type);
+    if (len < 0) return NULL;
 
-    result = Tcl_NewStringObj(tclmpi_add_comm(newcomm), -1);
-    Tcl_SetObjResult(interp, result);
-    return TCL_OK;
+    result = tclmpi_new_vector(type, len, &data);
+    if (!tclmpi_parse_data(obj, type, len, data)) {
+        Tcl_IncrRefCount(result);
+        Tcl_DecrRefCount(result);
+        return NULL;
+    }
+    return result;
 }
 
-/*! wrapper for MPI_Comm_free()
- * \param nodata ignored
+/*! Get a "tclmpi::vector" object with native int or double data
  * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK or TCL_ERROR
+ * \param comm MPI communicator used for MPI_Abort()
+ * \param obj Tcl object with the data (list or "tclmpi::vector")
+ * \param type TclMPI data type of the elements (TCLMPI_INT or TCLMPI_DOUBLE)
+ * \return vector object or NULL
  *
- * This function deletes a defined MPI communicator and removes its Tcl
- * representation from the local translation tables.
+ * If the object already is a "tclmpi::vector" of the requested type,
+ * it is returned as is. Integer vectors are widened to double without
+ * going through Tcl objects. Pure strings are parsed directly, if possible
+ * (see tclmpi_parse_vector). Everything else is processed as a Tcl list
+ * and converted element by element honoring the conversion error handler.
+ * Like with Tcl_NewObj() newly created vectors have a reference count of
+ * zero, so callers that only need the data temporarily have to bracket
+ * its use with Tcl_IncrRefCount() and Tcl_DecrRefCount().
  */
-int TclMPI_Comm_free(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static Tcl_Obj *tclmpi_get_vector(Tcl_Interp *interp, MPI_Comm comm, Tcl_Obj *obj, int type)
 {
-    const char *label;
-    MPI_Comm comm;
-    int ierr;
-
-    if (objc != 2) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<comm>");
-        return TCL_ERROR;
+    Tcl_Obj *result, **ilist;
+    void *data;
+    int i, len, ierr;
+
+    if (obj->typePtr == &tclmpi_vector_type) {
+        tclmpi_vec_t *vec = TCLMPI_VEC(obj);
+        if (vec->type == type)
+            return obj;
+        else if ((vec->type == TCLMPI_INT) && (type == TCLMPI_DOUBLE)) {
+            int *idata = (int *)vec->data;
+            double *odata;
+            result = tclmpi_new_vector(TCLMPI_DOUBLE, vec->len, &data);
+            odata  = (double *)data;
+            for (i = 0; i < vec->len; ++i) odata[i] = idata[i];
+            return result;
+        }
     }
 
-    label = Tcl_GetString(objv[1]);
-    comm  = tcl2mpi_comm(label);
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
-    if (tclmpi_del_comm(label) != TCL_OK) return TCL_ERROR;
+    result = tclmpi_parse_vector(obj, type);
+    if (result != NULL) return result;
 
-    ierr = MPI_Comm_free(&comm);
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    if (Tcl_ListObjGetElements(interp, obj, &len, &ilist) != TCL_OK) return NULL;
 
-    Tcl_ResetResult(interp);
-    return TCL_OK;
+    result = tclmpi_new_vector(type, len, &data);
+    if (type == TCLMPI_DOUBLE)
+        ierr = tclmpi_conv_double(interp, comm, ilist, len, (double *)data);
+    else
+        ierr = tclmpi_conv_int(interp, comm, ilist, len, (int *)data);
+
+    if (ierr != TCL_OK) {
+        Tcl_IncrRefCount(result);
+        Tcl_DecrRefCount(result);
+        return NULL;
+    }
+    return result;
 }
 
-/*! wrapper for MPI_Barrier()
- * \param nodata ignored
+/*! Get native int or double data for temporary use
  * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK or TCL_ERROR
+ * \param comm MPI communicator used for MPI_Abort()
+ * \param obj Tcl object with the data (list or "tclmpi::vector")
+ * \param type TclMPI data type of the elements (TCLMPI_INT or TCLMPI_DOUBLE)
+ * \param len pointer to location for storing the number of elements
+ * \return pointer to the data or NULL on conversion errors
  *
- * This function translates the Tcl string representing a communicator
- * into the corresponding MPI communicator and then calls MPI_Barrier().
- * If the MPI call failed, an MPI error message is passed up as result.
+ * This is a variant of tclmpi_get_vector for blocking calls, that only
+ * need the data until they return. The data of a "tclmpi::vector" of
+ * the requested type is used directly, everything else is converted
+ * into the scratch buffer of the interpreter (see tclmpi_scratch)
+ * instead of a new vector object.
  */
-int TclMPI_Barrier(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static void *tclmpi_get_data(Tcl_Interp *interp, MPI_Comm comm, Tcl_Obj *obj, int type, int *len)
 {
-    MPI_Comm comm;
-    int ierr;
+    Tcl_Obj **ilist;
+    void *data;
+    int i, num, ierr;
+    size_t size = (type == TCLMPI_DOUBLE) ? sizeof(double) : sizeof(int);
+
+    if (obj->typePtr == &tclmpi_vector_type) {
+        tclmpi_vec_t *vec = TCLMPI_VEC(obj);
+        if (vec->type == type) {
+            *len = vec->len;
+            return vec->data;
+        } else if ((vec->type == TCLMPI_INT) && (type == TCLMPI_DOUBLE)) {
+            int *idata = (int *)vec->data;
+            double *odata;
+            data  = tclmpi_scratch(interp, (size_t)vec->len * size);
+            odata = (double *)data;
+            for (i = 0; i < vec->len; ++i) odata[i] = idata[i];
+            *len = vec->len;
+            return data;
+        }
+    }
 
-    if (objc != 2) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<comm>");
-        return TCL_ERROR;
+    num = tclmpi_parse_count(obj, type);
+    if (num >= 0) {
+        data = tclmpi_scratch(interp, (size_t)num * size);
+        if (tclmpi_parse_data(obj, type, num, data)) {
+            *len = num;
+            return data;
+        }
     }
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[1]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+    if (Tcl_ListObjGetElements(interp, obj, &num, &ilist) != TCL_OK) return NULL;
 
-    ierr = MPI_Barrier(comm);
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    data = tclmpi_scratch(interp, (size_t)num * size);
+    if (type == TCLMPI_DOUBLE)
+        ierr = tclmpi_conv_double(interp, comm, ilist, num, (double *)data);
+    else
+        ierr = tclmpi_conv_int(interp, comm, ilist, num, (int *)data);
 
-    return TCL_OK;
+    if (ierr != TCL_OK) return NULL;
+    *len = num;
+    return data;
 }
 
-/*! wrapper for MPI_Bcast()
- * \param nodata ignored
- * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK or TCL_ERROR
- *
- * This function implements a broadcast function for TclMPI. Unlike in the
- * C bindings, the length of the data is inferred from the data object
- * passed to this function and thus a 'count' argument is not needed.
- * Only a limited number of data types are currently supported, since
- * Tcl has a limited number of "native" data types. The tclmpi::auto
- * data type transfers the internal string representation of an object,
- * while the other data types convert data to native data types as needed,
- * with all non-representable data translated into either 0 or 0.0.
- * In all cases, two broadcasts are needed. The first to transmit the
- * amount of data being sent so that a suitable receive buffer can be set up.
+/*! Create a new Tcl object that can be used as receive buffer
+ * \param type TclMPI data type of the received data
+ * \param len number of data elements to be received
+ * \param data pointer to location for storing the address of the receive buffer
+ * \return the new Tcl object
  *
- * The result of the broadcast is converted back into Tcl objects and
- * passed up as result value to the calling Tcl code. If the MPI call
- * failed, an MPI error message is passed up as result instead.
+ * The storage of the returned object is sized to hold len elements of the
+ * given data type, so that MPI can write the received data directly into
+ * it and no temporary buffer or additional copy is required. For
+ * tclmpi::auto this is the string representation of an untyped object,
+ * for tclmpi::bytes the storage of a byte array and for tclmpi::int and
+ * tclmpi::double the buffer of a "tclmpi::vector" object. For all other
+ * data types an empty list is returned and the buffer address set to NULL.
  */
-int TclMPI_Bcast(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static Tcl_Obj *tclmpi_recv_obj(int type, int len, void **data)
 {
-    Tcl_Obj *result = NULL;
-    MPI_Comm comm;
-    int i, rank, root, type, len = 0, ierr = MPI_SUCCESS;
+    Tcl_Obj *obj;
 
-    if (objc != 5) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
-        return TCL_ERROR;
+    if (len < 0) len = 0;
+    if (type == TCLMPI_AUTO) {
+        obj = Tcl_NewObj();
+        Tcl_InvalidateStringRep(obj);
+        obj->bytes      = Tcl_Alloc(len + 1);
+        obj->bytes[len] = '\0';
+        obj->length     = len;
+        *data           = obj->bytes;
+    } else if (type == TCLMPI_BYTES) {
+        obj   = Tcl_NewObj();
+        *data = Tcl_SetByteArrayLength(obj, len);
+    } else if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        obj = tclmpi_new_vector(type, len, data);
+    } else {
+        obj   = Tcl_NewListObj(0, NULL);
+        *data = NULL;
     }
+    return obj;
+}
 
-    type = tclmpi_datatype(Tcl_GetString(objv[2]));
-    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
-
-    if (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK) return TCL_ERROR;
-
-    comm = tcl2mpi_comm(Tcl_GetString(objv[4]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
-
-    ierr = MPI_Comm_rank(comm, &rank);
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+/*! Get the address and size of the data of a Tcl object for sending
+ * \param interp current Tcl interpreter
+ * \param comm MPI communicator for aborting on conversion errors
+ * \param obj Tcl object with the data to be sent
+ * \param type TclMPI data type of the data (auto, bytes, int or double)
+ * \param len pointer to location for storing the number of data elements
+ * \param data pointer to location for storing the address of the data
+ * \return the Tcl object that owns the data or NULL on conversion errors
+ *
+ * For tclmpi::auto and tclmpi::bytes the data is the string or byte array
+ * representation of obj itself, for tclmpi::int and tclmpi::double the
+ * buffer of a "tclmpi::vector" object (see tclmpi_get_vector). As with
+ * Tcl_NewObj, a new object is returned with a reference count of zero,
+ * so callers should increment and decrement it around using the data.
+ */
+static Tcl_Obj *tclmpi_send_obj(Tcl_Interp *interp, MPI_Comm comm, Tcl_Obj *obj, int type, int *len, void **data)
+{
+    Tcl_Obj *vec;
 
     if (type == TCLMPI_AUTO) {
-        char *idata;
-        if (rank == root) {
-            idata = Tcl_GetStringFromObj(objv[1], &len);
-            MPI_Bcast(&len, 1, MPI_INT, root, comm);
-            ierr   = MPI_Bcast(idata, len, MPI_CHAR, root, comm);
-            result = Tcl_DuplicateObj(objv[1]);
-        } else {
-            MPI_Bcast(&len, 1, MPI_INT, root, comm);
-            idata  = Tcl_Alloc(len);
-            ierr   = MPI_Bcast(idata, len, MPI_CHAR, root, comm);
-            result = Tcl_NewStringObj(idata, len);
-            Tcl_Free(idata);
-        }
-    } else if (type == TCLMPI_INT) {
-        Tcl_Obj **ilist;
-        int *idata;
-        if (rank == root) {
-            if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-            idata = (int *)Tcl_Alloc(len * sizeof(int));
-            for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Int, ilist[i], idata + i, idata[i]);
-
-            MPI_Bcast(&len, 1, MPI_INT, root, comm);
-            ierr = MPI_Bcast(idata, len, MPI_INT, root, comm);
-        } else {
-            MPI_Bcast(&len, 1, MPI_INT, root, comm);
-            idata = (int *)Tcl_Alloc(len * sizeof(int));
-            ierr  = MPI_Bcast(idata, len, MPI_INT, root, comm);
-        }
-        result = Tcl_NewListObj(0, NULL);
-        for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(idata[i]));
-        Tcl_Free((char *)idata);
-
-    } else if (type == TCLMPI_DOUBLE) {
-        Tcl_Obj **ilist;
-        double *idata;
-        if (rank == root) {
-            if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-            idata = (double *)Tcl_Alloc(len * sizeof(double));
-            for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Double, ilist[i], idata + i, idata[i]);
-
-            MPI_Bcast(&len, 1, MPI_INT, root, comm);
-            ierr = MPI_Bcast(idata, len, MPI_DOUBLE, root, comm);
-        } else {
-            MPI_Bcast(&len, 1, MPI_INT, root, comm);
-            idata = (double *)Tcl_Alloc(len * sizeof(double));
-            ierr  = MPI_Bcast(idata, len, MPI_DOUBLE, root, comm);
-        }
-        result = Tcl_NewListObj(0, NULL);
-        for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewDoubleObj(idata[i]));
-        Tcl_Free((char *)idata);
-    } else {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
-                         " is not yet implemented.", NULL);
-        return TCL_ERROR;
+        *data = Tcl_GetStringFromObj(obj, len);
+        return obj;
+    } else if (type == TCLMPI_BYTES) {
+        *data = Tcl_GetByteArrayFromObj(obj, len);
+        return obj;
     }
 
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
-
-    if (result) Tcl_SetObjResult(interp, result);
-    return TCL_OK;
+    vec = tclmpi_get_vector(interp, comm, obj, type);
+    if (vec == NULL) return NULL;
+    *len  = TCLMPI_VEC(vec)->len;
+    *data = TCLMPI_VEC(vec)->data;
+    return vec;
 }
 
-/*! wrapper for MPI_Scatter()
- * \param nodata ignored
+/*! Get a Tcl object that keeps the data for a non-blocking send alive
  * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK or TCL_ERROR
- *
- * This function implements a scatter operation that distributes
- * data for TclMPI.
- * This operation does not accept the tclmpi::auto data type, also support
- * for types outside of tclmpi::int and tclmpi::double is incomplete.
- * The length of the data is inferred from the data object passed to this
- * function and thus a 'count' argument is not needed. The number of data
- * items has to be divisible by the number of processes on the communicator.
+ * \param comm MPI communicator for aborting on conversion errors
+ * \param obj Tcl object with the data to be sent
+ * \param type TclMPI data type of the data (auto, bytes, int or double)
+ * \param len pointer to location for storing the number of data elements
+ * \param data pointer to location for storing the address of the data
+ * \return the Tcl object that owns the data or NULL on conversion errors
  *
- * The result is converted back into Tcl objects and passed up as result
- * value to the calling Tcl code. If the MPI call failed an MPI error
- * message is passed up as result instead.
+ * Unlike for tclmpi_send_obj the data must remain valid until the
+ * request is completed, while the script may continue to use obj.
+ * The string representation of a shared object is never invalidated,
+ * so holding a reference to obj is sufficient for tclmpi::auto. A byte
+ * array or "tclmpi::vector" is an internal representation and would
+ * be freed when obj is converted to a different type, so the data is
+ * held by a private object instead. As with Tcl_NewObj, a new object
+ * is returned with a reference count of zero.
  */
-int TclMPI_Scatter(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static Tcl_Obj *tclmpi_hold_obj(Tcl_Interp *interp, MPI_Comm comm, Tcl_Obj *obj, int type, int *len, void **data)
 {
-    Tcl_Obj *result = NULL;
-    MPI_Comm comm;
-    int i, type, root, size, rank, ilen, olen, ierr = MPI_SUCCESS;
+    Tcl_Obj *vec;
 
-    if (objc != 5) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
-        return TCL_ERROR;
+    if (type == TCLMPI_AUTO) {
+        *data = Tcl_GetStringFromObj(obj, len);
+        return obj;
+    } else if (type == TCLMPI_BYTES) {
+        unsigned char *bytes = Tcl_GetByteArrayFromObj(obj, len);
+        vec                  = Tcl_NewByteArrayObj(bytes, *len);
+        *data                = Tcl_GetByteArrayFromObj(vec, len);
+        return vec;
     }
 
-    type = tclmpi_datatype(Tcl_GetString(objv[2]));
-    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+    vec = tclmpi_get_vector(interp, comm, obj, type);
+    if (vec == NULL) return NULL;
+    /* a converted vector is private, otherwise share the data buffer */
+    if (vec == obj) vec = tclmpi_ref_vector(vec);
+    *len  = TCLMPI_VEC(vec)->len;
+    *data = TCLMPI_VEC(vec)->data;
+    return vec;
+}
 
-    if (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK) return TCL_ERROR;
+/*! Split a buffer with data received from multiple processes into a list
+ * \param type TclMPI data type of the received data
+ * \param num number of processes that sent data
+ * \param counts number of data elements received from each process
+ * \param displs offset of the data from each process in data elements
+ * \param data pointer to the receive buffer
+ * \return a Tcl list with one object per process
+ *
+ * Each list element is created with tclmpi_recv_obj, so that it has the
+ * same representation as the result of a receive of the same data type.
+ */
+static Tcl_Obj *tclmpi_split_obj(int type, int num, const int *counts, const int *displs, const char *data)
+{
+    Tcl_Obj *result, *obj;
+    void *odata;
+    int i, esize;
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[4]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+    MPI_Type_size(tclmpi_mpitype(type), &esize);
+    result = Tcl_NewListObj(0, NULL);
+    for (i = 0; i < num; ++i) {
+        obj = tclmpi_recv_obj(type, counts[i], &odata);
+        if (counts[i] > 0) memcpy(odata, data + (size_t)displs[i] * esize, (size_t)counts[i] * esize);
+        Tcl_ListObjAppendElement(NULL, result, obj);
+    }
+    return result;
+}
 
-    /* special case check for reduction */
-    if (type == TCLMPI_AUTO) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
-        return TCL_ERROR;
+/*! Pack the data of the elements of a Tcl list into a single send buffer
+ * \param interp current Tcl interpreter
+ * \param comm MPI communicator for aborting on conversion errors
+ * \param num number of list elements
+ * \param elems list elements with the data for each process
+ * \param type TclMPI data type of the data (auto, bytes, int or double)
+ * \param counts array for storing the number of data elements per process
+ * \param displs array for storing the offset of the data per process
+ * \return pointer to a buffer allocated with Tcl_Alloc or NULL on conversion errors
+ *
+ * This is the counterpart to tclmpi_split_obj for the send side of
+ * collectives that take a list with one element per process.
+ */
+static char *tclmpi_pack_list(Tcl_Interp *interp, MPI_Comm comm, int num, Tcl_Obj **elems, int type, int *counts,
+                              int *displs)
+{
+    Tcl_Obj **sobjs;
+    void **edata;
+    char *sdata;
+    int i, esize, total = 0;
+
+    MPI_Type_size(tclmpi_mpitype(type), &esize);
+    sobjs = (Tcl_Obj **)Tcl_Alloc(num * sizeof(Tcl_Obj *) + 1);
+    edata = (void **)Tcl_Alloc(num * sizeof(void *) + 1);
+    for (i = 0; i < num; ++i) {
+        sobjs[i] = tclmpi_send_obj(interp, comm, elems[i], type, &counts[i], &edata[i]);
+        if (sobjs[i] == NULL) {
+            while (--i >= 0) Tcl_DecrRefCount(sobjs[i]);
+            Tcl_Free((char *)sobjs);
+            Tcl_Free((char *)edata);
+            return NULL;
+        }
+        Tcl_IncrRefCount(sobjs[i]);
+        displs[i] = total;
+        total += counts[i];
     }
-    MPI_Comm_size(comm, &size);
-    MPI_Comm_rank(comm, &rank);
-    Tcl_IncrRefCount(objv[1]);
+    sdata = Tcl_Alloc((size_t)total * esize + 1);
+    for (i = 0; i < num; ++i) {
+        memcpy(sdata + (size_t)displs[i] * esize, edata[i], (size_t)counts[i] * esize);
+        Tcl_DecrRefCount(sobjs[i]);
+    }
+    Tcl_Free((char *)sobjs);
+    Tcl_Free((char *)edata);
+    return sdata;
+}
 
-    if (type == TCLMPI_INT) {
-        Tcl_Obj **ilist;
-        int *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &ilen, &ilist) != TCL_OK) return TCL_ERROR;
-        MPI_Bcast(&ilen, 1, MPI_INT, root, comm);
-        olen = ilen / size;
-        if (olen * size != ilen) {
-            Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
-                             ": number of data items must be divisible"
-                             " by the number of processes",
+/*! Convert a Tcl list of pairs into an array of pair data for loc reductions
+ * \param interp current Tcl interpreter
+ * \param comm MPI communicator for aborting on conversion errors
+ * \param cmd Tcl object with the name of the calling command
+ * \param op Tcl object with the name of the reduction operator
+ * \param obj Tcl list with the data pairs
+ * \param type TclMPI data type of the pairs (tclmpi::intint or tclmpi::dblint)
+ * \param len pointer to location for storing the number of pairs
+ * \param data pointer to location for storing the array of pairs
+ * \return TCL_OK or TCL_ERROR
+ *
+ * The array is placed in the scratch buffer of the interpreter (see
+ * tclmpi_scratch) and followed by room for the same number of pairs,
+ * which can hold the result of the reduction.
+ */
+static int tclmpi_get_pairs(Tcl_Interp *interp, MPI_Comm comm, Tcl_Obj *cmd, Tcl_Obj *op, Tcl_Obj *obj, int type,
+                            int *len, void **data)
+{
+    Tcl_Obj **ilist, **ipair;
+    tclmpi_intint_t *idata = NULL;
+    tclmpi_dblint_t *ddata = NULL;
+    int i, plen;
+
+    if (Tcl_ListObjGetElements(interp, obj, len, &ilist) != TCL_OK) return TCL_ERROR;
+    if (type == TCLMPI_INT_INT)
+        *data = idata = (tclmpi_intint_t *)tclmpi_scratch(interp, (size_t)2 * *len * sizeof(tclmpi_intint_t));
+    else
+        *data = ddata = (tclmpi_dblint_t *)tclmpi_scratch(interp, (size_t)2 * *len * sizeof(tclmpi_dblint_t));
+
+    for (i = 0; i < *len; ++i) {
+        if (Tcl_ListObjGetElements(interp, ilist[i], &plen, &ipair) != TCL_OK) return TCL_ERROR;
+        if (plen < 2) {
+            Tcl_AppendResult(interp, Tcl_GetString(cmd), ": bad list format for loc reduction: ", Tcl_GetString(op),
                              NULL);
-            Tcl_DecrRefCount(objv[1]);
             return TCL_ERROR;
         }
 
-        odata  = (int *)Tcl_Alloc(olen * sizeof(int));
-        result = Tcl_NewListObj(0, NULL);
-        if (rank == root) {
-            idata = (int *)Tcl_Alloc(ilen * sizeof(int));
-            for (i = 0; i < ilen; ++i) TCLMPI_CONV_CHECK(Int, ilist[i], idata + i, idata[i]);
-
-            ierr = MPI_Scatter(idata, olen, MPI_INT, odata, olen, MPI_INT, root, comm);
-            Tcl_Free((char *)idata);
+        if (type == TCLMPI_INT_INT) {
+            TCLMPI_CONV_CHECK(Int, ipair[0], &(idata[i].i1), idata[i].i1);
+            if (Tcl_GetIntFromObj(interp, ipair[1], &(idata[i].i2)) != TCL_OK) plen = -1;
         } else {
-            idata = NULL;
-            ierr  = MPI_Scatter(idata, olen, MPI_INT, odata, olen, MPI_INT, root, comm);
-        }
-        for (i = 0; i < olen; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(odata[i]));
-        Tcl_Free((char *)odata);
-
-    } else if (type == TCLMPI_DOUBLE) {
-        Tcl_Obj **ilist;
-        double *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &ilen, &ilist) != TCL_OK) return TCL_ERROR;
-        MPI_Bcast(&ilen, 1, MPI_INT, root, comm);
-        olen = ilen / size;
-        if (olen * size != ilen) {
-            Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
-                             ": number of data items must be divisible"
-                             " by the number of processes",
+            TCLMPI_CONV_CHECK(Double, ipair[0], &(ddata[i].d), ddata[i].d);
+            if (Tcl_GetIntFromObj(interp, ipair[1], &(ddata[i].i)) != TCL_OK) plen = -1;
+        }
+        if (plen < 0) {
+            Tcl_ResetResult(interp);
+            Tcl_AppendResult(interp, Tcl_GetString(cmd), ": bad location data for reduction: ", Tcl_GetString(op),
                              NULL);
-            Tcl_DecrRefCount(objv[1]);
             return TCL_ERROR;
         }
+    }
+    return TCL_OK;
+}
 
-        odata  = (double *)Tcl_Alloc(olen * sizeof(double));
-        result = Tcl_NewListObj(0, NULL);
-        if (rank == root) {
-            idata = (double *)Tcl_Alloc(ilen * sizeof(double));
-            for (i = 0; i < ilen; ++i) TCLMPI_CONV_CHECK(Double, ilist[i], idata + i, idata[i]);
+/*! Convert an array of pair data from a loc reduction into a Tcl list of pairs
+ * \param type TclMPI data type of the pairs (tclmpi::intint or tclmpi::dblint)
+ * \param len number of pairs
+ * \param data pointer to the array of pairs
+ * \return a new Tcl list object
+ */
+static Tcl_Obj *tclmpi_new_pairs(int type, int len, const void *data)
+{
+    const tclmpi_intint_t *idata = (const tclmpi_intint_t *)data;
+    const tclmpi_dblint_t *ddata = (const tclmpi_dblint_t *)data;
+    Tcl_Obj *result, *opair;
+    int i;
 
-            ierr = MPI_Scatter(idata, olen, MPI_DOUBLE, odata, olen, MPI_DOUBLE, root, comm);
-            Tcl_Free((char *)idata);
+    result = Tcl_NewListObj(0, NULL);
+    for (i = 0; i < len; ++i) {
+        opair = Tcl_NewListObj(0, NULL);
+        if (type == TCLMPI_INT_INT) {
+            Tcl_ListObjAppendElement(NULL, opair, Tcl_NewIntObj(idata[i].i1));
+            Tcl_ListObjAppendElement(NULL, opair, Tcl_NewIntObj(idata[i].i2));
         } else {
-            idata = NULL;
-            ierr  = MPI_Scatter(idata, olen, MPI_DOUBLE, odata, olen, MPI_DOUBLE, root, comm);
+            Tcl_ListObjAppendElement(NULL, opair, Tcl_NewDoubleObj(ddata[i].d));
+            Tcl_ListObjAppendElement(NULL, opair, Tcl_NewIntObj(ddata[i].i));
         }
-        for (i = 0; i < olen; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewDoubleObj(odata[i]));
-        Tcl_Free((char *)odata);
-
-    } else {
-        Tcl_DecrRefCount(objv[1]);
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
-                         " is not yet implemented.", NULL);
-        return TCL_ERROR;
+        Tcl_ListObjAppendElement(NULL, result, opair);
     }
-    Tcl_DecrRefCount(objv[1]);
-
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
-
-    if (result) Tcl_SetObjResult(interp, result);
-    return TCL_OK;
+    return result;
 }
 
-/*! wrapper for MPI_Allgather()
- * \param nodata ignored
+/*! Store the contents of an MPI status in a Tcl array variable
  * \param interp current Tcl interpreter
- * \param objc number of argument objects
- * \param objv list of argument object
- * \return TCL_OK or TCL_ERROR
- *
- * This function implements a gather operation that collects data for TclMPI.
- * This operation does not accept the tclmpi::auto data type, also support
- * for types outside of tclmpi::int and tclmpi::double is incomplete.
- * The length of the data is inferred from the data object passed to this
- * function and thus a 'count' argument is not needed. The number of data
- * items has to be the same on all processes on the communicator.
+ * \param statvar name of the array variable
+ * \param status pointer to the MPI status
  *
- * The result is converted back into Tcl objects and passed up as result
- * value to the calling Tcl code on all processors. If the MPI call failed,
- * an MPI error message is passed up as result instead.
+ * The array elements are MPI_SOURCE, MPI_TAG, MPI_ERROR and the number
+ * of data items for char, int and double data types (COUNT_CHAR,
+ * COUNT_INT, COUNT_DOUBLE). Any previous content of the variable is
+ * removed.
  */
-int TclMPI_Allgather(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+static void tclmpi_set_status(Tcl_Interp *interp, const char *statvar, MPI_Status *status)
 {
-    Tcl_Obj *result = NULL;
-    MPI_Comm comm;
-    int i, type, size, rank, ilen, olen, mlen, ierr = MPI_SUCCESS;
-
-    if (objc != 4) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <comm>");
-        return TCL_ERROR;
-    }
+    Tcl_Obj *var;
+    int len_char, len_int, len_double;
+
+    MPI_Get_count(status, MPI_CHAR, &len_char);
+    MPI_Get_count(status, MPI_INT, &len_int);
+    MPI_Get_count(status, MPI_DOUBLE, &len_double);
+    Tcl_UnsetVar(interp, statvar, 0);
+    var = Tcl_NewStringObj(statvar, -1);
+    Tcl_IncrRefCount(var);
+    Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status->MPI_SOURCE), 0);
+    Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status->MPI_TAG), 0);
+    Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status->MPI_ERROR), 0);
+    Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
+    Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_int), 0);
+    Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_double), 0);
+    Tcl_DecrRefCount(var);
+}
 
-    type = tclmpi_datatype(Tcl_GetString(objv[2]));
-    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+#if MPI_VERSION >= 3
+/*! Handle of a matched message that is to be received */
+typedef MPI_Message tclmpi_msg_t;
+#else
+/*! Handle of a matched message. Without MPI_Message, the message is
+ *  identified by the source rank and tag from the status of a probe. */
+typedef struct tclmpi_msg tclmpi_msg_t;
+
+/*! Source, tag and communicator of a probed message */
+struct tclmpi_msg {
+    int source;    /*!< rank of the sending process */
+    int tag;       /*!< tag of the message */
+    MPI_Comm comm; /*!< communicator of the message */
+};
+#endif
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[3]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[3]) != TCL_OK) return TCL_ERROR;
+/*! Probe for a message and match it for receiving
+ * \param source rank of the sending process or MPI_ANY_SOURCE
+ * \param tag message tag or MPI_ANY_TAG
+ * \param comm MPI communicator
+ * \param pending NULL to block until a message is pending, otherwise
+ *        pointer to location for storing whether a message was matched
+ * \param msg pointer to location for storing the matched message
+ * \param status pointer to the MPI status of the matched message
+ * \return MPI error code
+ *
+ * With MPI_Mprobe or MPI_Improbe the message is matched only once and
+ * cannot be received by any other receive until tclmpi_recv_msg is called.
+ */
+static int tclmpi_probe_msg(int source, int tag, MPI_Comm comm, int *pending, tclmpi_msg_t *msg,
+                            MPI_Status *status)
+{
+#if MPI_VERSION >= 3
+    if (pending != NULL) return MPI_Improbe(source, tag, comm, pending, msg, status);
+    return MPI_Mprobe(source, tag, comm, msg, status);
+#else
+    int ierr;
 
-    /* special case check for reduction */
-    if (type == TCLMPI_AUTO) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
-        return TCL_ERROR;
-    }
+    if (pending != NULL)
+        ierr = MPI_Iprobe(source, tag, comm, pending, status);
+    else
+        ierr = MPI_Probe(source, tag, comm, status);
+    msg->source = status->MPI_SOURCE;
+    msg->tag    = status->MPI_TAG;
+    msg->comm   = comm;
+    return ierr;
+#endif
+}
 
-    MPI_Comm_size(comm, &size);
-    MPI_Comm_rank(comm, &rank);
-    Tcl_IncrRefCount(objv[1]);
+/*! Receive a message that was matched by tclmpi_probe_msg
+ * \param data pointer to the receive buffer
+ * \param len number of data elements in the receive buffer
+ * \param mtype MPI data type of the data elements
+ * \param msg pointer to the matched message
+ * \param req NULL for a blocking receive, otherwise pointer to the
+ *        MPI request for a non-blocking receive
+ * \param status pointer to the MPI status or MPI_STATUS_IGNORE for a
+ *        blocking receive
+ * \return MPI error code
+ */
+static int tclmpi_recv_msg(void *data, int len, MPI_Datatype mtype, tclmpi_msg_t *msg, MPI_Request *req,
+                           MPI_Status *status)
+{
+#if MPI_VERSION >= 3
+    if (req != NULL) return MPI_Imrecv(data, len, mtype, msg, req);
+    return MPI_Mrecv(data, len, mtype, msg, status);
+#else
+    if (req != NULL) return MPI_Irecv(data, len, mtype, msg->source, msg->tag, msg->comm, req);
+    return MPI_Recv(data, len, mtype, msg->source, msg->tag, msg->comm, status);
+#endif
+}
 
-    if (type == TCLMPI_INT) {
-        Tcl_Obj **ilist;
-        int *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &ilen, &ilist) != TCL_OK) return TCL_ERROR;
-        MPI_Allreduce(&ilen, &olen, 1, MPI_INT, MPI_MAX, comm);
-        MPI_Allreduce(&ilen, &mlen, 1, MPI_INT, MPI_MIN, comm);
-        if (olen != mlen) {
-            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": number of data items must be the same on all processes",
-                             NULL);
-            Tcl_DecrRefCount(objv[1]);
-            return TCL_ERROR;
-        }
+/*! Convert the contents of an MPI status into a Tcl list
+ * \param status pointer to the MPI status
+ * \return a new Tcl list with the same keys and values as tclmpi_set_status
+ *
+ * The list has the format of the result of ``array get``, so that
+ * commands can return the status for multiple requests at once.
+ */
+static Tcl_Obj *tclmpi_status_obj(MPI_Status *status)
+{
+    Tcl_Obj *list;
+    int len_char, len_int, len_double;
+
+    MPI_Get_count(status, MPI_CHAR, &len_char);
+    MPI_Get_count(status, MPI_INT, &len_int);
+    MPI_Get_count(status, MPI_DOUBLE, &len_double);
+    list = Tcl_NewListObj(0, NULL);
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewStringObj("MPI_SOURCE", -1));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewIntObj(status->MPI_SOURCE));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewStringObj("MPI_TAG", -1));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewIntObj(status->MPI_TAG));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewStringObj("MPI_ERROR", -1));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewIntObj(status->MPI_ERROR));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewStringObj("COUNT_CHAR", -1));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewIntObj(len_char));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewStringObj("COUNT_INT", -1));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewIntObj(len_int));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewStringObj("COUNT_DOUBLE", -1));
+    Tcl_ListObjAppendElement(NULL, list, Tcl_NewIntObj(len_double));
+    return list;
+}
 
-        mlen  = olen * size;
-        idata = (int *)Tcl_Alloc(ilen * sizeof(int));
-        odata = (int *)Tcl_Alloc(mlen * sizeof(int));
-        for (i = 0; i < ilen; ++i) TCLMPI_CONV_CHECK(Int, ilist[i], idata + i, idata[i]);
+/*! Check whether a request is a non-blocking receive that was not yet posted
+ * \param req pointer to the request
+ * \return non-zero if the receive still needs to be posted
+ *
+ * TclMPI_Irecv only posts MPI_Irecv when a matching message is already
+ * pending, since the size of the receive buffer is not known otherwise.
+ */
+static int tclmpi_req_deferred(tclmpi_req_t *req)
+{
+    return !req->coll && !req->persist && (req->len != TCLMPI_INVALID) && (req->obj == NULL);
+}
 
-        result = Tcl_NewListObj(0, NULL);
-        ierr   = MPI_Allgather(idata, ilen, MPI_INT, odata, olen, MPI_INT, comm);
-        for (i = 0; i < mlen; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(odata[i]));
-        Tcl_Free((char *)odata);
-        Tcl_Free((char *)idata);
-
-    } else if (type == TCLMPI_DOUBLE) {
-        Tcl_Obj **ilist;
-        double *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &ilen, &ilist) != TCL_OK) return TCL_ERROR;
-        MPI_Allreduce(&ilen, &olen, 1, MPI_INT, MPI_MAX, comm);
-        MPI_Allreduce(&ilen, &mlen, 1, MPI_INT, MPI_MIN, comm);
-        if (olen != mlen) {
-            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": number of data items must be the same on all processes",
-                             NULL);
-            Tcl_DecrRefCount(objv[1]);
-            return TCL_ERROR;
-        }
+/*! Post a deferred non-blocking receive
+ * \param req pointer to the request of a deferred receive
+ * \param block non-zero to wait for a matching message
+ * \return MPI error code
+ *
+ * If a matching message is pending (or block is non-zero), the receive
+ * buffer is sized to the message and the receive for exactly this
+ * message is posted, like it is done by TclMPI_Irecv. Otherwise the request is left unchanged. For
+ * data types without receive support, an empty list is the result and
+ * the MPI request is set to MPI_REQUEST_NULL, so it completes at once.
+ */
+static int tclmpi_post_req(tclmpi_req_t *req, int block)
+{
+    MPI_Datatype mtype;
+    MPI_Status status;
+    tclmpi_msg_t msg;
+    int pending, len, ierr;
+
+    if ((req->type != TCLMPI_AUTO) && (req->type != TCLMPI_BYTES) && (req->type != TCLMPI_INT) &&
+        (req->type != TCLMPI_DOUBLE)) {
+        req->obj = Tcl_NewListObj(0, NULL);
+        Tcl_IncrRefCount(req->obj);
+        *req->req = MPI_REQUEST_NULL;
+        return MPI_SUCCESS;
+    }
 
-        mlen  = olen * size;
-        idata = (double *)Tcl_Alloc(ilen * sizeof(double));
-        odata = (double *)Tcl_Alloc(mlen * sizeof(double));
-        for (i = 0; i < ilen; ++i) TCLMPI_CONV_CHECK(Double, ilist[i], idata + i, idata[i]);
+    memset(&status, 0, sizeof(status));
+    pending = 1;
+    ierr    = tclmpi_probe_msg(req->source, req->tag, req->comm, block ? NULL : &pending, &msg, &status);
+    if ((ierr != MPI_SUCCESS) || !pending) return ierr;
+
+    mtype = tclmpi_mpitype(req->type);
+    MPI_Get_count(&status, mtype, &len);
+    req->obj = tclmpi_recv_obj(req->type, len, &req->data);
+    Tcl_IncrRefCount(req->obj);
+    req->len = len;
+    return tclmpi_recv_msg(req->data, len, mtype, &msg, req->req, NULL);
+}
 
-        result = Tcl_NewListObj(0, NULL);
-        ierr   = MPI_Allgather(idata, ilen, MPI_DOUBLE, odata, olen, MPI_DOUBLE, comm);
-        for (i = 0; i < mlen; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewDoubleObj(odata[i]));
-        Tcl_Free((char *)odata);
-        Tcl_Free((char *)idata);
+/*! Post all deferred receives in a list of requests with pending messages
+ * \param num number of requests
+ * \param reqs list of requests. NULL entries are ignored
+ * \param mpireqs list of MPI requests that is updated for posted receives
+ * \param ierr pointer to location for storing the MPI error code
+ * \return number of receives that are still deferred
+ */
+static int tclmpi_post_reqs(int num, tclmpi_req_t **reqs, MPI_Request *mpireqs, int *ierr)
+{
+    int i, deferred = 0;
+
+    *ierr = MPI_SUCCESS;
+    for (i = 0; i < num; ++i) {
+        if ((reqs[i] == NULL) || !tclmpi_req_deferred(reqs[i])) continue;
+        *ierr = tclmpi_post_req(reqs[i], 0);
+        if (*ierr != MPI_SUCCESS) return 0;
+        if (tclmpi_req_deferred(reqs[i]))
+            ++deferred;
+        else
+            mpireqs[i] = *reqs[i]->req;
+    }
+    return deferred;
+}
 
+/*! Trim the result of a non-blocking receive to the received data
+ * \param req pointer to the completed request
+ * \param status pointer to the MPI status of the completion
+ * \return the Tcl object of the request that owns the received data
+ *
+ * A receive posted with a capacity hint (see TclMPI_Irecv) may have
+ * received less data than the buffer can hold, so the length of the
+ * result is set from the MPI status. The buffer itself is not shrunk.
+ */
+static Tcl_Obj *tclmpi_trim_obj(tclmpi_req_t *req, MPI_Status *status)
+{
+    Tcl_Obj *obj = req->obj;
+    int len;
+
+    if (req->coll || (req->len == TCLMPI_INVALID)) return obj;
+    if ((req->type != TCLMPI_AUTO) && (req->type != TCLMPI_BYTES) && (req->type != TCLMPI_INT) &&
+        (req->type != TCLMPI_DOUBLE))
+        return obj;
+
+    MPI_Get_count(status, tclmpi_mpitype(req->type), &len);
+    if ((len == MPI_UNDEFINED) || (len >= req->len)) return obj;
+
+    if (req->type == TCLMPI_AUTO) {
+        obj->bytes[len] = '\0';
+        obj->length     = len;
+    } else if (req->type == TCLMPI_BYTES) {
+        Tcl_SetByteArrayLength(obj, len);
     } else {
-        Tcl_DecrRefCount(objv[1]);
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
-                         " is not yet implemented.", NULL);
-        return TCL_ERROR;
+        TCLMPI_VEC(obj)->len = len;
     }
-    Tcl_DecrRefCount(objv[1]);
-
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
-
-    if (result) Tcl_SetObjResult(interp, result);
-    return TCL_OK;
+    return obj;
 }
 
-/*! wrapper for MPI_Gather()
- * \param nodata ignored
- * \param interp current Tcl interpreter
- * \param objc number of argument objects
+/*! Get the result of a completed request and release the request
+ * \param req pointer to the completed request or NULL
+ * \param status pointer to the MPI status of the completion
+ * \return Tcl object with the result. The caller owns one reference.
+ *
+ * Receives and non-blocking collectives return the received data,
+ * sends return an empty object. Except for persistent requests, which
+ * can be started again, the request is removed from the request table.
+ */
+static Tcl_Obj *tclmpi_req_done(tclmpi_req_t *req, MPI_Status *status)
+{
+    Tcl_Obj *result;
+
+    if (req == NULL) {
+        result = Tcl_NewObj();
+    } else if (req->persist) {
+        if (req->active && (req->persist == TCLMPI_RECV_INIT)) {
+            MPI_Datatype mtype = tclmpi_mpitype(req->type);
+            void *idata;
+            int len, esize;
+
+            /* the count is undefined, if the data does not fit the type */
+            if ((MPI_Get_count(status, mtype, &len) != MPI_SUCCESS) || (len == MPI_UNDEFINED) || (len < 0)) len = 0;
+            if ((req->len >= 0) && (len > req->len)) len = req->len;
+            MPI_Type_size(mtype, &esize);
+            result = tclmpi_recv_obj(req->type, len, &idata);
+            memcpy(idata, req->data, (size_t)len * esize);
+        } else
+            result = Tcl_NewObj();
+        req->active = 0;
+    } else {
+        /* pairs of non-blocking collectives are converted after completion,
+           all other data was received directly into the result object */
+        if (req->coll && ((req->type == TCLMPI_INT_INT) || (req->type == TCLMPI_DOUBLE_INT)))
+            result = tclmpi_new_pairs(req->type, req->len, req->data);
+        else if (req->obj != NULL)
+            result = tclmpi_trim_obj(req, status);
+        else if (req->coll)
+            result = Tcl_NewListObj(0, NULL);
+        else
+            result = Tcl_NewObj();
+    }
+    tclmpi_vec_result(result);
+    Tcl_IncrRefCount(result);
+    if ((req != NULL) && !req->persist) tclmpi_del_req(req);
+    return result;
+}
+
+/*! Temporary storage for commands that operate on a list of requests */
+typedef struct tclmpi_reqlist tclmpi_reqlist_t;
+
+/*! Requests, MPI requests and results of a list of requests */
+struct tclmpi_reqlist {
+    int num;              /*!< number of requests in the list */
+    tclmpi_req_t **reqs;  /*!< requests, NULL if unknown or completed */
+    MPI_Request *mpireqs; /*!< MPI request handles as passed to MPI */
+    MPI_Status *status;   /*!< MPI status for each request */
+    int *index;           /*!< indices of completed requests */
+    Tcl_Obj **result;     /*!< result of each completed request or NULL */
+    Tcl_Obj **stat;       /*!< status list of each completed request or NULL */
+};
+
+/*! Look up a Tcl list of requests
+ * \param interp current Tcl interpreter
+ * \param obj Tcl list of request handles
+ * \param list pointer to the tclmpi_reqlist_t struct to be set up
+ * \return TCL_OK or TCL_ERROR
+ *
+ * Unknown requests are treated like MPI_REQUEST_NULL, as for TclMPI_Wait,
+ * and so are all but the first occurrence of a request listed repeatedly.
+ * The arrays are stored in the scratch buffer of the interpreter and the
+ * results have to be released with tclmpi_free_reqs.
+ */
+static int tclmpi_get_reqs(Tcl_Interp *interp, Tcl_Obj *obj, tclmpi_reqlist_t *list)
+{
+    Tcl_Obj **elems;
+    size_t size[6];
+    char *ptr;
+    int i;
+
+    memset(list, 0, sizeof(tclmpi_reqlist_t));
+    if (Tcl_ListObjGetElements(interp, obj, &list->num, &elems) != TCL_OK) return TCL_ERROR;
+
+    /* all arrays are carved from the scratch buffer */
+    size[0] = TCLMPI_SCRATCH_ALIGN(list->num * sizeof(tclmpi_req_t *));
+    size[1] = TCLMPI_SCRATCH_ALIGN(list->num * sizeof(MPI_Request));
+    size[2] = TCLMPI_SCRATCH_ALIGN(list->num * sizeof(MPI_Status));
+    size[3] = TCLMPI_SCRATCH_ALIGN(list->num * sizeof(int));
+    size[4] = TCLMPI_SCRATCH_ALIGN(list->num * sizeof(Tcl_Obj *));
+    size[5] = TCLMPI_SCRATCH_ALIGN(list->num * sizeof(Tcl_Obj *));
+    ptr     = (char *)tclmpi_scratch(interp, size[0] + size[1] + size[2] + size[3] + size[4] + size[5]);
+
+    list->reqs    = (tclmpi_req_t **)ptr;
+    list->mpireqs = (MPI_Request *)(ptr += size[0]);
+    list->status  = (MPI_Status *)(ptr += size[1]);
+    list->index   = (int *)(ptr += size[2]);
+    list->result  = (Tcl_Obj **)(ptr += size[3]);
+    list->stat    = (Tcl_Obj **)(ptr += size[4]);
+    memset(list->status, 0, list->num * sizeof(MPI_Status));
+    for (i = 0; i < list->num; ++i) {
+        list->reqs[i] = tclmpi_find_req(elems[i]);
+        /* a request must only be completed and released once */
+        if (list->reqs[i] != NULL) {
+            if (list->reqs[i]->listed)
+                list->reqs[i] = NULL;
+            else
+                list->reqs[i]->listed = 1;
+        }
+        list->mpireqs[i] = list->reqs[i] ? *list->reqs[i]->req : MPI_REQUEST_NULL;
+        list->result[i]  = NULL;
+        list->stat[i]    = NULL;
+    }
+    for (i = 0; i < list->num; ++i) {
+        if (list->reqs[i] != NULL) list->reqs[i]->listed = 0;
+    }
+    return TCL_OK;
+}
+
+/*! Store the result of a completed request from a list of requests
+ * \param list pointer to the list of requests
+ * \param i index of the completed request in the list
+ * \param status pointer to the MPI status of the completion
+ * \param withstat non-zero if the status is needed as Tcl list
+ */
+static void tclmpi_reqs_done(tclmpi_reqlist_t *list, int i, MPI_Status *status, int withstat)
+{
+    if (list->result[i] == NULL) list->result[i] = tclmpi_req_done(list->reqs[i], status);
+    if (withstat && (list->stat[i] == NULL)) {
+        list->stat[i] = tclmpi_status_obj(status);
+        Tcl_IncrRefCount(list->stat[i]);
+    }
+    list->reqs[i] = NULL;
+}
+
+/*! Release the results of a list of requests
+ * \param list pointer to the list of requests
+ */
+static void tclmpi_free_reqs(tclmpi_reqlist_t *list)
+{
+    int i;
+
+    for (i = 0; i < list->num; ++i) {
+        if (list->result[i]) Tcl_DecrRefCount(list->result[i]);
+        if (list->stat[i]) Tcl_DecrRefCount(list->stat[i]);
+    }
+}
+
+/* Tcl event source for message arrival and request completion */
+
+/*! Handler for tclmpi::onmessage or tclmpi::oncomplete */
+typedef struct tclmpi_handler tclmpi_handler_t;
+
+/*! Script to be evaluated when a message arrives or a request completes */
+struct tclmpi_handler {
+    Tcl_Interp *interp;     /*!< interpreter to evaluate the script in */
+    Tcl_Obj *script;        /*!< script to be evaluated */
+    MPI_Comm comm;          /*!< communicator of the message */
+    int source;             /*!< source rank of the message or MPI_ANY_SOURCE */
+    int tag;                /*!< tag of the message or MPI_ANY_TAG */
+    int id;                 /*!< unique number of the request */
+    int queued;             /*!< non-zero while an event is queued for a message */
+    tclmpi_handler_t *next; /*!< next handler in the list */
+};
+
+/*! Tcl event for a message handler or a completed request */
+typedef struct tclmpi_event tclmpi_event_t;
+
+/*! Tcl event with the command to be evaluated */
+struct tclmpi_event {
+    Tcl_Event header;          /*!< Tcl event header. must be the first member */
+    tclmpi_handler_t *handler; /*!< message handler or NULL for completed requests */
+    Tcl_Interp *interp;        /*!< interpreter to evaluate the command in */
+    Tcl_Obj *cmd;              /*!< command with the arguments appended */
+};
+
+/*! Event source state of a thread */
+typedef struct tclmpi_tsd tclmpi_tsd_t;
+
+/*! Handlers and event source state. Tcl event sources are per thread,
+ *  so this is kept as thread specific data. */
+struct tclmpi_tsd {
+    tclmpi_handler_t *msg_handlers; /*!< list of message handlers */
+    tclmpi_handler_t *req_handlers; /*!< list of request completion handlers */
+    int event_init;                 /*!< non-zero if the event source has been created */
+    int poll_time;                  /*!< current polling interval of the event source in microseconds */
+    char *buf;                      /*!< buffer for the request arrays of tclmpi_event_check */
+    size_t buf_size;                /*!< size of buf in bytes */
+};
+
+/*! Key for the thread specific event source state */
+static Tcl_ThreadDataKey tclmpi_tsd_key;
+
+/*! Access the event source state of the current thread */
+#define TCLMPI_TSD ((tclmpi_tsd_t *)Tcl_GetThreadData(&tclmpi_tsd_key, sizeof(tclmpi_tsd_t)))
+
+/*! Evaluate the command of an MPI event
+ * \param evptr pointer to the Tcl event
+ * \param flags event flags passed to Tcl_DoOneEvent()
+ * \return 1 if the event was processed, 0 otherwise
+ *
+ * Errors are reported as background errors, like for fileevent scripts.
+ * The interpreter was preserved by tclmpi_queue_event and is released.
+ */
+static int tclmpi_event_proc(Tcl_Event *evptr, int flags)
+{
+    tclmpi_event_t *ev = (tclmpi_event_t *)evptr;
+    Tcl_Interp *interp = ev->interp;
+
+    if (!(flags & TCL_FILE_EVENTS)) return 0;
+    if (ev->handler) ev->handler->queued = 0;
+
+    if (!Tcl_InterpDeleted(interp) && (Tcl_EvalObjEx(interp, ev->cmd, TCL_EVAL_GLOBAL) != TCL_OK))
+        Tcl_BackgroundException(interp, TCL_ERROR);
+    Tcl_Release(interp);
+    Tcl_DecrRefCount(ev->cmd);
+    return 1;
+}
+
+/*! Select queued events of a message handler or an interpreter for deletion
+ * \param evptr pointer to the Tcl event
+ * \param data pointer to the handler or the interpreter that is deleted
+ * \return 1 if the event belongs to the handler or interpreter, 0 otherwise
+ */
+static int tclmpi_event_delete(Tcl_Event *evptr, ClientData data)
+{
+    tclmpi_event_t *ev = (tclmpi_event_t *)evptr;
+
+    if (evptr->proc != tclmpi_event_proc) return 0;
+    if ((ev->handler != (tclmpi_handler_t *)data) && (ev->interp != (Tcl_Interp *)data)) return 0;
+    Tcl_Release(ev->interp);
+    Tcl_DecrRefCount(ev->cmd);
+    return 1;
+}
+
+/*! Queue a Tcl event for a script with arguments appended
+ * \param interp interpreter to evaluate the script in
+ * \param handler message handler or NULL
+ * \param script script to be evaluated
+ * \param arg1 first argument to be appended
+ * \param arg2 second argument to be appended
+ * \param arg3 third argument to be appended or NULL
+ *
+ * The interpreter is preserved until the event is processed or deleted.
+ */
+static void tclmpi_queue_event(Tcl_Interp *interp, tclmpi_handler_t *handler, Tcl_Obj *script, Tcl_Obj *arg1,
+                               Tcl_Obj *arg2, Tcl_Obj *arg3)
+{
+    tclmpi_event_t *ev;
+
+    ev                = (tclmpi_event_t *)Tcl_Alloc(sizeof(tclmpi_event_t));
+    ev->header.proc   = tclmpi_event_proc;
+    ev->handler       = handler;
+    ev->interp        = interp;
+    ev->cmd           = Tcl_DuplicateObj(script);
+    Tcl_IncrRefCount(ev->cmd);
+    Tcl_Preserve(interp);
+    Tcl_ListObjAppendElement(NULL, ev->cmd, arg1);
+    Tcl_ListObjAppendElement(NULL, ev->cmd, arg2);
+    if (arg3 != NULL) Tcl_ListObjAppendElement(NULL, ev->cmd, arg3);
+    Tcl_QueueEvent((Tcl_Event *)ev, TCL_QUEUE_TAIL);
+}
+
+/*! Report the failure of a request with a completion handler
+ * \param h completion handler of the request
+ * \param req the failed request
+ * \param ierr MPI error code
+ *
+ * The script of the handler is evaluated with the request, empty data
+ * and the error message appended, so that e.g. a coroutine waiting in
+ * tclmpi::co::wait can be resumed with the error. The request is kept.
+ */
+static void tclmpi_event_error(tclmpi_handler_t *h, tclmpi_req_t *req, int ierr)
+{
+    char errmsg[MPI_MAX_ERROR_STRING];
+    int len, eclass;
+
+    MPI_Error_class(ierr, &eclass);
+    MPI_Error_string(eclass, errmsg, &len);
+    tclmpi_queue_event(h->interp, NULL, h->script, tclmpi_req_obj(req), Tcl_NewObj(),
+                       Tcl_ObjPrintf("tclmpi::oncomplete: %s", errmsg));
+}
+
+/*! Set the maximum time to block in the Tcl event loop
+ * \param data ignored
+ * \param flags event flags passed to Tcl_DoOneEvent()
+ *
+ * While there are handlers, the notifier wakes up after the current
+ * polling interval, so that MPI can be polled for events.
+ */
+static void tclmpi_event_setup(ClientData data, int flags)
+{
+    tclmpi_tsd_t *tsd = TCLMPI_TSD;
+    Tcl_Time block;
+
+    if (!(flags & TCL_FILE_EVENTS)) return;
+    if ((tsd->msg_handlers == NULL) && (tsd->req_handlers == NULL)) return;
+
+    block.sec  = tsd->poll_time / 1000000;
+    block.usec = tsd->poll_time % 1000000;
+    Tcl_SetMaxBlockTime(&block);
+}
+
+/*! Poll MPI for pending messages and completed requests
+ * \param data ignored
+ * \param flags event flags passed to Tcl_DoOneEvent()
+ *
+ * Message handlers are checked with MPI_Iprobe. The message is left
+ * for the script to receive, so the handler fires again, if it does not.
+ * Requests with completion handlers are checked with a single call to
+ * MPI_Testsome after posting deferred receives with pending messages.
+ * Completed requests are released like by TclMPI_Wait() and their handler
+ * removed. If posting a receive or MPI_Testsome fails, the handlers of
+ * the affected requests are removed and called with the error instead.
+ * The polling interval is reset after any event and doubled up to
+ * TCLMPI_POLL_MAX otherwise, to avoid spinning while idle.
+ */
+static void tclmpi_event_check(ClientData data, int flags)
+{
+    tclmpi_tsd_t *tsd = TCLMPI_TSD;
+    tclmpi_handler_t *h, **prev, **hlist;
+    tclmpi_req_t **reqs;
+    MPI_Request *mpireqs;
+    MPI_Status status, *statuses;
+    size_t size[5], total;
+    char *ptr;
+    int i, num, count, pending, ierr, events = 0, *index;
+
+    if (!(flags & TCL_FILE_EVENTS)) return;
+
+    for (h = tsd->msg_handlers; h != NULL; h = h->next) {
+        if (h->queued) continue;
+        pending = 0;
+        memset(&status, 0, sizeof(status));
+        MPI_Iprobe(h->source, h->tag, h->comm, &pending, &status);
+        if (pending) {
+            h->queued = 1;
+            tclmpi_queue_event(h->interp, h, h->script, Tcl_NewIntObj(status.MPI_SOURCE),
+                               Tcl_NewIntObj(status.MPI_TAG), NULL);
+            ++events;
+        }
+    }
+
+    for (num = 0, h = tsd->req_handlers; h != NULL; h = h->next) ++num;
+    if (num > 0) {
+        /* the arrays are kept between polls and only grow */
+        size[0] = TCLMPI_SCRATCH_ALIGN(num * sizeof(tclmpi_handler_t *));
+        size[1] = TCLMPI_SCRATCH_ALIGN(num * sizeof(tclmpi_req_t *));
+        size[2] = TCLMPI_SCRATCH_ALIGN(num * sizeof(MPI_Request));
+        size[3] = TCLMPI_SCRATCH_ALIGN(num * sizeof(MPI_Status));
+        size[4] = TCLMPI_SCRATCH_ALIGN(num * sizeof(int));
+        total   = size[0] + size[1] + size[2] + size[3] + size[4];
+        if (total > tsd->buf_size) {
+            if (tsd->buf) Tcl_Free(tsd->buf);
+            tsd->buf      = Tcl_Alloc(total);
+            tsd->buf_size = total;
+        }
+        ptr      = tsd->buf;
+        hlist    = (tclmpi_handler_t **)ptr;
+        reqs     = (tclmpi_req_t **)(ptr += size[0]);
+        mpireqs  = (MPI_Request *)(ptr += size[1]);
+        statuses = (MPI_Status *)(ptr += size[2]);
+        index    = (int *)(ptr += size[3]);
+
+        /* collect active requests. requests that were released in
+           the meantime drop their handler, inactive ones complete. */
+        count = 0;
+        prev  = &tsd->req_handlers;
+        while ((h = *prev) != NULL) {
+            tclmpi_req_t *req = tclmpi_get_req(h->id);
+            ierr              = MPI_SUCCESS;
+            if ((req != NULL) && tclmpi_req_deferred(req)) ierr = tclmpi_post_req(req, 0);
+            if (ierr != MPI_SUCCESS) {
+                /* report the failure to the handler and drop it */
+                tclmpi_event_error(h, req, ierr);
+                ++events;
+            } else if ((req == NULL) || (req->persist && !req->active) ||
+                       (!tclmpi_req_deferred(req) && (*req->req == MPI_REQUEST_NULL))) {
+                if (req != NULL) {
+                    Tcl_Obj *label = tclmpi_req_obj(req);
+                    Tcl_Obj *result;
+                    memset(&status, 0, sizeof(status));
+                    result = tclmpi_req_done(req, &status);
+                    tclmpi_queue_event(h->interp, NULL, h->script, label, result, NULL);
+                    Tcl_DecrRefCount(result);
+                    ++events;
+                }
+            } else {
+                if (!tclmpi_req_deferred(req)) {
+                    hlist[count]   = h;
+                    reqs[count]    = req;
+                    mpireqs[count] = *req->req;
+                    ++count;
+                }
+                prev = &h->next;
+                continue;
+            }
+            *prev = h->next;
+            Tcl_DecrRefCount(h->script);
+            Tcl_Free((char *)h);
+        }
+
+        num  = 0;
+        ierr = MPI_SUCCESS;
+        if (count > 0) ierr = MPI_Testsome(count, mpireqs, &num, index, statuses);
+        if ((ierr != MPI_SUCCESS) && (ierr != MPI_ERR_IN_STATUS)) {
+            /* the state of the requests is unknown. report the failure
+               for all tested requests and drop their handlers */
+            for (i = 0; i < count; ++i) {
+                h = hlist[i];
+                tclmpi_event_error(h, reqs[i], ierr);
+                for (prev = &tsd->req_handlers; *prev != h; prev = &(*prev)->next)
+                    ;
+                *prev = h->next;
+                Tcl_DecrRefCount(h->script);
+                Tcl_Free((char *)h);
+                ++events;
+            }
+            num = 0;
+        }
+        for (i = 0; (num != MPI_UNDEFINED) && (i < num); ++i) {
+            tclmpi_req_t *req = reqs[index[i]];
+            Tcl_Obj *label    = tclmpi_req_obj(req);
+            Tcl_Obj *result   = tclmpi_req_done(req, statuses + i);
+
+            h = hlist[index[i]];
+            tclmpi_queue_event(h->interp, NULL, h->script, label, result, NULL);
+            Tcl_DecrRefCount(result);
+            for (prev = &tsd->req_handlers; *prev != h; prev = &(*prev)->next)
+                ;
+            *prev = h->next;
+            Tcl_DecrRefCount(h->script);
+            Tcl_Free((char *)h);
+            ++events;
+        }
+    }
+
+    if (events > 0)
+        tsd->poll_time = TCLMPI_POLL_MIN;
+    else if (tsd->poll_time < TCLMPI_POLL_MAX)
+        tsd->poll_time *= 2;
+}
+
+/*! Register the event source with the Tcl notifier when needed */
+static void tclmpi_event_start()
+{
+    tclmpi_tsd_t *tsd = TCLMPI_TSD;
+    if (tsd->event_init) return;
+    Tcl_CreateEventSource(tclmpi_event_setup, tclmpi_event_check, NULL);
+    tsd->event_init = 1;
+    tsd->poll_time  = TCLMPI_POLL_MIN;
+}
+
+/*! Remove all handlers and the event source
+ *
+ * This is needed before MPI_Finalize(), since MPI cannot be polled after.
+ */
+static void tclmpi_event_stop()
+{
+    tclmpi_tsd_t *tsd = TCLMPI_TSD;
+    tclmpi_handler_t *h;
+
+    while ((h = tsd->msg_handlers) != NULL) {
+        tsd->msg_handlers = h->next;
+        Tcl_DeleteEvents(tclmpi_event_delete, h);
+        Tcl_DecrRefCount(h->script);
+        Tcl_Free((char *)h);
+    }
+    while ((h = tsd->req_handlers) != NULL) {
+        tsd->req_handlers = h->next;
+        Tcl_DecrRefCount(h->script);
+        Tcl_Free((char *)h);
+    }
+    if (tsd->event_init) Tcl_DeleteEventSource(tclmpi_event_setup, tclmpi_event_check, NULL);
+    tsd->event_init = 0;
+    if (tsd->buf) Tcl_Free(tsd->buf);
+    tsd->buf      = NULL;
+    tsd->buf_size = 0;
+}
+
+/*! Release the TclMPI state of an interpreter that is deleted
+ * \param data pointer to the tclmpi_interp_t state
+ * \param interp the interpreter that is deleted
+ *
+ * Handlers registered from the interpreter and its queued events,
+ * including those for completed requests, are removed as well, since
+ * their scripts could no longer be evaluated.
+ */
+static void tclmpi_interp_delete(ClientData data, Tcl_Interp *interp)
+{
+    tclmpi_interp_t *state = (tclmpi_interp_t *)data;
+    tclmpi_tsd_t *tsd      = TCLMPI_TSD;
+    tclmpi_handler_t *h, **prev;
+
+    Tcl_DeleteEvents(tclmpi_event_delete, interp);
+    prev = &tsd->msg_handlers;
+    while ((h = *prev) != NULL) {
+        if (h->interp == interp) {
+            *prev = h->next;
+            Tcl_DecrRefCount(h->script);
+            Tcl_Free((char *)h);
+        } else
+            prev = &h->next;
+    }
+    prev = &tsd->req_handlers;
+    while ((h = *prev) != NULL) {
+        if (h->interp == interp) {
+            *prev = h->next;
+            Tcl_DecrRefCount(h->script);
+            Tcl_Free((char *)h);
+        } else
+            prev = &h->next;
+    }
+    if (state->scratch) Tcl_Free(state->scratch);
+    Tcl_Free((char *)state);
+}
+
+/*! Names of the MPI thread support levels for tclmpi::init -thread */
+static const char *const tclmpi_thread_names[] = {"single", "funneled", "serialized", "multiple", NULL};
+/*! MPI thread support levels matching tclmpi_thread_names */
+static const int tclmpi_thread_levels[] = {MPI_THREAD_SINGLE, MPI_THREAD_FUNNELED, MPI_THREAD_SERIALIZED,
+                                           MPI_THREAD_MULTIPLE};
+
+/* background progress thread */
+
+/*! Thread id of the progress thread */
+static Tcl_ThreadId tclmpi_progress_id;
+/*! Non-zero while the progress thread is running. Guarded by tclmpi_progress_mutex */
+static int tclmpi_progress_run = 0;
+/*! Interval between calls into MPI from the progress thread */
+static Tcl_Time tclmpi_progress_time;
+/*! Mutex protecting the progress thread state */
+TCL_DECLARE_MUTEX(tclmpi_progress_mutex)
+/*! Condition to wake up the progress thread when it is stopped */
+static Tcl_Condition tclmpi_progress_cond = NULL;
+/*! Private communicator of the progress thread */
+static MPI_Comm tclmpi_progress_comm;
+/*! Receive request that is only tested by the progress thread */
+static MPI_Request tclmpi_progress_req;
+/*! Receive buffer for tclmpi_progress_req */
+static int tclmpi_progress_buf;
+
+/*! Main function of the progress thread
+ * \param data ignored
+ *
+ * Many MPI libraries only advance transfers, e.g. for the rendezvous
+ * protocol of large messages, while the application is inside an MPI
+ * call. This thread calls MPI_Test() periodically, so that outstanding
+ * transfers progress while the interpreter is busy with other work.
+ * The requests of the interpreter cannot be tested here, since MPI does
+ * not allow to complete the same request concurrently from two threads.
+ * Instead, a receive request on a private communicator is tested, which
+ * never matches a message, but drives the progress engine of the MPI
+ * library for all outstanding transfers. Between tests the thread sleeps
+ * on tclmpi_progress_cond for the given interval; this requires Tcl to be
+ * compiled with thread support, as enforced at the top of this file.
+ */
+static Tcl_ThreadCreateType tclmpi_progress_proc(ClientData data)
+{
+    int flag;
+
+    Tcl_MutexLock(&tclmpi_progress_mutex);
+    while (tclmpi_progress_run) {
+        Tcl_ConditionWait(&tclmpi_progress_cond, &tclmpi_progress_mutex, &tclmpi_progress_time);
+        if (!tclmpi_progress_run) break;
+        Tcl_MutexUnlock(&tclmpi_progress_mutex);
+        MPI_Test(&tclmpi_progress_req, &flag, MPI_STATUS_IGNORE);
+        Tcl_MutexLock(&tclmpi_progress_mutex);
+    }
+    Tcl_MutexUnlock(&tclmpi_progress_mutex);
+    TCL_THREAD_CREATE_RETURN;
+}
+
+/*! Start the progress thread
+ * \param usec interval between calls into MPI in microseconds
+ * \return TCL_OK or TCL_ERROR
+ */
+static int tclmpi_progress_start(int usec)
+{
+    if (MPI_Comm_dup(MPI_COMM_SELF, &tclmpi_progress_comm) != MPI_SUCCESS) return TCL_ERROR;
+    MPI_Irecv(&tclmpi_progress_buf, 1, MPI_INT, 0, 0, tclmpi_progress_comm, &tclmpi_progress_req);
+
+    Tcl_MutexLock(&tclmpi_progress_mutex);
+    tclmpi_progress_time.sec  = usec / 1000000;
+    tclmpi_progress_time.usec = usec % 1000000;
+    tclmpi_progress_run       = 1;
+    Tcl_MutexUnlock(&tclmpi_progress_mutex);
+    if (Tcl_CreateThread(&tclmpi_progress_id, tclmpi_progress_proc, NULL, TCL_THREAD_STACK_DEFAULT,
+                         TCL_THREAD_JOINABLE) != TCL_OK) {
+        Tcl_MutexLock(&tclmpi_progress_mutex);
+        tclmpi_progress_run = 0;
+        Tcl_MutexUnlock(&tclmpi_progress_mutex);
+        MPI_Cancel(&tclmpi_progress_req);
+        MPI_Wait(&tclmpi_progress_req, MPI_STATUS_IGNORE);
+        MPI_Comm_free(&tclmpi_progress_comm);
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*! Stop the progress thread, if it is running
+ *
+ * This is needed before MPI_Finalize(), since MPI cannot be called after.
+ */
+static void tclmpi_progress_stop()
+{
+    int result;
+
+    Tcl_MutexLock(&tclmpi_progress_mutex);
+    if (!tclmpi_progress_run) {
+        Tcl_MutexUnlock(&tclmpi_progress_mutex);
+        return;
+    }
+    tclmpi_progress_run = 0;
+    Tcl_ConditionNotify(&tclmpi_progress_cond);
+    Tcl_MutexUnlock(&tclmpi_progress_mutex);
+    Tcl_JoinThread(tclmpi_progress_id, &result);
+
+    MPI_Cancel(&tclmpi_progress_req);
+    MPI_Wait(&tclmpi_progress_req, MPI_STATUS_IGNORE);
+    MPI_Comm_free(&tclmpi_progress_comm);
+}
+
+/*!
+ * @}
+ */
+
+/*!
+ * \defgroup wrappers TclMPI wrapper functions
+ * @{
+ */
+
+/*! wrapper for MPI_Initialized()
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function checks whether the MPI environment has been initialized.
+ */
+int TclMPI_Initialized(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result;
+    int tclmpi_init_done;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, NULL);
+        return TCL_ERROR;
+    }
+
+    MPI_Initialized(&tclmpi_init_done);
+    result = Tcl_NewIntObj(tclmpi_init_done);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Finalized()
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function checks whether the MPI environment has been shut down.
+ */
+int TclMPI_Finalized(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result;
+    int tclmpi_init_done;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, NULL);
+        return TCL_ERROR;
+    }
+
+    MPI_Finalized(&tclmpi_init_done);
+    result = Tcl_NewIntObj(tclmpi_init_done);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Init()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function does a little more work than just calling MPI_Init().
+ * First of it tries to detect whether MPI_Init() has been called before
+ * (from Tcl) and then creates a (catchable) Tcl error instead of an
+ * (uncatchable) MPI error. It will also try to pass the argument vector
+ * to the script from the Tcl generated 'argv' array to the underlying
+ * MPI_Init() call and reset argv as needed.
+ *
+ * The optional "-thread <level>" flag selects the requested level of
+ * thread support (single, funneled, serialized, or multiple). The default
+ * is single. With multiple, interpreters in different threads (e.g.
+ * from the Tcl Thread package) can load TclMPI and use it concurrently.
+ * The level actually provided by the MPI library may be lower and can
+ * be queried with tclmpi::query_thread.
+ *
+ * The optional "-progress <usec>" flag starts a background thread that
+ * calls into MPI every <usec> microseconds, so that transfers progress
+ * while the script is busy otherwise (see tclmpi_progress_proc). This
+ * requires MPI_THREAD_MULTIPLE, which is then requested implicitly.
+ *
+ * The optional "-convthreads <num>" flag allows to use up to <num> threads
+ * for converting very large lists to native data and back (see
+ * tclmpi_conv_int and tclmpi_vec_string). The default is 1.
+ */
+int TclMPI_Init(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result, *argobj, **args;
+    int argc, narg, i, ierr, tlevel, required, progress, convthreads;
+    int tclmpi_init_done;
+    char **argv;
+
+    required    = MPI_THREAD_SINGLE;
+    progress    = 0;
+    convthreads = 1;
+    for (i = 1; i < objc; i += 2) {
+        const char *flag = Tcl_GetString(objv[i]);
+        if ((i + 1 < objc) && (strcmp(flag, "-thread") == 0)) {
+            const char *level = Tcl_GetString(objv[i + 1]);
+            int j;
+            for (j = 0; tclmpi_thread_names[j] != NULL; ++j) {
+                if (strcmp(level, tclmpi_thread_names[j]) == 0) break;
+            }
+            if (tclmpi_thread_names[j] == NULL) {
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown thread level: ", level, NULL);
+                return TCL_ERROR;
+            }
+            required = tclmpi_thread_levels[j];
+        } else if ((i + 1 < objc) && (strcmp(flag, "-convthreads") == 0)) {
+            if (Tcl_GetIntFromObj(interp, objv[i + 1], &convthreads) != TCL_OK) return TCL_ERROR;
+            if ((convthreads < 1) || (convthreads > TCLMPI_CONV_MAXTHREADS)) {
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid number of conversion threads: ",
+                                 Tcl_GetString(objv[i + 1]), NULL);
+                return TCL_ERROR;
+            }
+        } else if ((i + 1 < objc) && (strcmp(flag, "-progress") == 0)) {
+            if (Tcl_GetIntFromObj(interp, objv[i + 1], &progress) != TCL_OK) return TCL_ERROR;
+            if (progress < 1) {
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid progress interval: ",
+                                 Tcl_GetString(objv[i + 1]), NULL);
+                return TCL_ERROR;
+            }
+        } else {
+            Tcl_WrongNumArgs(interp, 1, objv, "?-thread <level>? ?-progress <usec>? ?-convthreads <num>?");
+            return TCL_ERROR;
+        }
+    }
+    if (progress > 0) required = MPI_THREAD_MULTIPLE;
+
+    /* convert "command line arguments" back to standard C stuff. */
+    argobj = Tcl_GetVar2Ex(interp, "argv", NULL, TCL_GLOBAL_ONLY);
+    Tcl_ListObjGetElements(interp, argobj, &narg, &args);
+
+    argv = (char **)Tcl_Alloc((narg + 2) * sizeof(char *));
+    for (argc = 1; argc <= narg; ++argc) {
+        Tcl_IncrRefCount(args[argc - 1]);
+        argv[argc] = Tcl_GetString(args[argc - 1]);
+    }
+    argv[argc] = NULL;
+
+    argobj = Tcl_GetVar2Ex(interp, "argv0", NULL, TCL_GLOBAL_ONLY);
+    Tcl_IncrRefCount(argobj);
+    argv[0] = Tcl_GetString(argobj);
+
+    MPI_Initialized(&tclmpi_init_done);
+    if (tclmpi_init_done != 0) {
+        Tcl_AppendResult(interp, "Calling ", Tcl_GetString(objv[0]), " multiple times is erroneous.", NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = MPI_Init_thread(&argc, &argv, required, &tlevel);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    tclmpi_conv_threads = convthreads;
+
+    /* change default error handler, so we can convert
+       MPI errors into 'catch'able Tcl errors */
+    MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
+
+    /* build new argv list */
+    result = Tcl_NewListObj(0, NULL);
+    for (i = 1; i < argc; ++i) { Tcl_ListObjAppendElement(interp, result, Tcl_NewStringObj(argv[i], -1)); }
+    for (i = 0; i < narg; ++i) Tcl_DecrRefCount(args[i]);
+    Tcl_DecrRefCount(argobj);
+
+    Tcl_SetVar2Ex(interp, "argv", NULL, result, TCL_GLOBAL_ONLY);
+    Tcl_SetVar2Ex(interp, "argc", NULL, Tcl_NewIntObj(argc - 1), TCL_GLOBAL_ONLY);
+
+    Tcl_Free((char *)argv);
+    Tcl_ResetResult(interp);
+
+    if (progress > 0) {
+        if (tlevel < MPI_THREAD_MULTIPLE) {
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": progress thread requires thread level multiple",
+                             NULL);
+            return TCL_ERROR;
+        }
+        if (tclmpi_progress_start(progress) != TCL_OK) {
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot start progress thread", NULL);
+            return TCL_ERROR;
+        }
+    }
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Query_thread()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function returns the level of thread support provided by the
+ * MPI library as one of single, funneled, serialized, or multiple.
+ */
+int TclMPI_Query_thread(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    int i, tlevel, tclmpi_init_done, tclmpi_final_done;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, NULL);
+        return TCL_ERROR;
+    }
+
+    MPI_Initialized(&tclmpi_init_done);
+    MPI_Finalized(&tclmpi_final_done);
+    if ((tclmpi_init_done == 0) || (tclmpi_final_done != 0)) {
+        Tcl_AppendResult(interp, "Calling ", Tcl_GetString(objv[0]), " outside of tclmpi::init and tclmpi::finalize"
+                         " is erroneous.", NULL);
+        return TCL_ERROR;
+    }
+
+    MPI_Query_thread(&tlevel);
+    for (i = 0; tclmpi_thread_names[i] != NULL; ++i) {
+        if (tlevel == tclmpi_thread_levels[i]) break;
+    }
+    if (tclmpi_thread_names[i] == NULL) i = 0;
+    Tcl_SetObjResult(interp, Tcl_NewStringObj(tclmpi_thread_names[i], -1));
+    return TCL_OK;
+}
+
+/*! Set error handler for data conversions in TclMPI
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function sets what action TclMPI should take if a conversion
+ * of a data element to the requested integer or double data type fails.
+ * There are currently three handlers implemented: \ref TCLMPI_ERROR,
+ * \ref TCLMPI_ABORT, and \ref TCLMPI_TOZERO.
+ *
+ * For \ref TCLMPI_ERROR a Tcl error is raised and TclMPI returns to the
+ * calling function. For \ref TCLMPI_ABORT an error message is written to the
+ * error output and parallel execution on the current communicator is
+ * terminated via MPI_Abort(). For \ref TCLMPI_TOZERO the error is silently
+ * ignored and the data element set to zero.
+ *
+ * The handler is kept separately for each interpreter.
+ *
+ * There is no equivalent MPI function for this, since there are
+ * no data conversions in C or C++.
+ */
+int TclMPI_Conv_set(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    const char *handler;
+    tclmpi_interp_t *state = tclmpi_interp_state(interp);
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<handler>");
+        return TCL_ERROR;
+    }
+
+    handler = Tcl_GetString(objv[1]);
+
+    if (strcmp(handler, "tclmpi::error") == 0)
+        state->conv_handler = TCLMPI_ERROR;
+    else if (strcmp(handler, "tclmpi::abort") == 0)
+        state->conv_handler = TCLMPI_ABORT;
+    else if (strcmp(handler, "tclmpi::tozero") == 0)
+        state->conv_handler = TCLMPI_TOZERO;
+    else {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown conversion error handler: ", handler, NULL);
+        return TCL_ERROR;
+    }
+
+    Tcl_ResetResult(interp);
+    return TCL_OK;
+}
+
+/*! Get error handler string for data conversions in TclMPI
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK
+ *
+ * This function returns which error handler is currently active
+ * for data conversions in TclMPI. For details see \ref TclMPI_Conv_set().
+ *
+ * There is no equivalent MPI function for this, since there are
+ * no data conversions in C or C++.
+ */
+int TclMPI_Conv_get(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_interp_t *state = tclmpi_interp_state(interp);
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 0, objv, NULL);
+        return TCL_ERROR;
+    }
+
+    if (state->conv_handler == TCLMPI_ABORT) {
+        Tcl_SetObjResult(interp, Tcl_NewStringObj("tclmpi::abort", -1));
+    } else if (state->conv_handler == TCLMPI_TOZERO) {
+        Tcl_SetObjResult(interp, Tcl_NewStringObj("tclmpi::tozero", -1));
+    } else {
+        Tcl_SetObjResult(interp, Tcl_NewStringObj("tclmpi::error", -1));
+    }
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Finalize()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function does a little more than just calling MPI_Finalize(). It
+ * also tries to detect whether MPI_Init() or MPI_Finialize() have been
+ * called before (from Tcl) and then creates a (catchable) Tcl error
+ * instead of an (uncatchable) MPI error.
+ */
+int TclMPI_Finalize(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    int tclmpi_init_done;
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, NULL);
+        return TCL_ERROR;
+    }
+
+    MPI_Finalized(&tclmpi_init_done);
+    if (tclmpi_init_done != 0) {
+        Tcl_AppendResult(interp, "Calling ", Tcl_GetString(objv[0]), " twice is erroneous.", NULL);
+        return TCL_ERROR;
+    }
+
+    MPI_Initialized(&tclmpi_init_done);
+    if (tclmpi_init_done == 0) {
+        Tcl_AppendResult(interp, "Calling ", Tcl_GetString(objv[0]), " before tclmpi::init is erroneous.", NULL);
+        return TCL_ERROR;
+    }
+
+    /* MPI cannot be polled for events or progressed after it is finalized */
+    tclmpi_event_stop();
+    tclmpi_progress_stop();
+    MPI_Finalize();
+    tclmpi_init_done = -1;
+
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Abort()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function translates the Tcl string representing a communicator
+ * into the corresponding MPI communicator and then calls MPI_Abort().
+ */
+int TclMPI_Abort(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    MPI_Comm comm;
+    int ierr;
+
+    if (objc != 3) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<comm> <errorcode>");
+        return TCL_ERROR;
+    }
+
+    comm = tcl2mpi_comm(objv[1]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[2], &ierr) != TCL_OK) { return TCL_ERROR; }
+
+    MPI_Abort(comm, ierr);
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Comm_size()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function translates the Tcl string representing a communicator
+ * into the corresponding MPI communicator and then calls MPI_Comm_size()
+ * on it, unless the size is already cached. The resulting number is passed
+ * to Tcl as result or the MPI error message is passed up similarly.
+ */
+int TclMPI_Comm_size(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result;
+    MPI_Comm comm;
+    int commsize, ierr;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<comm>");
+        return TCL_ERROR;
+    }
+
+    comm = tcl2mpi_comm(objv[1]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+
+    ierr = tclmpi_comm_info(objv[1], NULL, &commsize);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    result = Tcl_NewIntObj(commsize);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Comm_rank()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function translates the Tcl string representing a communicator
+ * into the corresponding MPI communicator and then calls MPI_Comm_rank()
+ * on it, unless the rank is already cached. The resulting number is passed
+ * to Tcl as result or the MPI error message is passed up similarly.
+ */
+int TclMPI_Comm_rank(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result;
+    MPI_Comm comm;
+    int commrank, ierr;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<comm>");
+        return TCL_ERROR;
+    }
+
+    comm = tcl2mpi_comm(objv[1]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+
+    ierr = tclmpi_comm_info(objv[1], &commrank, NULL);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    result = Tcl_NewIntObj(commrank);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Comm_split()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function translates the Tcl string representing a communicator
+ * into the corresponding MPI communicator also checks and converts the
+ * values for 'color' and 'key' and then calls MPI_Comm_split().
+ * The resulting communicator is added to the internal communicator map
+ * linked list and its string representation is passed to Tcl as result.
+ * If the MPI call failed, the MPI error message is passed up similarly.
+ */
+int TclMPI_Comm_split(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result;
+    MPI_Comm comm, newcomm;
+    int color, key, ierr;
+
+    if (objc != 4) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<comm> <color> <key>");
+        return TCL_ERROR;
+    }
+
+    comm = tcl2mpi_comm(objv[1]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+
+    if (strcmp(Tcl_GetString(objv[2]), "tclmpi::undefined") == 0)
+        color = MPI_UNDEFINED;
+    else {
+        if (Tcl_GetIntFromObj(interp, objv[2], &color) != TCL_OK) return TCL_ERROR;
+    }
+    if (Tcl_GetIntFromObj(interp, objv[3], &key) != TCL_OK) return TCL_ERROR;
+
+    /* several MPI applications do not catch this. so we got to do it */
+    if (color < 0 && color != MPI_UNDEFINED) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid color argument", NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = MPI_Comm_split(comm, color, key, &newcomm);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    /* change default error handler on new communicator, so that
+       we can convert MPI errors into 'catch'able Tcl errors */
+    MPI_Comm_set_errhandler(newcomm, MPI_ERRORS_RETURN);
+
+    result = Tcl_NewStringObj(tclmpi_add_comm(newcomm), -1);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Comm_free()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function deletes a defined MPI communicator and removes its Tcl
+ * representation from the local translation tables.
+ */
+int TclMPI_Comm_free(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    const char *label;
+    MPI_Comm comm;
+    int ierr;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<comm>");
+        return TCL_ERROR;
+    }
+
+    label = Tcl_GetString(objv[1]);
+    comm  = tcl2mpi_comm(objv[1]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+    if (tclmpi_del_comm(label) != TCL_OK) return TCL_ERROR;
+
+    ierr = MPI_Comm_free(&comm);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    Tcl_ResetResult(interp);
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Barrier()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function translates the Tcl string representing a communicator
+ * into the corresponding MPI communicator and then calls MPI_Barrier().
+ * If the MPI call failed, an MPI error message is passed up as result.
+ */
+int TclMPI_Barrier(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    MPI_Comm comm;
+    int ierr;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<comm>");
+        return TCL_ERROR;
+    }
+
+    comm = tcl2mpi_comm(objv[1]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+
+    ierr = MPI_Barrier(comm);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Bcast()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a broadcast function for TclMPI. Unlike in the
+ * C bindings, the length of the data is inferred from the data object
+ * passed to this function and thus a 'count' argument is not needed.
+ * Only a limited number of data types are currently supported, since
+ * Tcl has a limited number of "native" data types. The tclmpi::auto
+ * data type transfers the internal string representation of an object,
+ * while the other data types convert data to native data types as needed,
+ * with all non-representable data translated into either 0 or 0.0.
+ * The amount of data being sent is broadcast first, so that a suitable
+ * receive buffer can be set up. If the data fits into TCLMPI_EAGER_SIZE
+ * bytes, it is included in this first broadcast, so that only a single
+ * broadcast is needed. Otherwise a second broadcast transmits the data.
+ *
+ * For tclmpi::int and tclmpi::double the result of the broadcast is
+ * passed up as a "tclmpi::vector" object to the calling Tcl code, which
+ * is only converted to a list of Tcl objects when it is accessed as such.
+ * If the MPI call failed, an MPI error message is passed up as result instead.
+ */
+int TclMPI_Bcast(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL;
+    MPI_Comm comm;
+    int rank, root, type, len = 0, ierr = MPI_SUCCESS;
+
+    if (objc != 5) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    ierr = tclmpi_comm_info(objv[4], &rank, NULL);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES) || (type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        MPI_Datatype mtype = tclmpi_mpitype(type);
+        struct {
+            int len;
+            int type;
+            char data[TCLMPI_EAGER_SIZE];
+        } msg;
+        void *idata;
+        int esize;
+
+        MPI_Type_size(mtype, &esize);
+        if (rank == root) {
+            if (type == TCLMPI_AUTO) {
+                idata  = Tcl_GetStringFromObj(objv[1], &len);
+                result = objv[1];
+            } else if (type == TCLMPI_BYTES) {
+                idata  = Tcl_GetByteArrayFromObj(objv[1], &len);
+                result = objv[1];
+            } else {
+                result = tclmpi_get_vector(interp, comm, objv[1], type);
+                if (result == NULL) return TCL_ERROR;
+                len   = TCLMPI_VEC(result)->len;
+                idata = TCLMPI_VEC(result)->data;
+            }
+
+            msg.len  = len;
+            msg.type = type;
+            if ((size_t)len * esize <= TCLMPI_EAGER_SIZE) {
+                memcpy(msg.data, idata, (size_t)len * esize);
+                ierr = MPI_Bcast(&msg, sizeof(msg), MPI_BYTE, root, comm);
+            } else {
+                ierr = MPI_Bcast(&msg, sizeof(msg), MPI_BYTE, root, comm);
+                if (ierr == MPI_SUCCESS) ierr = MPI_Bcast(idata, len, mtype, root, comm);
+            }
+        } else {
+            ierr = MPI_Bcast(&msg, sizeof(msg), MPI_BYTE, root, comm);
+            if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+            len = msg.len;
+
+            /* mismatched data types are reported like MPI would. the data
+               must still be received, if it was not sent eagerly. */
+            if (msg.type != type) {
+                MPI_Datatype rtype = tclmpi_mpitype(msg.type);
+                int rsize;
+
+                MPI_Type_size(rtype, &rsize);
+                if ((size_t)len * rsize > TCLMPI_EAGER_SIZE) {
+                    idata = tclmpi_scratch(interp, (size_t)len * rsize);
+                    MPI_Bcast(idata, len, rtype, root, comm);
+                }
+                tclmpi_errcheck(interp, MPI_ERR_TRUNCATE, objv[0]);
+                return TCL_ERROR;
+            }
+
+            result = tclmpi_recv_obj(type, len, &idata);
+            if ((size_t)len * esize <= TCLMPI_EAGER_SIZE)
+                memcpy(idata, msg.data, (size_t)len * esize);
+            else
+                ierr = MPI_Bcast(idata, len, mtype, root, comm);
+        }
+    } else {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if (result) Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Scatter()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a scatter operation that distributes
+ * data for TclMPI.
+ * This operation does not accept the tclmpi::auto data type, also support
+ * for types outside of tclmpi::int and tclmpi::double is incomplete.
+ * The length of the data is inferred from the data object passed to this
+ * function and thus a 'count' argument is not needed. The number of data
+ * items has to be divisible by the number of processes on the communicator.
+ * The data argument is only used on the root process. The root process
+ * sends the number of data items per process together with the data in
+ * a single scatter, if it fits into TCLMPI_EAGER_SLOT bytes per process.
+ * Otherwise a second scatter transmits the data.
+ *
+ * The result is passed up as a "tclmpi::vector" object to the calling
+ * Tcl code. If the MPI call failed an MPI error message is passed up as
+ * result instead.
+ */
+int TclMPI_Scatter(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL;
+    MPI_Comm comm;
+    int i, type, root, size, rank, ilen, olen, ierr = MPI_SUCCESS;
+
+    if (objc != 5) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    /* special case check for reduction */
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+        return TCL_ERROR;
+    }
+    ierr = tclmpi_comm_info(objv[4], &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        MPI_Datatype mtype = tclmpi_mpitype(type);
+        tclmpi_eager_t msg, *slots = NULL;
+        Tcl_Obj *vec = NULL;
+        void *idata = NULL, *odata;
+        int esize;
+
+        MPI_Type_size(mtype, &esize);
+        if (rank == root) {
+            vec = tclmpi_get_vector(interp, comm, objv[1], type);
+            if (vec == NULL) return TCL_ERROR;
+            Tcl_IncrRefCount(vec);
+            ilen  = TCLMPI_VEC(vec)->len;
+            idata = TCLMPI_VEC(vec)->data;
+
+            /* a negative length signals that the data cannot be divided */
+            olen = ilen / size;
+            if (olen * size != ilen) olen = -1;
+            slots = (tclmpi_eager_t *)tclmpi_scratch(interp, (size_t)size * sizeof(tclmpi_eager_t));
+            for (i = 0; i < size; ++i) {
+                slots[i].len  = olen;
+                slots[i].type = type;
+                if ((olen > 0) && ((size_t)olen * esize <= TCLMPI_EAGER_SLOT))
+                    memcpy(slots[i].data, (char *)idata + (size_t)i * olen * esize, (size_t)olen * esize);
+            }
+        }
+        ierr = MPI_Scatter(slots, sizeof(tclmpi_eager_t), MPI_BYTE, &msg, sizeof(tclmpi_eager_t), MPI_BYTE, root,
+                           comm);
+        if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+            if (vec) Tcl_DecrRefCount(vec);
+            return TCL_ERROR;
+        }
+
+        olen = msg.len;
+
+        /* mismatched data types are reported like MPI would. the data
+           must still be received, if it was not sent eagerly. */
+        if (msg.type != type) {
+            MPI_Datatype rtype = tclmpi_mpitype(msg.type);
+            int rsize;
+
+            MPI_Type_size(rtype, &rsize);
+            if ((size_t)olen * rsize > TCLMPI_EAGER_SLOT) {
+                odata = tclmpi_scratch(interp, (size_t)olen * rsize);
+                MPI_Scatter(idata, olen, rtype, odata, olen, rtype, root, comm);
+            }
+            tclmpi_errcheck(interp, MPI_ERR_TRUNCATE, objv[0]);
+            if (vec) Tcl_DecrRefCount(vec);
+            return TCL_ERROR;
+        }
+
+        if (olen < 0) {
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
+                             ": number of data items must be divisible"
+                             " by the number of processes",
+                             NULL);
+            if (vec) Tcl_DecrRefCount(vec);
+            return TCL_ERROR;
+        }
+
+        result = tclmpi_new_vector(type, olen, &odata);
+        if ((size_t)olen * esize <= TCLMPI_EAGER_SLOT)
+            memcpy(odata, msg.data, (size_t)olen * esize);
+        else
+            ierr = MPI_Scatter(idata, olen, mtype, odata, olen, mtype, root, comm);
+        if (vec) Tcl_DecrRefCount(vec);
+
+    } else {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if (result) Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Allgather()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a gather operation that collects data for TclMPI.
+ * This operation does not accept the tclmpi::auto data type, also support
+ * for types outside of tclmpi::int and tclmpi::double is incomplete.
+ * The length of the data is inferred from the data object passed to this
+ * function and thus a 'count' argument is not needed. The number of data
+ * items has to be the same on all processes on the communicator.
+ * The number of data items on each process is gathered together with the
+ * data in a single allgather, if it fits into TCLMPI_EAGER_SLOT bytes.
+ * Otherwise a second allgather transmits the data.
+ *
+ * The result is passed up as a "tclmpi::vector" object to the calling
+ * Tcl code on all processors. If the MPI call failed, an MPI error message
+ * is passed up as result instead.
+ */
+int TclMPI_Allgather(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL;
+    MPI_Comm comm;
+    int i, type, size, rank, ilen, olen, ierr = MPI_SUCCESS;
+
+    if (objc != 4) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[3]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[3]) != TCL_OK) return TCL_ERROR;
+
+    /* special case check for reduction */
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[3], &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        MPI_Datatype mtype = tclmpi_mpitype(type);
+        tclmpi_eager_t msg, *slots;
+        Tcl_Obj *vec;
+        void *odata;
+        int esize;
+
+        MPI_Type_size(mtype, &esize);
+        vec = tclmpi_get_vector(interp, comm, objv[1], type);
+        if (vec == NULL) return TCL_ERROR;
+        Tcl_IncrRefCount(vec);
+        ilen = TCLMPI_VEC(vec)->len;
+
+        msg.len  = ilen;
+        msg.type = type;
+        if ((size_t)ilen * esize <= TCLMPI_EAGER_SLOT) memcpy(msg.data, TCLMPI_VEC(vec)->data, (size_t)ilen * esize);
+        slots = (tclmpi_eager_t *)tclmpi_scratch(interp, (size_t)size * sizeof(tclmpi_eager_t));
+        ierr  = MPI_Allgather(&msg, sizeof(tclmpi_eager_t), MPI_BYTE, slots, sizeof(tclmpi_eager_t), MPI_BYTE, comm);
+        if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+            Tcl_DecrRefCount(vec);
+            return TCL_ERROR;
+        }
+
+        /* mismatched data types are reported like MPI would */
+        for (i = 0; i < size; ++i) {
+            if (slots[i].type != type) {
+                tclmpi_errcheck(interp, MPI_ERR_TRUNCATE, objv[0]);
+                Tcl_DecrRefCount(vec);
+                return TCL_ERROR;
+            }
+        }
+
+        olen = slots[0].len;
+        for (i = 1; i < size; ++i) {
+            if (slots[i].len != olen) {
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
+                                 ": number of data items must be the same on all processes", NULL);
+                Tcl_DecrRefCount(vec);
+                return TCL_ERROR;
+            }
+        }
+
+        result = tclmpi_new_vector(type, olen * size, &odata);
+        if ((size_t)olen * esize <= TCLMPI_EAGER_SLOT) {
+            for (i = 0; i < size; ++i)
+                memcpy((char *)odata + (size_t)i * olen * esize, slots[i].data, (size_t)olen * esize);
+        } else
+            ierr = MPI_Allgather(TCLMPI_VEC(vec)->data, ilen, mtype, odata, olen, mtype, comm);
+        Tcl_DecrRefCount(vec);
+
+    } else {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if (result) Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Gather()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a gather operation that collects data for TclMPI.
+ * This operation does not accept the tclmpi::auto data type, also support
+ * for types outside of tclmpi::int and tclmpi::double is incomplete.
+ * The length of the data is inferred from the data object passed to this
+ * function and thus a 'count' argument is not needed. The number of data
+ * items has to be the same on all processes on the communicator.
+ *
+ * The number of data items is checked with a single MAX reduction of
+ * the number and its negative on all processes, before the data is
+ * gathered.
+ *
+ * The result is passed up as a "tclmpi::vector" object to the calling
+ * Tcl code on the root processor, all other processors return an empty
+ * list. If the MPI call failed, an MPI error message is passed up as
+ * result instead.
+ */
+int TclMPI_Gather(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL;
+    MPI_Comm comm;
+    int type, root, size, rank, ilen, olen, ierr = MPI_SUCCESS;
+
+    if (objc != 5) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    /* special case check for reduction */
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[4], &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        MPI_Datatype mtype = tclmpi_mpitype(type);
+        Tcl_Obj *vec;
+        void *odata = NULL;
+        int ilens[2], olens[2];
+
+        vec = tclmpi_get_vector(interp, comm, objv[1], type);
+        if (vec == NULL) return TCL_ERROR;
+        Tcl_IncrRefCount(vec);
+        ilen = TCLMPI_VEC(vec)->len;
+
+        /* get maximum and minimum length with one reduction */
+        ilens[0] = ilen;
+        ilens[1] = -ilen;
+        MPI_Allreduce(ilens, olens, 2, MPI_INT, MPI_MAX, comm);
+        olen = olens[0];
+        if (olen != -olens[1]) {
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": number of data items must be the same on all processes",
+                             NULL);
+            Tcl_DecrRefCount(vec);
+            return TCL_ERROR;
+        }
+
+        if (rank == root)
+            result = tclmpi_new_vector(type, olen * size, &odata);
+        else
+            result = Tcl_NewListObj(0, NULL);
+        ierr = MPI_Gather(TCLMPI_VEC(vec)->data, ilen, mtype, odata, olen, mtype, root, comm);
+        Tcl_DecrRefCount(vec);
+
+    } else {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if (result) Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Gatherv()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a gather operation that collects data of
+ * different length from all processes for TclMPI. The length of the
+ * data is inferred from the data object passed to this function and
+ * exchanged with MPI_Allgather() first, so that the data can then be
+ * transferred with a single MPI_Gatherv(). A negative length flags a
+ * data conversion error, so that all processes return an error, if one
+ * of them fails. Supported data types are tclmpi::auto, tclmpi::bytes,
+ * tclmpi::int and tclmpi::double.
+ *
+ * The result is passed up as a list with one element per process to
+ * the calling Tcl code on the root processor, all other processors return
+ * an empty list. The list elements have the same representation as the
+ * result of a receive of the same data type. If the MPI call failed, an
+ * MPI error message is passed up as result instead.
+ */
+int TclMPI_Gatherv(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL, *sobj;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    void *sdata = NULL;
+    char *rdata = NULL;
+    int *counts, *displs;
+    int i, type, root, size, rank, len, total, esize, fail, ierr = MPI_SUCCESS;
+
+    if (objc != 5) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    if ((type != TCLMPI_AUTO) && (type != TCLMPI_BYTES) && (type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[4], &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    mtype = tclmpi_mpitype(type);
+    MPI_Type_size(mtype, &esize);
+
+    /* a negative length signals that the data could not be converted, so that all processes fail together */
+    sobj = tclmpi_send_obj(interp, comm, objv[1], type, &len, &sdata);
+    if (sobj == NULL)
+        len = -1;
+    else
+        Tcl_IncrRefCount(sobj);
+
+    counts = (int *)Tcl_Alloc(2 * size * sizeof(int));
+    displs = counts + size;
+    ierr   = MPI_Allgather(&len, 1, MPI_INT, counts, 1, MPI_INT, comm);
+    if (ierr == MPI_SUCCESS) {
+        fail  = 0;
+        total = 0;
+        for (i = 0; i < size; ++i) {
+            if (counts[i] < 0) fail = 1;
+            displs[i] = total;
+            total += counts[i];
+        }
+        if (fail) {
+            Tcl_Free((char *)counts);
+            if (sobj == NULL) return TCL_ERROR;
+            Tcl_DecrRefCount(sobj);
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": data conversion failed on another process", NULL);
+            return TCL_ERROR;
+        }
+        if (rank == root) rdata = (char *)tclmpi_scratch(interp, (size_t)total * esize);
+        ierr = MPI_Gatherv(sdata, len, mtype, rdata, counts, displs, mtype, root, comm);
+    }
+    if (sobj) Tcl_DecrRefCount(sobj);
+
+    if (ierr == MPI_SUCCESS) {
+        if (rank == root)
+            result = tclmpi_split_obj(type, size, counts, displs, rdata);
+        else
+            result = Tcl_NewListObj(0, NULL);
+    }
+    Tcl_Free((char *)counts);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Allgatherv()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a gather operation that collects data of
+ * different length from all processes for TclMPI and distributes it
+ * to all processes. The length of the data is inferred from the data
+ * object passed to this function and exchanged with MPI_Allgather() first,
+ * so that the data can then be transferred with a single MPI_Allgatherv().
+ * A negative length flags a data conversion error, so that all processes
+ * return an error, if one of them fails. Supported data types are
+ * tclmpi::auto, tclmpi::bytes, tclmpi::int and tclmpi::double.
+ *
+ * The result is passed up as a list with one element per process to
+ * the calling Tcl code on all processors. The list elements have the same
+ * representation as the result of a receive of the same data type. If
+ * the MPI call failed, an MPI error message is passed up as result instead.
+ */
+int TclMPI_Allgatherv(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL, *sobj;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    void *sdata = NULL;
+    char *rdata = NULL;
+    int *counts, *displs;
+    int i, type, size, rank, len, total, esize, fail, ierr = MPI_SUCCESS;
+
+    if (objc != 4) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[3]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[3]) != TCL_OK) return TCL_ERROR;
+
+    if ((type != TCLMPI_AUTO) && (type != TCLMPI_BYTES) && (type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[3], &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    mtype = tclmpi_mpitype(type);
+    MPI_Type_size(mtype, &esize);
+
+    /* a negative length signals that the data could not be converted, so that all processes fail together */
+    sobj = tclmpi_send_obj(interp, comm, objv[1], type, &len, &sdata);
+    if (sobj == NULL)
+        len = -1;
+    else
+        Tcl_IncrRefCount(sobj);
+
+    counts = (int *)Tcl_Alloc(2 * size * sizeof(int));
+    displs = counts + size;
+    ierr   = MPI_Allgather(&len, 1, MPI_INT, counts, 1, MPI_INT, comm);
+    if (ierr == MPI_SUCCESS) {
+        fail  = 0;
+        total = 0;
+        for (i = 0; i < size; ++i) {
+            if (counts[i] < 0) fail = 1;
+            displs[i] = total;
+            total += counts[i];
+        }
+        if (fail) {
+            Tcl_Free((char *)counts);
+            if (sobj == NULL) return TCL_ERROR;
+            Tcl_DecrRefCount(sobj);
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": data conversion failed on another process", NULL);
+            return TCL_ERROR;
+        }
+        rdata = (char *)tclmpi_scratch(interp, (size_t)total * esize);
+        ierr  = MPI_Allgatherv(sdata, len, mtype, rdata, counts, displs, mtype, comm);
+    }
+    if (sobj) Tcl_DecrRefCount(sobj);
+
+    if (ierr == MPI_SUCCESS) result = tclmpi_split_obj(type, size, counts, displs, rdata);
+    Tcl_Free((char *)counts);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Scatterv()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a scatter operation that distributes data
+ * of different length to all processes for TclMPI. The data argument is
+ * only used on the root process and must be a list with one element per
+ * process, which is the data sent to that process. The length of each
+ * element is distributed with MPI_Scatter() first, so that the data can
+ * then be transferred with a single MPI_Scatterv(). Negative lengths flag
+ * errors in the list or its data conversion on the root process, so that
+ * all processes return an error together. Supported data types are
+ * tclmpi::auto, tclmpi::bytes, tclmpi::int and tclmpi::double.
+ *
+ * The result is passed up to the calling Tcl code with the same
+ * representation as the result of a receive of the same data type.
+ * If the MPI call failed, an MPI error message is passed up as result
+ * instead.
+ */
+int TclMPI_Scatterv(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL, **elems;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    void *rdata;
+    char *sdata = NULL;
+    int *counts = NULL, *displs = NULL;
+    int i, num, type, root, size, rank, len, ierr = MPI_SUCCESS;
+
+    if (objc != 5) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    if ((type != TCLMPI_AUTO) && (type != TCLMPI_BYTES) && (type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[4], &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    mtype = tclmpi_mpitype(type);
+
+    if (rank == root) {
+        if (Tcl_ListObjGetElements(interp, objv[1], &num, &elems) != TCL_OK) return TCL_ERROR;
+        counts = (int *)Tcl_Alloc(2 * size * sizeof(int));
+        displs = counts + size;
+
+        /* a negative length signals that the list does not match the communicator
+           (-1) or that its data could not be converted (-2), so that all processes
+           fail together */
+        if (num != size) {
+            for (i = 0; i < size; ++i) counts[i] = -1;
+        } else {
+            sdata = tclmpi_pack_list(interp, comm, size, elems, type, counts, displs);
+            if (sdata == NULL) {
+                for (i = 0; i < size; ++i) counts[i] = -2;
+            }
+        }
+    }
+
+    ierr = MPI_Scatter(counts, 1, MPI_INT, &len, 1, MPI_INT, root, comm);
+    if (ierr == MPI_SUCCESS) {
+        if (len < 0) {
+            if (counts) Tcl_Free((char *)counts);
+            if (len == -1)
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
+                                 ": number of list elements must be the same as the number of processes", NULL);
+            else if (rank != root)
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": data conversion failed on the root process",
+                                 NULL);
+            return TCL_ERROR;
+        }
+        result = tclmpi_recv_obj(type, len, &rdata);
+        Tcl_IncrRefCount(result);
+        ierr = MPI_Scatterv(sdata, counts, displs, mtype, rdata, len, mtype, root, comm);
+    }
+    if (sdata) Tcl_Free(sdata);
+    if (counts) Tcl_Free((char *)counts);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        if (result) Tcl_DecrRefCount(result);
+        return TCL_ERROR;
+    }
+
+    Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    Tcl_DecrRefCount(result);
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Alltoall()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements an all-to-all operation that exchanges data
+ * between all processes for TclMPI. The data argument must be a list with
+ * one element per process, which is the data sent to that process. The
+ * number of data items has to be the same for all list elements on all
+ * processes. Supported data types are tclmpi::auto, tclmpi::bytes,
+ * tclmpi::int and tclmpi::double.
+ *
+ * The number of list elements and data items are checked with a single
+ * MAX reduction on all processes, before the data is exchanged with
+ * MPI_Alltoall(). The same reduction carries a flag for data conversion
+ * errors, so that all processes return an error, if one of them fails.
+ *
+ * The result is passed up as a list with one element per process to
+ * the calling Tcl code, which is the data received from that process.
+ * The list elements have the same representation as the result of a
+ * receive of the same data type. If the MPI call failed, an MPI error
+ * message is passed up as result instead.
+ */
+int TclMPI_Alltoall(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL, **elems;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    char *sdata, *rdata;
+    int *counts, *displs;
+    int i, num, type, size, rank, len, esize, ilens[3], olens[3], ierr = MPI_SUCCESS;
+
+    if (objc != 4) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[3]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[3]) != TCL_OK) return TCL_ERROR;
+
+    if ((type != TCLMPI_AUTO) && (type != TCLMPI_BYTES) && (type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[3], &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    if (Tcl_ListObjGetElements(interp, objv[1], &num, &elems) != TCL_OK) return TCL_ERROR;
+    mtype = tclmpi_mpitype(type);
+    MPI_Type_size(mtype, &esize);
+
+    counts = (int *)Tcl_Alloc(2 * size * sizeof(int));
+    displs = counts + size;
+    ilens[0] = ilens[1] = 0;
+    ilens[2] = (num != size);
+    sdata = NULL;
+    if (num == size) {
+        /* a failed conversion is flagged, so that all processes fail together */
+        sdata = tclmpi_pack_list(interp, comm, size, elems, type, counts, displs);
+        if (sdata == NULL) {
+            ilens[2] = 2;
+        } else {
+            ilens[0] = ilens[1] = counts[0];
+            for (i = 1; i < size; ++i) {
+                if (counts[i] > ilens[0]) ilens[0] = counts[i];
+                if (counts[i] < ilens[1]) ilens[1] = counts[i];
+            }
+            ilens[1] = -ilens[1];
+        }
+    }
+
+    /* get error flag and maximum and minimum length with one reduction */
+    ierr = MPI_Allreduce(ilens, olens, 3, MPI_INT, MPI_MAX, comm);
+    if ((ierr != MPI_SUCCESS) || olens[2] || (olens[0] != -olens[1])) {
+        if (ierr != MPI_SUCCESS)
+            tclmpi_errcheck(interp, ierr, objv[0]);
+        else if (ilens[2] == 2)
+            ; /* keep the conversion error message */
+        else if ((ilens[2] == 1) || (olens[2] == 1))
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
+                             ": number of list elements must be the same as the number of processes", NULL);
+        else if (olens[2] == 2)
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": data conversion failed on another process", NULL);
+        else
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
+                             ": number of data items must be the same for all list elements on all processes", NULL);
+        if (sdata) Tcl_Free(sdata);
+        Tcl_Free((char *)counts);
+        return TCL_ERROR;
+    }
+
+    len = olens[0];
+    for (i = 0; i < size; ++i) {
+        counts[i] = len;
+        displs[i] = i * len;
+    }
+    rdata = (char *)tclmpi_scratch(interp, (size_t)size * len * esize);
+    ierr  = MPI_Alltoall(sdata, len, mtype, rdata, len, mtype, comm);
+    if (ierr == MPI_SUCCESS) result = tclmpi_split_obj(type, size, counts, displs, rdata);
+    Tcl_Free(sdata);
+    Tcl_Free((char *)counts);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Alltoallv()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements an all-to-all operation that exchanges data
+ * of different length between all processes for TclMPI. The data argument
+ * must be a list with one element per process, which is the data sent to
+ * that process. The length of each element is exchanged with MPI_Alltoall()
+ * first, so that the data can then be transferred with a single
+ * MPI_Alltoallv(). Negative lengths flag errors in the list or its data
+ * conversion, so that all processes return an error, if one of them fails.
+ * Supported data types are tclmpi::auto, tclmpi::bytes, tclmpi::int and
+ * tclmpi::double.
+ *
+ * The result is passed up as a list with one element per process to
+ * the calling Tcl code, which is the data received from that process.
+ * The list elements have the same representation as the result of a
+ * receive of the same data type. If the MPI call failed, an MPI error
+ * message is passed up as result instead.
+ */
+int TclMPI_Alltoallv(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL, **elems;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    char *sdata = NULL, *rdata = NULL;
+    int *scounts, *sdispls, *rcounts, *rdispls;
+    int i, num, type, size, rank, total, esize, fail, ierr = MPI_SUCCESS;
+
+    if (objc != 4) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[3]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[3]) != TCL_OK) return TCL_ERROR;
+
+    if ((type != TCLMPI_AUTO) && (type != TCLMPI_BYTES) && (type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[3], &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    if (Tcl_ListObjGetElements(interp, objv[1], &num, &elems) != TCL_OK) return TCL_ERROR;
+    mtype = tclmpi_mpitype(type);
+    MPI_Type_size(mtype, &esize);
+
+    scounts = (int *)Tcl_Alloc(4 * size * sizeof(int));
+    sdispls = scounts + size;
+    rcounts = sdispls + size;
+    rdispls = rcounts + size;
+
+    /* a negative length signals that the list does not match the communicator
+       (-1) or that its data could not be converted (-2), so that all processes
+       fail together */
+    fail = 0;
+    if (num != size) {
+        fail = 1;
+        for (i = 0; i < size; ++i) scounts[i] = -1;
+    } else {
+        sdata = tclmpi_pack_list(interp, comm, size, elems, type, scounts, sdispls);
+        if (sdata == NULL) {
+            fail = 2;
+            for (i = 0; i < size; ++i) scounts[i] = -2;
+        }
+    }
+
+    ierr = MPI_Alltoall(scounts, 1, MPI_INT, rcounts, 1, MPI_INT, comm);
+    if (ierr == MPI_SUCCESS) {
+        total = 0;
+        for (i = 0; i < size; ++i) {
+            if ((rcounts[i] == -1) && (fail != 2)) fail = 1;
+            if ((rcounts[i] == -2) && (fail == 0)) fail = 3;
+            rdispls[i] = total;
+            total += rcounts[i];
+        }
+        if (fail) {
+            if (sdata) Tcl_Free(sdata);
+            Tcl_Free((char *)scounts);
+            if (fail == 1)
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
+                                 ": number of list elements must be the same as the number of processes", NULL);
+            else if (fail == 3)
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": data conversion failed on another process",
+                                 NULL);
+            return TCL_ERROR;
+        }
+        rdata = (char *)tclmpi_scratch(interp, (size_t)total * esize);
+        ierr  = MPI_Alltoallv(sdata, scounts, sdispls, mtype, rdata, rcounts, rdispls, mtype, comm);
+    }
+
+    if (ierr == MPI_SUCCESS) result = tclmpi_split_obj(type, size, rcounts, rdispls, rdata);
+    if (sdata) Tcl_Free(sdata);
+    Tcl_Free((char *)scounts);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Allreduce()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a reduction plus broadcast function for TclMPI.
+ * This operation does not accept the tclmpi::auto data type, also support
+ * for types outside of tclmpi::int and tclmpi::double is incomplete.
+ * The length of the data is inferred from the data object passed to this
+ * function and thus a 'count' argument is not needed.
+ *
+ * The result is passed up as a "tclmpi::vector" object for tclmpi::int
+ * and tclmpi::double data or as a list of pairs for the pair types to the
+ * calling Tcl code. If the MPI call failed, an MPI error message is passed
+ * up as result instead.
+ */
+int TclMPI_Allreduce(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL;
+    const char *opstr;
+    MPI_Comm comm;
+    MPI_Op op;
+    int i, type, len, ierr = MPI_SUCCESS;
+
+    if (objc != 5) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <op> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    opstr = Tcl_GetString(objv[3]);
+    comm  = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    /* special case check for reduction */
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+        return TCL_ERROR;
+    }
+
+    if (tclmpi_get_op(objv[3], &op) != TCL_OK) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown reduction operator: ", opstr, NULL);
+        return TCL_ERROR;
+    }
+
+    Tcl_IncrRefCount(objv[1]);
+
+    if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        MPI_Datatype mtype = tclmpi_mpitype(type);
+        void *idata, *odata;
+
+        idata = tclmpi_get_data(interp, comm, objv[1], type, &len);
+        if (idata == NULL) {
+            Tcl_DecrRefCount(objv[1]);
+            return TCL_ERROR;
+        }
+
+        result = tclmpi_new_vector(type, len, &odata);
+        ierr   = MPI_Allreduce(idata, odata, len, mtype, op, comm);
+    } else if (type == TCLMPI_INT_INT) {
+        Tcl_Obj **ilist, **ipair;
+        tclmpi_intint_t *idata, *odata;
+        int plen;
+        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
+        idata = (tclmpi_intint_t *)tclmpi_scratch(interp, (size_t)2 * len * sizeof(tclmpi_intint_t));
+        odata = idata + len;
+        for (i = 0; i < len; ++i) {
+            if (Tcl_ListObjGetElements(interp, ilist[i], &plen, &ipair) != TCL_OK) return TCL_ERROR;
+            if (plen < 2) {
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad list format for loc reduction: ", opstr, NULL);
+                return TCL_ERROR;
+            }
+
+            TCLMPI_CONV_CHECK(Int, ipair[0], &(idata[i].i1), idata[i].i1);
+            if (Tcl_GetIntFromObj(interp, ipair[1], &(idata[i].i2)) != TCL_OK) {
+                Tcl_ResetResult(interp);
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad location data for reduction: ", opstr, NULL);
+                return TCL_ERROR;
+            }
+        }
+        ierr   = MPI_Allreduce(idata, odata, len, MPI_2INT, op, comm);
+        result = Tcl_NewListObj(0, NULL);
+        for (i = 0; i < len; ++i) {
+            Tcl_Obj *opair;
+            opair = Tcl_NewListObj(0, NULL);
+            Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i1));
+            Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i2));
+            Tcl_ListObjAppendElement(interp, result, opair);
+        }
+    } else if (type == TCLMPI_DOUBLE_INT) {
+        Tcl_Obj **ilist, **ipair;
+        tclmpi_dblint_t *idata, *odata;
+        int plen;
+        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
+        idata = (tclmpi_dblint_t *)tclmpi_scratch(interp, (size_t)2 * len * sizeof(tclmpi_dblint_t));
+        odata = idata + len;
+        for (i = 0; i < len; ++i) {
+            if (Tcl_ListObjGetElements(interp, ilist[i], &plen, &ipair) != TCL_OK) return TCL_ERROR;
+            if (plen < 2) {
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad list format for loc reduction: ", opstr, NULL);
+                return TCL_ERROR;
+            }
+
+            TCLMPI_CONV_CHECK(Double, ipair[0], &(idata[i].d), idata[i].d);
+            if (Tcl_GetIntFromObj(interp, ipair[1], &(idata[i].i)) != TCL_OK) {
+                Tcl_ResetResult(interp);
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad location data for reduction: ", opstr, NULL);
+                return TCL_ERROR;
+            }
+        }
+        ierr   = MPI_Allreduce(idata, odata, len, MPI_DOUBLE_INT, op, comm);
+        result = Tcl_NewListObj(0, NULL);
+        for (i = 0; i < len; ++i) {
+            Tcl_Obj *opair;
+            opair = Tcl_NewListObj(0, NULL);
+            Tcl_ListObjAppendElement(interp, opair, Tcl_NewDoubleObj(odata[i].d));
+            Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i));
+            Tcl_ListObjAppendElement(interp, result, opair);
+        }
+    } else {
+        Tcl_DecrRefCount(objv[1]);
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+    Tcl_DecrRefCount(objv[1]);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if (result) Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Reduce()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a reduction function for TclMPI.
+ * This operation does not accept the tclmpi::auto data type, also support
+ * for types outside of tclmpi::int and tclmpi::double is incomplete.
+ * The length of the data is inferred from the data object passed to this
+ * function and thus a 'count' argument is not needed.
+ *
+ * The result is collected on the process with rank root and passed up
+ * as result value to the calling Tcl code, as a "tclmpi::vector" object
+ * for tclmpi::int and tclmpi::double data. If the MPI call failed an MPI
+ * error message is passed up as result instead.
+ */
+int TclMPI_Reduce(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result = NULL;
+    const char *opstr;
+    MPI_Comm comm;
+    MPI_Op op;
+    int i, type, root, rank, len, ierr = MPI_SUCCESS;
+
+    if (objc != 6) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <op> <root> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    opstr = Tcl_GetString(objv[3]);
+
+    if (Tcl_GetIntFromObj(interp, objv[4], &root) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[5]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[5]) != TCL_OK) return TCL_ERROR;
+
+    /* special case check for reduction */
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+        return TCL_ERROR;
+    }
+
+    if (tclmpi_get_op(objv[3], &op) != TCL_OK) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown reduction operator: ", opstr, NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[5], &rank, NULL);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    Tcl_IncrRefCount(objv[1]);
+
+    if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        MPI_Datatype mtype = tclmpi_mpitype(type);
+        void *idata, *odata = NULL;
+
+        idata = tclmpi_get_data(interp, comm, objv[1], type, &len);
+        if (idata == NULL) {
+            Tcl_DecrRefCount(objv[1]);
+            return TCL_ERROR;
+        }
+
+        if (rank == root)
+            result = tclmpi_new_vector(type, len, &odata);
+        else
+            result = Tcl_NewListObj(0, NULL);
+        ierr = MPI_Reduce(idata, odata, len, mtype, op, root, comm);
+
+    } else if (type == TCLMPI_INT_INT) {
+        Tcl_Obj **ilist, **ipair;
+        tclmpi_intint_t *idata, *odata;
+        int plen;
+        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
+        idata = (tclmpi_intint_t *)tclmpi_scratch(interp, (size_t)2 * len * sizeof(tclmpi_intint_t));
+        odata = (rank == root) ? idata + len : NULL;
+        for (i = 0; i < len; ++i) {
+            if (Tcl_ListObjGetElements(interp, ilist[i], &plen, &ipair) != TCL_OK) return TCL_ERROR;
+            if (plen < 2) {
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad list format for loc reduction: ", opstr, NULL);
+                return TCL_ERROR;
+            }
+
+            TCLMPI_CONV_CHECK(Int, ipair[0], &(idata[i].i1), idata[i].i1);
+            if (Tcl_GetIntFromObj(interp, ipair[1], &(idata[i].i2)) != TCL_OK) {
+                Tcl_ResetResult(interp);
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad location data for reduction: ", opstr, NULL);
+                return TCL_ERROR;
+            }
+        }
+        ierr   = MPI_Reduce(idata, odata, len, MPI_2INT, op, root, comm);
+        result = Tcl_NewListObj(0, NULL);
+        if (rank == root) {
+            for (i = 0; i < len; ++i) {
+                Tcl_Obj *opair;
+                opair = Tcl_NewListObj(0, NULL);
+                Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i1));
+                Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i2));
+                Tcl_ListObjAppendElement(interp, result, opair);
+            }
+        }
+
+    } else if (type == TCLMPI_DOUBLE_INT) {
+        Tcl_Obj **ilist, **ipair;
+        tclmpi_dblint_t *idata, *odata;
+        int plen;
+        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
+        idata = (tclmpi_dblint_t *)tclmpi_scratch(interp, (size_t)2 * len * sizeof(tclmpi_dblint_t));
+        odata = (rank == root) ? idata + len : NULL;
+        for (i = 0; i < len; ++i) {
+            if (Tcl_ListObjGetElements(interp, ilist[i], &plen, &ipair) != TCL_OK) return TCL_ERROR;
+            if (plen < 2) {
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad list format for loc reduction: ", opstr, NULL);
+                return TCL_ERROR;
+            }
+
+            TCLMPI_CONV_CHECK(Double, ipair[0], &(idata[i].d), idata[i].d);
+            if (Tcl_GetIntFromObj(interp, ipair[1], &(idata[i].i)) != TCL_OK) {
+                Tcl_ResetResult(interp);
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad location data for reduction: ", opstr, NULL);
+                return TCL_ERROR;
+            }
+        }
+        ierr   = MPI_Reduce(idata, odata, len, MPI_DOUBLE_INT, op, root, comm);
+        result = Tcl_NewListObj(0, NULL);
+        if (rank == root) {
+            for (i = 0; i < len; ++i) {
+                Tcl_Obj *opair;
+                opair = Tcl_NewListObj(0, NULL);
+                Tcl_ListObjAppendElement(interp, opair, Tcl_NewDoubleObj(odata[i].d));
+                Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i));
+                Tcl_ListObjAppendElement(interp, result, opair);
+            }
+        }
+    } else {
+        Tcl_DecrRefCount(objv[1]);
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+    Tcl_DecrRefCount(objv[1]);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if (result) Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! Common implementation of the prefix and reduce-scatter reductions
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \param kind TCLMPI_SCAN, TCLMPI_EXSCAN or TCLMPI_REDUCE_SCATTER
+ * \return TCL_OK or TCL_ERROR
+ *
+ * The argument processing and data conversion of MPI_Scan(),
+ * MPI_Exscan() and MPI_Reduce_scatter_block() is the same as for
+ * MPI_Allreduce(), only the MPI function and the length of the
+ * result differ.
+ */
+static int tclmpi_scan_reduce(Tcl_Interp *interp, int objc, Tcl_Obj *const objv[], int kind)
+{
+    Tcl_Obj *result = NULL, *vec = NULL;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    MPI_Op op;
+    void *idata = NULL, *odata = NULL;
+    int type, rank, size, len, olen, ierr = MPI_SUCCESS;
+
+    if (objc != 5) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <op> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    /* special case check for reduction */
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+        return TCL_ERROR;
+    }
+
+    if (tclmpi_get_op(objv[3], &op) != TCL_OK) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown reduction operator: ", Tcl_GetString(objv[3]),
+                         NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[4], &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    mtype = tclmpi_mpitype(type);
+
+    if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        vec = tclmpi_get_vector(interp, comm, objv[1], type);
+        if (vec == NULL) return TCL_ERROR;
+        Tcl_IncrRefCount(vec);
+        len   = TCLMPI_VEC(vec)->len;
+        idata = TCLMPI_VEC(vec)->data;
+    } else if ((type == TCLMPI_INT_INT) || (type == TCLMPI_DOUBLE_INT)) {
+        if (tclmpi_get_pairs(interp, comm, objv[0], objv[3], objv[1], type, &len, &idata) != TCL_OK)
+            return TCL_ERROR;
+    } else {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    /* each process gets an equal share of the reduced data. the maximum and
+       minimum length are checked with one reduction, so that all processes
+       agree on whether the data can be divided */
+    olen = len;
+    if (kind == TCLMPI_REDUCE_SCATTER) {
+        int ilens[2], olens[2];
+
+        ilens[0] = len;
+        ilens[1] = -len;
+        ierr     = MPI_Allreduce(ilens, olens, 2, MPI_INT, MPI_MAX, comm);
+        if ((ierr != MPI_SUCCESS) || (olens[0] != -olens[1]) || (len % size)) {
+            if (vec) Tcl_DecrRefCount(vec);
+            if (ierr != MPI_SUCCESS)
+                tclmpi_errcheck(interp, ierr, objv[0]);
+            else if (olens[0] != -olens[1])
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
+                                 ": number of data items must be the same on all processes", NULL);
+            else
+                Tcl_AppendResult(interp, Tcl_GetString(objv[0]),
+                                 ": number of data items must be divisible by the number of processes", NULL);
+            return TCL_ERROR;
+        }
+        olen = len / size;
+    }
+
+    /* the result of a loc reduction goes into the scratch buffer behind the pairs */
+    if (vec)
+        result = tclmpi_new_vector(type, olen, &odata);
+    else if (type == TCLMPI_INT_INT)
+        odata = (tclmpi_intint_t *)idata + len;
+    else
+        odata = (tclmpi_dblint_t *)idata + len;
+
+    if (kind == TCLMPI_SCAN)
+        ierr = MPI_Scan(idata, odata, len, mtype, op, comm);
+    else if (kind == TCLMPI_EXSCAN)
+        ierr = MPI_Exscan(idata, odata, len, mtype, op, comm);
+    else
+        ierr = MPI_Reduce_scatter_block(idata, odata, olen, mtype, op, comm);
+
+    if (vec)
+        Tcl_DecrRefCount(vec);
+    else
+        result = tclmpi_new_pairs(type, olen, odata);
+
+    /* the result of an exclusive scan is undefined on the first process */
+    if ((kind == TCLMPI_EXSCAN) && (rank == 0)) {
+        Tcl_DecrRefCount(result);
+        result = Tcl_NewListObj(0, NULL);
+    }
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        Tcl_DecrRefCount(result);
+        return TCL_ERROR;
+    }
+
+    Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Scan()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements an inclusive prefix reduction for TclMPI.
+ * Process i receives the reduction of the data of processes 0 to i.
+ * Supported data types and operators are the same as for TclMPI_Allreduce().
+ *
+ * The result is passed up as a "tclmpi::vector" object for tclmpi::int
+ * and tclmpi::double data or as a list of pairs for the pair types to the
+ * calling Tcl code. If the MPI call failed, an MPI error message is passed
+ * up as result instead.
+ */
+int TclMPI_Scan(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    return tclmpi_scan_reduce(interp, objc, objv, TCLMPI_SCAN);
+}
+
+/*! wrapper for MPI_Exscan()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements an exclusive prefix reduction for TclMPI.
+ * Process i receives the reduction of the data of processes 0 to i-1.
+ * Supported data types and operators are the same as for TclMPI_Allreduce().
+ *
+ * The result is passed up to the calling Tcl code like for TclMPI_Scan(),
+ * except for the process with rank 0, which returns an empty list. If the
+ * MPI call failed, an MPI error message is passed up as result instead.
+ */
+int TclMPI_Exscan(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    return tclmpi_scan_reduce(interp, objc, objv, TCLMPI_EXSCAN);
+}
+
+/*! wrapper for MPI_Reduce_scatter_block()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a reduction followed by a scatter of the
+ * result in equal blocks for TclMPI. The number of data items must be
+ * the same on all processes and divisible by the number of processes.
+ * Both conditions are checked with a MAX reduction of the lengths before
+ * the data is reduced, so that all processes return the same error.
+ * Process i receives the i-th block of the reduced data. Supported data
+ * types and operators are the same as for TclMPI_Allreduce().
+ *
+ * The result is passed up to the calling Tcl code like for TclMPI_Scan().
+ * If the MPI call failed, an MPI error message is passed up as result
+ * instead.
+ */
+int TclMPI_Reduce_scatter_block(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    return tclmpi_scan_reduce(interp, objc, objv, TCLMPI_REDUCE_SCATTER);
+}
+
+#if MPI_VERSION >= 3
+/*! wrapper for MPI_Ibarrier()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a non-blocking barrier for TclMPI.
+ * A request handle is passed up as result to the calling Tcl code,
+ * and TclMPI_Wait() on it returns an empty result once all processes
+ * on the communicator have entered the barrier. If the MPI call failed,
+ * an MPI error message is passed up as result instead.
+ */
+int TclMPI_Ibarrier(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_req_t *req;
+    MPI_Comm comm;
+    int ierr = MPI_SUCCESS;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<comm>");
+        return TCL_ERROR;
+    }
+
+    comm = tcl2mpi_comm(objv[1]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+
+    req = tclmpi_add_req();
+    if (req == NULL) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+        return TCL_ERROR;
+    }
+    req->coll = 1;
+    req->comm = comm;
+
+    ierr = MPI_Ibarrier(comm, req->req);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_del_req(req);
+        return TCL_ERROR;
+    }
+
+    /* return request handle */
+    Tcl_SetObjResult(interp, tclmpi_req_obj(req));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Ibcast()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a non-blocking broadcast for TclMPI.
+ * The supported data types are the same as for TclMPI_Bcast().
+ * Since the receiving processes cannot know the length of the data
+ * in advance, the length and data type are broadcast first with a
+ * (small) blocking MPI_Bcast(), then the transfer of the data itself
+ * is started with MPI_Ibcast() directly into the result object.
+ *
+ * A request handle is passed up as result to the calling Tcl code,
+ * and TclMPI_Wait() on it returns the broadcast data the same way as
+ * TclMPI_Bcast(). If the MPI call failed, an MPI error message is
+ * passed up as result instead.
+ */
+int TclMPI_Ibcast(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_req_t *req;
+    Tcl_Obj *sobj = NULL;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    MPI_Request mpireq;
+    void *data = NULL;
+    int type, root, rank, len = 0, hdr[2], esize, ierr = MPI_SUCCESS;
+
+    if (objc != 5) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    if ((type != TCLMPI_AUTO) && (type != TCLMPI_BYTES) && (type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(objv[4], &rank, NULL);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    if (rank == root) {
+        sobj = tclmpi_hold_obj(interp, comm, objv[1], type, &len, &data);
+        if (sobj == NULL) return TCL_ERROR;
+        Tcl_IncrRefCount(sobj);
+    }
+
+    /* broadcast length and data type, so that a receive buffer can be set up */
+    hdr[0] = len;
+    hdr[1] = type;
+    ierr   = MPI_Bcast(hdr, 2, MPI_INT, root, comm);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        if (sobj) Tcl_DecrRefCount(sobj);
+        return TCL_ERROR;
+    }
+
+    /* the broadcast of the data must still be completed on a type mismatch.
+       a non-blocking collective can only be matched by another one. */
+    if (hdr[1] != type) {
+        mtype = tclmpi_mpitype(hdr[1]);
+        MPI_Type_size(mtype, &esize);
+        data = Tcl_Alloc((size_t)hdr[0] * esize + 1);
+        MPI_Ibcast(data, hdr[0], mtype, root, comm, &mpireq);
+        MPI_Wait(&mpireq, MPI_STATUS_IGNORE);
+        Tcl_Free((char *)data);
+        tclmpi_errcheck(interp, MPI_ERR_TRUNCATE, objv[0]);
+        return TCL_ERROR;
+    }
+
+    req = tclmpi_add_req();
+    if (req == NULL) {
+        if (sobj) Tcl_DecrRefCount(sobj);
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+        return TCL_ERROR;
+    }
+    req->coll = 1;
+    req->type = type;
+    req->len  = hdr[0];
+    req->comm = comm;
+
+    /* like for TclMPI_Bcast, the root returns the converted data */
+    if (rank == root) {
+        req->sobj = sobj;
+        req->obj  = ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) ? sobj : objv[1];
+    } else {
+        req->obj = tclmpi_recv_obj(type, req->len, &data);
+    }
+    Tcl_IncrRefCount(req->obj);
+
+    ierr = MPI_Ibcast(data, req->len, tclmpi_mpitype(type), root, comm, req->req);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_del_req(req);
+        return TCL_ERROR;
+    }
+
+    /* return request handle */
+    Tcl_SetObjResult(interp, tclmpi_req_obj(req));
+    return TCL_OK;
+}
+
+/*! Common implementation of the non-blocking reductions
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \param all non-zero for MPI_Iallreduce(), zero for MPI_Ireduce()
+ * \return TCL_OK or TCL_ERROR
+ *
+ * The argument processing and data conversion is the same as for
+ * TclMPI_Allreduce() and TclMPI_Reduce(). The send data is held by
+ * the request, and the result object is set up as receive buffer,
+ * so that TclMPI_Wait() can return it without copying. Pairs are
+ * received into a plain buffer and converted by TclMPI_Wait().
+ */
+static int tclmpi_ireduce(Tcl_Interp *interp, int objc, Tcl_Obj *const objv[], int all)
+{
+    tclmpi_req_t *req;
+    Tcl_Obj *sobj, *commobj;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    MPI_Op op;
+    void *sdata, *odata = NULL;
+    int type, root = 0, rank, len, esize, ierr = MPI_SUCCESS;
+
+    if (all && (objc != 5)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <op> <comm>");
+        return TCL_ERROR;
+    } else if (!all && (objc != 6)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <op> <root> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    if (!all && (Tcl_GetIntFromObj(interp, objv[4], &root) != TCL_OK)) return TCL_ERROR;
+
+    commobj = objv[objc - 1];
+    comm    = tcl2mpi_comm(commobj);
+    if (tclmpi_commcheck(interp, comm, objv[0], commobj) != TCL_OK) return TCL_ERROR;
+
+    /* special case check for reduction */
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+        return TCL_ERROR;
+    }
+
+    if (tclmpi_get_op(objv[3], &op) != TCL_OK) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown reduction operator: ", Tcl_GetString(objv[3]),
+                         NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(commobj, &rank, NULL);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    if (all) root = rank;
+    mtype = tclmpi_mpitype(type);
+
+    if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        sobj = tclmpi_hold_obj(interp, comm, objv[1], type, &len, &sdata);
+        if (sobj == NULL) return TCL_ERROR;
+    } else if ((type == TCLMPI_INT_INT) || (type == TCLMPI_DOUBLE_INT)) {
+        void *pairs;
+        if (tclmpi_get_pairs(interp, comm, objv[0], objv[3], objv[1], type, &len, &pairs) != TCL_OK)
+            return TCL_ERROR;
+        /* keep the converted pairs in a private byte array */
+        esize = (type == TCLMPI_INT_INT) ? sizeof(tclmpi_intint_t) : sizeof(tclmpi_dblint_t);
+        sobj  = Tcl_NewByteArrayObj((unsigned char *)pairs, len * esize);
+        sdata = Tcl_GetByteArrayFromObj(sobj, NULL);
+    } else {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+    Tcl_IncrRefCount(sobj);
+
+    req = tclmpi_add_req();
+    if (req == NULL) {
+        Tcl_DecrRefCount(sobj);
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+        return TCL_ERROR;
+    }
+    req->coll = 1;
+    req->type = type;
+    req->len  = 0;
+    req->comm = comm;
+    req->sobj = sobj;
+
+    if (rank == root) {
+        req->len = len;
+        if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+            req->obj = tclmpi_new_vector(type, len, &odata);
+            Tcl_IncrRefCount(req->obj);
+        } else {
+            req->data = Tcl_Alloc((size_t)len * esize + 1);
+            odata     = req->data;
+        }
+    }
+
+    if (all)
+        ierr = MPI_Iallreduce(sdata, odata, len, mtype, op, comm, req->req);
+    else
+        ierr = MPI_Ireduce(sdata, odata, len, mtype, op, root, comm, req->req);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_del_req(req);
+        return TCL_ERROR;
+    }
+
+    /* return request handle */
+    Tcl_SetObjResult(interp, tclmpi_req_obj(req));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Iallreduce()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a non-blocking reduction plus broadcast for
+ * TclMPI. Supported data types and operators are the same as for
+ * TclMPI_Allreduce(). A request handle is passed up as result to the
+ * calling Tcl code, and TclMPI_Wait() on it returns the reduced data
+ * the same way as TclMPI_Allreduce(). If the MPI call failed, an MPI
+ * error message is passed up as result instead.
+ */
+int TclMPI_Iallreduce(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    return tclmpi_ireduce(interp, objc, objv, 1);
+}
+
+/*! wrapper for MPI_Ireduce()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a non-blocking reduction for TclMPI.
+ * Supported data types and operators are the same as for TclMPI_Reduce().
+ * A request handle is passed up as result to the calling Tcl code, and
+ * TclMPI_Wait() on it returns the reduced data on the root process and
+ * an empty list on all other processes. If the MPI call failed, an MPI
+ * error message is passed up as result instead.
+ */
+int TclMPI_Ireduce(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    return tclmpi_ireduce(interp, objc, objv, 0);
+}
+
+/*! Common implementation of the non-blocking gather operations
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \param all non-zero for MPI_Iallgather(), zero for MPI_Igather()
+ * \return TCL_OK or TCL_ERROR
+ *
+ * Only tclmpi::int and tclmpi::double data is supported, like for
+ * TclMPI_Allgather() and TclMPI_Gather(). Unlike for those, the number
+ * of data items is not checked before the data is gathered, since that
+ * would require a blocking reduction. A mismatch is reported by MPI as
+ * a truncated message when waiting for the request.
+ */
+static int tclmpi_igather(Tcl_Interp *interp, int objc, Tcl_Obj *const objv[], int all)
+{
+    tclmpi_req_t *req;
+    Tcl_Obj *sobj, *commobj;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    void *sdata, *odata = NULL;
+    int type, root = 0, rank, size, len, ierr = MPI_SUCCESS;
+
+    if (all && (objc != 4)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <comm>");
+        return TCL_ERROR;
+    } else if (!all && (objc != 5)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    if (!all && (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK)) return TCL_ERROR;
+
+    commobj = objv[objc - 1];
+    comm    = tcl2mpi_comm(commobj);
+    if (tclmpi_commcheck(interp, comm, objv[0], commobj) != TCL_OK) return TCL_ERROR;
+
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+        return TCL_ERROR;
+    } else if ((type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    ierr = tclmpi_comm_info(commobj, &rank, &size);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    if (all) root = rank;
+    mtype = tclmpi_mpitype(type);
+
+    sobj = tclmpi_hold_obj(interp, comm, objv[1], type, &len, &sdata);
+    if (sobj == NULL) return TCL_ERROR;
+    Tcl_IncrRefCount(sobj);
+
+    req = tclmpi_add_req();
+    if (req == NULL) {
+        Tcl_DecrRefCount(sobj);
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+        return TCL_ERROR;
+    }
+    req->coll = 1;
+    req->type = type;
+    req->len  = 0;
+    req->comm = comm;
+    req->sobj = sobj;
+
+    if (rank == root) {
+        req->len = len * size;
+        req->obj = tclmpi_new_vector(type, req->len, &odata);
+        Tcl_IncrRefCount(req->obj);
+    }
+
+    if (all)
+        ierr = MPI_Iallgather(sdata, len, mtype, odata, len, mtype, comm, req->req);
+    else
+        ierr = MPI_Igather(sdata, len, mtype, odata, len, mtype, root, comm, req->req);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_del_req(req);
+        return TCL_ERROR;
+    }
+
+    /* return request handle */
+    Tcl_SetObjResult(interp, tclmpi_req_obj(req));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Iallgather()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a non-blocking gather operation that
+ * collects data on all processes for TclMPI. Only tclmpi::int and
+ * tclmpi::double data is supported and the number of data items
+ * has to be the same on all processes. A request handle is passed up
+ * as result to the calling Tcl code, and TclMPI_Wait() on it returns
+ * the gathered data the same way as TclMPI_Allgather(). If the MPI
+ * call failed, an MPI error message is passed up as result instead.
+ */
+int TclMPI_Iallgather(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    return tclmpi_igather(interp, objc, objv, 1);
+}
+
+/*! wrapper for MPI_Igather()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a non-blocking gather operation for TclMPI.
+ * Only tclmpi::int and tclmpi::double data is supported and the number
+ * of data items has to be the same on all processes. A request handle is
+ * passed up as result to the calling Tcl code, and TclMPI_Wait() on it
+ * returns the gathered data on the root process and an empty list on
+ * all other processes. If the MPI call failed, an MPI error message is
+ * passed up as result instead.
+ */
+int TclMPI_Igather(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    return tclmpi_igather(interp, objc, objv, 0);
+}
+#endif
+
+/*! wrapper for MPI_Send()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a blocking send operation for TclMPI.
+ * The length of the data is inferred from the data object passed to this
+ * function and thus a 'count' argument is not needed.
+ * In the case of tclmpi::auto, the string representation of the send data
+ * is directly passed to MPI_Send(), and for tclmpi::bytes its byte array
+ * representation. The same applies to "tclmpi::vector"
+ * objects of matching type, otherwise a copy is made and data converted.
+ *
+ * If the MPI call failed, an MPI error message is passed up as result
+ * instead and a Tcl error is indicated, otherwise nothing is returned.
+ */
+int TclMPI_Send(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    MPI_Comm comm;
+    int dest, tag, type, len, ierr = MPI_SUCCESS;
+
+    if (objc != 6) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <dest> <tag> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[5]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[5]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &dest) != TCL_OK) return TCL_ERROR;
+    if (Tcl_GetIntFromObj(interp, objv[4], &tag) != TCL_OK) return TCL_ERROR;
+
+    Tcl_IncrRefCount(objv[1]);
+    if (type == TCLMPI_AUTO) {
+        char *idata;
+        idata = Tcl_GetStringFromObj(objv[1], &len);
+        ierr  = MPI_Send(idata, len, MPI_CHAR, dest, tag, comm);
+    } else if (type == TCLMPI_BYTES) {
+        unsigned char *idata;
+        idata = Tcl_GetByteArrayFromObj(objv[1], &len);
+        ierr  = MPI_Send(idata, len, MPI_BYTE, dest, tag, comm);
+    } else if ((type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        MPI_Datatype mtype = tclmpi_mpitype(type);
+        Tcl_Obj *vec;
+
+        vec = tclmpi_get_vector(interp, comm, objv[1], type);
+        if (vec == NULL) {
+            Tcl_DecrRefCount(objv[1]);
+            return TCL_ERROR;
+        }
+        Tcl_IncrRefCount(vec);
+        ierr = MPI_Send(TCLMPI_VEC(vec)->data, TCLMPI_VEC(vec)->len, mtype, dest, tag, comm);
+        Tcl_DecrRefCount(vec);
+    } else {
+        Tcl_DecrRefCount(objv[1]);
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+    Tcl_DecrRefCount(objv[1]);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Isend()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a non-blocking send operation for TclMPI.
+ * The length of the data is inferred from the data object passed to
+ * this function and thus a 'count' argument is not needed.  The send
+ * buffer must stay valid until the request is completed, so the request
+ * holds a reference to the Tcl object with the data: for tclmpi::auto
+ * the string representation of the data object and for tclmpi::int and
+ * tclmpi::double the (shared) buffer of a "tclmpi::vector" object is
+ * sent without making a copy. Only tclmpi::bytes data is copied, since
+ * a byte array is freed when its object changes type. The command
+ * generates a new tclmpi_req_t communication request via tclmpi_add_req
+ * and the pointers to the data buffer and the MPI_Request info
+ * generated by MPI_Isend is stored in this request table entry for
+ * later perusal, see TclMPI_Wait. The generated string label
+ * representing this request will be passed on to the calling program as
+ * Tcl result. If the MPI call failed, an MPI error message is passed up
+ * as result instead and a Tcl error is indicated.
+ */
+int TclMPI_Isend(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_req_t *req;
+    void *data;
+    MPI_Comm comm;
+    int dest, tag, type, len, ierr = MPI_SUCCESS;
+
+    if (objc != 6) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <dest> <tag> <comm>");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[5]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[5]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &dest) != TCL_OK) return TCL_ERROR;
+    if (Tcl_GetIntFromObj(interp, objv[4], &tag) != TCL_OK) return TCL_ERROR;
+
+    req = tclmpi_add_req();
+    if (req == NULL) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+        return TCL_ERROR;
+    }
+    req->type = type;
+    data      = NULL;
+    req->len  = TCLMPI_INVALID;
+    req->comm = comm;
+
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES) || (type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        req->sobj = tclmpi_hold_obj(interp, comm, objv[1], type, &len, &data);
+        if (req->sobj == NULL) {
+            tclmpi_del_req(req);
+            return TCL_ERROR;
+        }
+        Tcl_IncrRefCount(req->sobj);
+        ierr = MPI_Isend(data, len, tclmpi_mpitype(type), dest, tag, comm, req->req);
+    } else {
+        tclmpi_del_req(req);
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_del_req(req);
+        return TCL_ERROR;
+    }
+
+    /* return request handle */
+    Tcl_SetObjResult(interp, tclmpi_req_obj(req));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Recv()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a blocking receive operation for TclMPI.
+ * Since the length of the data object is supposed to be automatically
+ * adjusted to the amount of data being sent, this function will first
+ * call MPI_Mprobe to identify the amount of storage needed from the
+ * MPI_Status object that is populated by MPI_Mprobe. Then a Tcl object
+ * is created via tclmpi_recv_obj according to the data type passed to
+ * the receive command, and the matched message is received with
+ * MPI_Mrecv directly into its storage, which avoids any temporary
+ * buffers or copies. Due to this deviation from the MPI C bindings a
+ * 'count' argument is not needed. This command returns the received
+ * data to the calling procedure. If the MPI call failed, an MPI error
+ * message is passed up as result instead and a Tcl error is indicated.
+ */
+int TclMPI_Recv(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result;
+    const char *statvar;
+    MPI_Comm comm;
+    MPI_Status status;
+    int source, tag, type, len, ierr = MPI_SUCCESS;
+    memset(&status, 0, sizeof(MPI_Status));
+
+    if ((objc < 5) || (objc > 6)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<type> <source> <tag> <comm> ?status?");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[1]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    if (strcmp(Tcl_GetString(objv[2]), "tclmpi::any_source") == 0)
+        source = MPI_ANY_SOURCE;
+    else if (Tcl_GetIntFromObj(interp, objv[2], &source) != TCL_OK)
+        return TCL_ERROR;
+
+    if (strcmp(Tcl_GetString(objv[3]), "tclmpi::any_tag") == 0)
+        tag = MPI_ANY_TAG;
+    else if (Tcl_GetIntFromObj(interp, objv[3], &tag) != TCL_OK)
+        return TCL_ERROR;
+
+    if (objc > 5)
+        statvar = Tcl_GetString(objv[5]);
+    else
+        statvar = NULL;
+
+    len = 0;
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES) || (type == TCLMPI_INT) || (type == TCLMPI_DOUBLE)) {
+        MPI_Datatype mtype = tclmpi_mpitype(type);
+        tclmpi_msg_t msg;
+        void *idata;
+        ierr = tclmpi_probe_msg(source, tag, comm, NULL, &msg, &status);
+        if (ierr != MPI_SUCCESS) {
+            result = Tcl_NewListObj(0, NULL);
+        } else {
+            MPI_Get_count(&status, mtype, &len);
+            result = tclmpi_recv_obj(type, len, &idata);
+
+            if (statvar != NULL)
+                ierr = tclmpi_recv_msg(idata, len, mtype, &msg, NULL, &status);
+            else
+                ierr = tclmpi_recv_msg(idata, len, mtype, &msg, NULL, MPI_STATUS_IGNORE);
+        }
+    } else {
+        result = Tcl_NewListObj(0, NULL);
+    }
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        Tcl_IncrRefCount(result);
+        Tcl_DecrRefCount(result);
+        return TCL_ERROR;
+    }
+
+    if (statvar != NULL) {
+        Tcl_Obj *var;
+        int len_char, len_int, len_double;
+        MPI_Get_count(&status, MPI_CHAR, &len_char);
+        MPI_Get_count(&status, MPI_INT, &len_int);
+        MPI_Get_count(&status, MPI_DOUBLE, &len_double);
+        Tcl_UnsetVar(interp, statvar, 0);
+        var = Tcl_NewStringObj(statvar, -1);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status.MPI_SOURCE), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status.MPI_TAG), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status.MPI_ERROR), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_char), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_char), 0);
+    }
+
+    Tcl_SetObjResult(interp, tclmpi_vec_result(result));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Iecv()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a non-blocking receive operation for TclMPI.
+ * Since the length of the data object is supposed to be automatically
+ * adjusted to the amount of data being sent, this function needs to be
+ * more complex than just a simple wrapper around the corresponding MPI
+ * C bindings. It will first call tclmpi_add_req to generate a new entry
+ * in the table of registered MPI requests. It will then call
+ * MPI_Improbe to see if a matching send is already in progress and thus
+ * the necessary amount of storage required can be inferred from the
+ * MPI_Status object that is populated by MPI_Improbe. If yes, the Tcl
+ * object that will hold the result is created with tclmpi_recv_obj, the
+ * non-blocking receive of the matched message is posted with MPI_Imrecv
+ * directly into its storage and all information is transferred to the
+ * tclmpi_req_t object. If not, only the arguments of the receive call
+ * are registered in the request object for later use. With the optional
+ * -maxcount argument, the capacity of the receive buffer is known in
+ * advance, so the receive is posted at once and communication can
+ * overlap with computation. The result is then trimmed to the amount of
+ * data actually received, as recorded in the MPI status at completion,
+ * and larger messages cause an error in TclMPI_Wait(). The command will
+ * pass the Tcl string that represents the generated MPI request to the
+ * Tcl interpreter as return value. If the MPI call failed, an MPI error
+ * message is passed up as result instead and a Tcl error is indicated.
+ */
+int TclMPI_Irecv(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_req_t *req;
+    MPI_Comm comm;
+    MPI_Status status;
+    tclmpi_msg_t msg;
+    int source, tag, type, pending, len, maxcount, ierr = MPI_SUCCESS;
+
+    if ((objc != 5) && ((objc != 7) || (strcmp(Tcl_GetString(objv[5]), "-maxcount") != 0))) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<type> <source> <tag> <comm> ?-maxcount <num>?");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[1]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[4]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+
+    if (strcmp(Tcl_GetString(objv[2]), "tclmpi::any_source") == 0)
+        source = MPI_ANY_SOURCE;
+    else if (Tcl_GetIntFromObj(interp, objv[2], &source) != TCL_OK)
+        return TCL_ERROR;
+
+    if (strcmp(Tcl_GetString(objv[3]), "tclmpi::any_tag") == 0)
+        tag = MPI_ANY_TAG;
+    else if (Tcl_GetIntFromObj(interp, objv[3], &tag) != TCL_OK)
+        return TCL_ERROR;
+
+    maxcount = TCLMPI_INVALID;
+    if (objc > 5) {
+        if (Tcl_GetIntFromObj(interp, objv[6], &maxcount) != TCL_OK) return TCL_ERROR;
+        if (maxcount < 0) {
+            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid count: ", Tcl_GetString(objv[6]), NULL);
+            return TCL_ERROR;
+        }
+    }
+
+    req = tclmpi_add_req();
+    if (req == NULL) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+        return TCL_ERROR;
+    }
+    req->type   = type;
+    req->source = source;
+    req->tag    = tag;
+    req->comm   = comm;
+    req->data   = NULL;
+    /* indicate receive */
+    req->len = TCLMPI_NONE;
+
+    /* the buffer capacity is known, so the receive can be posted right away */
+    if ((maxcount >= 0) &&
+        ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES) || (type == TCLMPI_INT) || (type == TCLMPI_DOUBLE))) {
+        req->obj = tclmpi_recv_obj(type, maxcount, &req->data);
+        Tcl_IncrRefCount(req->obj);
+        req->len = maxcount;
+        ierr     = MPI_Irecv(req->data, maxcount, tclmpi_mpitype(type), source, tag, comm, req->req);
+        if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+            tclmpi_del_req(req);
+            return TCL_ERROR;
+        }
+        Tcl_SetObjResult(interp, tclmpi_req_obj(req));
+        return TCL_OK;
+    }
+
+    pending = len = 0;
+
+    /* check if a matching send is already posted and ready to be received.
+       a matched message must be received, so skip unsupported data types. */
+    if ((type == TCLMPI_AUTO) || (type == TCLMPI_BYTES) || (type == TCLMPI_INT) || (type == TCLMPI_DOUBLE))
+        ierr = tclmpi_probe_msg(source, tag, comm, &pending, &msg, &status);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_del_req(req);
+        return TCL_ERROR;
+    }
+
+    if (pending != 0) {
+        MPI_Datatype mtype = tclmpi_mpitype(type);
+        MPI_Get_count(&status, mtype, &len);
+        req->obj = tclmpi_recv_obj(type, len, &req->data);
+        Tcl_IncrRefCount(req->obj);
+        req->len = len;
+        ierr     = tclmpi_recv_msg(req->data, len, mtype, &msg, req->req, NULL);
+
+        /* posting the receive failed */
+        if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+            tclmpi_del_req(req);
+            return TCL_ERROR;
+        }
+    }
+
+    /* return request handle */
+    Tcl_SetObjResult(interp, tclmpi_req_obj(req));
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Probe()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a gather operation that collects data for TclMPI.
- * This operation does not accept the tclmpi::auto data type, also support
- * for types outside of tclmpi::int and tclmpi::double is incomplete.
- * The length of the data is inferred from the data object passed to this
- * function and thus a 'count' argument is not needed. The number of data
- * items has to be the same on all processes on the communicator.
+ * This function implements a blocking probe operation for TclMPI.
+ * Argument flags for source, tag, and communicator are translated
+ * into their native MPI equivalents and then MPI_Probe called.
  *
- * The result is converted back into Tcl objects and passed up as result
- * value to the calling Tcl code on the root processor. If the MPI call
- * failed, an MPI error message is passed up as result instead.
+ * Similar to MPI_Probe, generating a status object to inspect the
+ * pending receive is optional. If desired, the argument is taken
+ * as a variable name which will then be generated as associative
+ * array with several entries similar to what MPI_Status contains.
+ * Those are source, tag, error status and count, however this is
+ * directly provided as multiple entries translated to char, int
+ * and double data types (COUNT_CHAR, COUNT_INT, COUNT_DOUBLE).
  */
-int TclMPI_Gather(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Probe(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
-    Tcl_Obj *result = NULL;
+    const char *statvar;
     MPI_Comm comm;
-    int i, type, root, size, rank, ilen, olen, mlen, ierr = MPI_SUCCESS;
+    MPI_Status status;
+    int source, tag, ierr = MPI_SUCCESS;
 
-    if (objc != 5) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <root> <comm>");
+    if ((objc < 4) || (objc > 5)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<source> <tag> <comm> ?status?");
         return TCL_ERROR;
     }
 
-    type = tclmpi_datatype(Tcl_GetString(objv[2]));
-    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+    if (strcmp(Tcl_GetString(objv[1]), "tclmpi::any_source") == 0)
+        source = MPI_ANY_SOURCE;
+    else if (Tcl_GetIntFromObj(interp, objv[1], &source) != TCL_OK)
+        return TCL_ERROR;
 
-    if (Tcl_GetIntFromObj(interp, objv[3], &root) != TCL_OK) return TCL_ERROR;
+    if (strcmp(Tcl_GetString(objv[2]), "tclmpi::any_tag") == 0)
+        tag = MPI_ANY_TAG;
+    else if (Tcl_GetIntFromObj(interp, objv[2], &tag) != TCL_OK)
+        return TCL_ERROR;
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[4]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+    comm = tcl2mpi_comm(objv[3]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[3]) != TCL_OK) return TCL_ERROR;
+    if (comm == MPI_COMM_NULL) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid communicator: ", Tcl_GetString(objv[3]), NULL);
+        return TCL_ERROR;
+    }
 
-    /* special case check for reduction */
-    if (type == TCLMPI_AUTO) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+    if (objc > 4)
+        statvar = Tcl_GetString(objv[4]);
+    else
+        statvar = NULL;
+
+    if (statvar != NULL) {
+        Tcl_Obj *var;
+        int len_char, len_int, len_double;
+
+        ierr = MPI_Probe(source, tag, comm, &status);
+
+        MPI_Get_count(&status, MPI_CHAR, &len_char);
+        MPI_Get_count(&status, MPI_INT, &len_int);
+        MPI_Get_count(&status, MPI_DOUBLE, &len_double);
+        Tcl_UnsetVar(interp, statvar, 0);
+        var = Tcl_NewStringObj(statvar, -1);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status.MPI_SOURCE), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status.MPI_TAG), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status.MPI_ERROR), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_char), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_char), 0);
+    } else
+        ierr = MPI_Probe(source, tag, comm, MPI_STATUS_IGNORE);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Iprobe()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function implements a non-blocking probe operation for TclMPI.
+ * Argument flags for source, tag, and communicator are translated
+ * into their native MPI equivalents and then MPI_Iprobe called.
+ *
+ * Similar to MPI_Probe, generating a status object to inspect the
+ * pending receive is optional. If desired, the argument is taken
+ * as a variable name which will then be generated as associative
+ * array with several entries similar to what MPI_Status contains.
+ * Those are source, tag, error status and count, however this is
+ * directly provided as multiple entries translated to char, int
+ * and double data types (COUNT_CHAR, COUNT_INT, COUNT_DOUBLE).
+ *
+ * The status flag in MPI_Iprobe that returns true if a request is
+ * pending will be passed to the calling routine as Tcl result.
+ */
+int TclMPI_Iprobe(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    const char *statvar;
+    MPI_Comm comm;
+    MPI_Status status;
+    int source, tag, ierr, pending;
+
+    if ((objc < 4) || (objc > 5)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<source> <tag> <comm> ?status?");
         return TCL_ERROR;
     }
 
-    MPI_Comm_size(comm, &size);
-    MPI_Comm_rank(comm, &rank);
-    Tcl_IncrRefCount(objv[1]);
+    if (strcmp(Tcl_GetString(objv[1]), "tclmpi::any_source") == 0)
+        source = MPI_ANY_SOURCE;
+    else if (Tcl_GetIntFromObj(interp, objv[1], &source) != TCL_OK)
+        return TCL_ERROR;
 
-    if (type == TCLMPI_INT) {
-        Tcl_Obj **ilist;
-        int *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &ilen, &ilist) != TCL_OK) return TCL_ERROR;
-        MPI_Allreduce(&ilen, &olen, 1, MPI_INT, MPI_MAX, comm);
-        MPI_Allreduce(&ilen, &mlen, 1, MPI_INT, MPI_MIN, comm);
-        if (olen != mlen) {
-            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": number of data items must be the same on all processes",
-                             NULL);
-            Tcl_DecrRefCount(objv[1]);
-            return TCL_ERROR;
-        }
+    if (strcmp(Tcl_GetString(objv[2]), "tclmpi::any_tag") == 0)
+        tag = MPI_ANY_TAG;
+    else if (Tcl_GetIntFromObj(interp, objv[2], &tag) != TCL_OK)
+        return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[3]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[3]) != TCL_OK) return TCL_ERROR;
+    if (comm == MPI_COMM_NULL) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid communicator: ", Tcl_GetString(objv[3]), NULL);
+        return TCL_ERROR;
+    }
 
-        mlen  = olen * size;
-        idata = (int *)Tcl_Alloc(ilen * sizeof(int));
-        for (i = 0; i < ilen; ++i) TCLMPI_CONV_CHECK(Int, ilist[i], idata + i, idata[i]);
+    if (objc > 4)
+        statvar = Tcl_GetString(objv[4]);
+    else
+        statvar = NULL;
+    pending = 0;
 
-        result = Tcl_NewListObj(0, NULL);
-        if (rank == root) {
-            odata = (int *)Tcl_Alloc(mlen * sizeof(int));
-            ierr  = MPI_Gather(idata, ilen, MPI_INT, odata, olen, MPI_INT, root, comm);
-            for (i = 0; i < mlen; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(odata[i]));
-            Tcl_Free((char *)odata);
-        } else {
-            odata = NULL;
-            ierr  = MPI_Gather(idata, ilen, MPI_INT, odata, olen, MPI_INT, root, comm);
-        }
-        Tcl_Free((char *)idata);
-
-    } else if (type == TCLMPI_DOUBLE) {
-        Tcl_Obj **ilist;
-        double *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &ilen, &ilist) != TCL_OK) return TCL_ERROR;
-        MPI_Allreduce(&ilen, &olen, 1, MPI_INT, MPI_MAX, comm);
-        MPI_Allreduce(&ilen, &mlen, 1, MPI_INT, MPI_MIN, comm);
-        if (olen != mlen) {
-            Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": number of data items must be the same on all processes",
-                             NULL);
-            Tcl_DecrRefCount(objv[1]);
-            return TCL_ERROR;
+    if (statvar != NULL) {
+        Tcl_Obj *var;
+        int len_char, len_int, len_double;
+
+        ierr = MPI_Iprobe(source, tag, comm, &pending, &status);
+
+        MPI_Get_count(&status, MPI_CHAR, &len_char);
+        MPI_Get_count(&status, MPI_INT, &len_int);
+        MPI_Get_count(&status, MPI_DOUBLE, &len_double);
+        Tcl_UnsetVar(interp, statvar, 0);
+        var = Tcl_NewStringObj(statvar, -1);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status.MPI_SOURCE), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status.MPI_TAG), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status.MPI_ERROR), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_char), 0);
+        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_char), 0);
+    } else
+        ierr = MPI_Iprobe(source, tag, comm, &pending, MPI_STATUS_IGNORE);
+
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+
+    Tcl_SetObjResult(interp, Tcl_NewIntObj(pending));
+    return TCL_OK;
+}
+
+/*! common code for combined send and receive operations
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \param replace non-zero for a receive into the send buffer
+ * \return TCL_OK or TCL_ERROR
+ *
+ * The arguments are parsed the same way for TclMPI_Sendrecv() and
+ * TclMPI_Sendrecv_replace(), which only differ in how the size of the
+ * receive buffer is determined.
+ */
+static int tclmpi_sendrecv(Tcl_Interp *interp, int objc, Tcl_Obj *const objv[], int replace)
+{
+    Tcl_Obj *sobj, *result;
+    const char *statvar;
+    MPI_Comm comm;
+    MPI_Datatype mtype;
+    MPI_Status status;
+    void *sdata, *rdata;
+    int dest, stag, source, rtag, type, len, esize, ierr = MPI_SUCCESS;
+    memset(&status, 0, sizeof(MPI_Status));
+
+    if ((objc < 8) || (objc > 9)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <dest> <sendtag> <source> <recvtag> <comm> ?status?");
+        return TCL_ERROR;
+    }
+
+    type = tclmpi_datatype(objv[2]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+
+    comm = tcl2mpi_comm(objv[7]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[7]) != TCL_OK) return TCL_ERROR;
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &dest) != TCL_OK) return TCL_ERROR;
+    if (Tcl_GetIntFromObj(interp, objv[4], &stag) != TCL_OK) return TCL_ERROR;
+
+    if (strcmp(Tcl_GetString(objv[5]), "tclmpi::any_source") == 0)
+        source = MPI_ANY_SOURCE;
+    else if (Tcl_GetIntFromObj(interp, objv[5], &source) != TCL_OK)
+        return TCL_ERROR;
+
+    if (strcmp(Tcl_GetString(objv[6]), "tclmpi::any_tag") == 0)
+        rtag = MPI_ANY_TAG;
+    else if (Tcl_GetIntFromObj(interp, objv[6], &rtag) != TCL_OK)
+        return TCL_ERROR;
+
+    if (objc > 8)
+        statvar = Tcl_GetString(objv[8]);
+    else
+        statvar = NULL;
+
+    if ((type != TCLMPI_AUTO) && (type != TCLMPI_BYTES) && (type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+    mtype = tclmpi_mpitype(type);
+
+    sobj = tclmpi_send_obj(interp, comm, objv[1], type, &len, &sdata);
+    if (sobj == NULL) return TCL_ERROR;
+    Tcl_IncrRefCount(sobj);
+
+    if (replace) {
+        int count;
+
+        /* the send buffer doubles as receive buffer, so the
+           received data may not be larger than the sent data */
+        MPI_Type_size(mtype, &esize);
+        result = tclmpi_recv_obj(type, len, &rdata);
+        memcpy(rdata, sdata, (size_t)len * esize);
+        ierr = MPI_Sendrecv_replace(rdata, len, mtype, dest, stag, source, rtag, comm, &status);
+        MPI_Get_count(&status, mtype, &count);
+        if ((ierr == MPI_SUCCESS) && (count != len)) {
+            Tcl_Obj *full = result;
+            result        = tclmpi_recv_obj(type, count, &sdata);
+            memcpy(sdata, rdata, (size_t)count * esize);
+            Tcl_IncrRefCount(full);
+            Tcl_DecrRefCount(full);
         }
+    } else {
+        MPI_Request sreq;
+        tclmpi_msg_t msg;
 
-        mlen  = olen * size;
-        idata = (double *)Tcl_Alloc(ilen * sizeof(double));
-        for (i = 0; i < ilen; ++i) TCLMPI_CONV_CHECK(Double, ilist[i], idata + i, idata[i]);
+        /* post the send first, so that probing for the size of the
+           incoming message cannot block the matching receive */
+        ierr = MPI_Isend(sdata, len, mtype, dest, stag, comm, &sreq);
+        if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+            Tcl_DecrRefCount(sobj);
+            return TCL_ERROR;
+        }
 
-        result = Tcl_NewListObj(0, NULL);
-        if (rank == root) {
-            odata = (double *)Tcl_Alloc(mlen * sizeof(double));
-            ierr  = MPI_Gather(idata, ilen, MPI_DOUBLE, odata, olen, MPI_DOUBLE, root, comm);
-            for (i = 0; i < mlen; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewDoubleObj(odata[i]));
-            Tcl_Free((char *)odata);
+        ierr = tclmpi_probe_msg(source, rtag, comm, NULL, &msg, &status);
+        if (ierr != MPI_SUCCESS) {
+            result = Tcl_NewListObj(0, NULL);
         } else {
-            odata = NULL;
-            ierr  = MPI_Gather(idata, ilen, MPI_DOUBLE, odata, olen, MPI_DOUBLE, root, comm);
+            MPI_Get_count(&status, mtype, &len);
+            result = tclmpi_recv_obj(type, len, &rdata);
+            ierr   = tclmpi_recv_msg(rdata, len, mtype, &msg, NULL, &status);
         }
-        Tcl_Free((char *)idata);
+        if (ierr == MPI_SUCCESS)
+            ierr = MPI_Wait(&sreq, MPI_STATUS_IGNORE);
+        else
+            MPI_Wait(&sreq, MPI_STATUS_IGNORE);
+    }
+    Tcl_DecrRefCount(sobj);
 
-    } else {
-        Tcl_DecrRefCount(objv[1]);
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
-                         " is not yet implemented.", NULL);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        Tcl_IncrRefCount(result);
+        Tcl_DecrRefCount(result);
         return TCL_ERROR;
     }
-    Tcl_DecrRefCount(objv[1]);
-
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
 
-    if (result) Tcl_SetObjResult(interp, result);
+    if (statvar != NULL) tclmpi_set_status(interp, statvar, &status);
+    Tcl_SetObjResult(interp, tclmpi_vec_result(result));
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Allreduce()
+/*! wrapper for MPI_Sendrecv()
  * \param nodata ignored
  * \param interp current Tcl interpreter
  * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a reduction plus broadcast function for TclMPI.
- * This operation does not accept the tclmpi::auto data type, also support
- * for types outside of tclmpi::int and tclmpi::double is incomplete.
- * The length of the data is inferred from the data object passed to this
- * function and thus a 'count' argument is not needed.
+ * This function implements a combined blocking send and receive for
+ * TclMPI, e.g. for shifting data along a ring of processes without
+ * having to order sends and receives to avoid a deadlock. As for
+ * TclMPI_Recv() the receive buffer is sized to the incoming message,
+ * so that the amount of data sent and received may differ. Since the
+ * size is only known from MPI_Mprobe after the matching send was posted,
+ * the send is started with MPI_Isend and completed after the message was
+ * received, which is equivalent to MPI_Sendrecv. The send and the
+ * receive use the same data type. The received data is returned.
+ */
+int TclMPI_Sendrecv(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    return tclmpi_sendrecv(interp, objc, objv, 0);
+}
+
+/*! wrapper for MPI_Sendrecv_replace()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
  *
- * The result is converted back into Tcl objects and passed up as result
- * value to the calling Tcl code. If the MPI call failed, an MPI error
- * message is passed up as result instead.
+ * This function is like TclMPI_Sendrecv(), but the received data is
+ * stored in a copy of the send data with MPI_Sendrecv_replace. This
+ * avoids probing for the size of the incoming message, but the
+ * received message may not have more data items than were sent.
  */
-int TclMPI_Allreduce(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Sendrecv_replace(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
-    Tcl_Obj *result = NULL;
-    const char *opstr;
+    return tclmpi_sendrecv(interp, objc, objv, 1);
+}
+
+/*! wrapper for MPI_Send_init()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function creates a persistent send request for TclMPI. The data
+ * is copied into a native buffer owned by the request, which is used
+ * by every send started with TclMPI_Start() or TclMPI_Startall(), so
+ * that repeated sends of data with the same size do not need to allocate
+ * a request or buffer each time. The number of data items is fixed by
+ * the data passed to this function. Supported data types are tclmpi::auto,
+ * tclmpi::bytes, tclmpi::int and tclmpi::double.
+ *
+ * The command will pass the Tcl string that represents the generated
+ * MPI request to the Tcl interpreter as return value. The request
+ * remains valid until it is released with TclMPI_Request_free().
+ */
+int TclMPI_Send_init(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_req_t *req;
+    Tcl_Obj *sobj;
     MPI_Comm comm;
-    MPI_Op op;
-    int i, type, len, ierr = MPI_SUCCESS;
+    MPI_Datatype mtype;
+    void *data;
+    int dest, tag, type, len, esize, ierr = MPI_SUCCESS;
 
-    if (objc != 5) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <op> <comm>");
+    if (objc != 6) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <dest> <tag> <comm>");
         return TCL_ERROR;
     }
 
-    type = tclmpi_datatype(Tcl_GetString(objv[2]));
+    type = tclmpi_datatype(objv[2]);
     if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
 
-    opstr = Tcl_GetString(objv[3]);
-    comm  = tcl2mpi_comm(Tcl_GetString(objv[4]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
+    comm = tcl2mpi_comm(objv[5]);
+    if (tclmpi_commcheck(interp, comm, objv[0], objv[5]) != TCL_OK) return TCL_ERROR;
 
-    /* special case check for reduction */
-    if (type == TCLMPI_AUTO) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
-        return TCL_ERROR;
-    }
+    if (Tcl_GetIntFromObj(interp, objv[3], &dest) != TCL_OK) return TCL_ERROR;
+    if (Tcl_GetIntFromObj(interp, objv[4], &tag) != TCL_OK) return TCL_ERROR;
 
-    if (tclmpi_get_op(opstr, &op) != TCL_OK) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown reduction operator: ", opstr, NULL);
+    if ((type != TCLMPI_AUTO) && (type != TCLMPI_BYTES) && (type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
+                         " is not yet implemented.", NULL);
         return TCL_ERROR;
     }
+    mtype = tclmpi_mpitype(type);
+    MPI_Type_size(mtype, &esize);
 
-    Tcl_IncrRefCount(objv[1]);
-
-    if (type == TCLMPI_INT) {
-        Tcl_Obj **ilist;
-        int *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (int *)Tcl_Alloc(len * sizeof(int));
-        odata = (int *)Tcl_Alloc(len * sizeof(int));
-        for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Int, ilist[i], idata + i, idata[i]);
-
-        ierr   = MPI_Allreduce(idata, odata, len, MPI_INT, op, comm);
-        result = Tcl_NewListObj(0, NULL);
-        for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(odata[i]));
-        Tcl_Free((char *)idata);
-        Tcl_Free((char *)odata);
-
-    } else if (type == TCLMPI_DOUBLE) {
-        Tcl_Obj **ilist;
-        double *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (double *)Tcl_Alloc(len * sizeof(double));
-        odata = (double *)Tcl_Alloc(len * sizeof(double));
-        for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Double, ilist[i], idata + i, idata[i]);
-
-        ierr   = MPI_Allreduce(idata, odata, len, MPI_DOUBLE, op, comm);
-        result = Tcl_NewListObj(0, NULL);
-        for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewDoubleObj(odata[i]));
-        Tcl_Free((char *)idata);
-        Tcl_Free((char *)odata);
-    } else if (type == TCLMPI_INT_INT) {
-        Tcl_Obj **ilist, **ipair;
-        tclmpi_intint_t *idata, *odata;
-        int plen;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (tclmpi_intint_t *)Tcl_Alloc(len * sizeof(tclmpi_intint_t));
-        odata = (tclmpi_intint_t *)Tcl_Alloc(len * sizeof(tclmpi_intint_t));
-        for (i = 0; i < len; ++i) {
-            if (Tcl_ListObjGetElements(interp, ilist[i], &plen, &ipair) != TCL_OK) return TCL_ERROR;
-            if (plen < 2) {
-                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad list format for loc reduction: ", opstr, NULL);
-                return TCL_ERROR;
-            }
-
-            TCLMPI_CONV_CHECK(Int, ipair[0], &(idata[i].i1), idata[i].i1);
-            if (Tcl_GetIntFromObj(interp, ipair[1], &(idata[i].i2)) != TCL_OK) {
-                Tcl_ResetResult(interp);
-                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad location data for reduction: ", opstr, NULL);
-                return TCL_ERROR;
-            }
-        }
-        ierr   = MPI_Allreduce(idata, odata, len, MPI_2INT, op, comm);
-        result = Tcl_NewListObj(0, NULL);
-        for (i = 0; i < len; ++i) {
-            Tcl_Obj *opair;
-            opair = Tcl_NewListObj(0, NULL);
-            Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i1));
-            Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i2));
-            Tcl_ListObjAppendElement(interp, result, opair);
-        }
-        Tcl_Free((char *)idata);
-        Tcl_Free((char *)odata);
-    } else if (type == TCLMPI_DOUBLE_INT) {
-        Tcl_Obj **ilist, **ipair;
-        tclmpi_dblint_t *idata, *odata;
-        int plen;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (tclmpi_dblint_t *)Tcl_Alloc(len * sizeof(tclmpi_dblint_t));
-        odata = (tclmpi_dblint_t *)Tcl_Alloc(len * sizeof(tclmpi_dblint_t));
-        for (i = 0; i < len; ++i) {
-            if (Tcl_ListObjGetElements(interp, ilist[i], &plen, &ipair) != TCL_OK) return TCL_ERROR;
-            if (plen < 2) {
-                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad list format for loc reduction: ", opstr, NULL);
-                return TCL_ERROR;
-            }
+    sobj = tclmpi_send_obj(interp, comm, objv[1], type, &len, &data);
+    if (sobj == NULL) return TCL_ERROR;
+    Tcl_IncrRefCount(sobj);
 
-            TCLMPI_CONV_CHECK(Double, ipair[0], &(idata[i].d), idata[i].d);
-            if (Tcl_GetIntFromObj(interp, ipair[1], &(idata[i].i)) != TCL_OK) {
-                Tcl_ResetResult(interp);
-                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad location data for reduction: ", opstr, NULL);
-                return TCL_ERROR;
-            }
-        }
-        ierr   = MPI_Allreduce(idata, odata, len, MPI_DOUBLE_INT, op, comm);
-        result = Tcl_NewListObj(0, NULL);
-        for (i = 0; i < len; ++i) {
-            Tcl_Obj *opair;
-            opair = Tcl_NewListObj(0, NULL);
-            Tcl_ListObjAppendElement(interp, opair, Tcl_NewDoubleObj(odata[i].d));
-            Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i));
-            Tcl_ListObjAppendElement(interp, result, opair);
-        }
-        Tcl_Free((char *)idata);
-        Tcl_Free((char *)odata);
-    } else {
-        Tcl_DecrRefCount(objv[1]);
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
-                         " is not yet implemented.", NULL);
+    req = tclmpi_add_req();
+    if (req == NULL) {
+        Tcl_DecrRefCount(sobj);
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+        return TCL_ERROR;
+    }
+    req->type    = type;
+    req->len     = len;
+    req->source  = dest;
+    req->tag     = tag;
+    req->comm    = comm;
+    req->persist = TCLMPI_SEND_INIT;
+    req->data    = Tcl_Alloc((size_t)len * esize + 1);
+    memcpy(req->data, data, (size_t)len * esize);
+    Tcl_DecrRefCount(sobj);
+
+    ierr = MPI_Send_init(req->data, len, mtype, dest, tag, comm, req->req);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_del_req(req);
         return TCL_ERROR;
     }
-    Tcl_DecrRefCount(objv[1]);
-
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
 
-    if (result) Tcl_SetObjResult(interp, result);
+    /* return request handle */
+    Tcl_SetObjResult(interp, tclmpi_req_obj(req));
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Reduce()
+/*! wrapper for MPI_Recv_init()
  * \param nodata ignored
  * \param interp current Tcl interpreter
  * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a reduction function for TclMPI.
- * This operation does not accept the tclmpi::auto data type, also support
- * for types outside of tclmpi::int and tclmpi::double is incomplete.
- * The length of the data is inferred from the data object passed to this
- * function and thus a 'count' argument is not needed.
+ * This function creates a persistent receive request for TclMPI. Unlike
+ * for TclMPI_Irecv() the maximum number of data items has to be given,
+ * since the receive buffer is allocated once and owned by the request.
+ * Every receive started with TclMPI_Start() or TclMPI_Startall() uses
+ * this buffer and TclMPI_Wait() returns a new Tcl object with the data
+ * that was actually received. Supported data types are tclmpi::auto,
+ * tclmpi::bytes, tclmpi::int and tclmpi::double.
  *
- * The result is collected on the process with rank root and converted
- *  back into Tcl objects and passed up as result value to the calling
- * Tcl code. If the MPI call failed an MPI error message is passed up
- * as result instead.
+ * The command will pass the Tcl string that represents the generated
+ * MPI request to the Tcl interpreter as return value. The request
+ * remains valid until it is released with TclMPI_Request_free().
  */
-int TclMPI_Reduce(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Recv_init(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
-    Tcl_Obj *result = NULL;
-    const char *opstr;
+    tclmpi_req_t *req;
     MPI_Comm comm;
-    MPI_Op op;
-    int i, type, root, rank, len, ierr = MPI_SUCCESS;
+    MPI_Datatype mtype;
+    int source, tag, type, len, esize, ierr = MPI_SUCCESS;
 
     if (objc != 6) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <op> <root> <comm>");
+        Tcl_WrongNumArgs(interp, 1, objv, "<type> <count> <source> <tag> <comm>");
         return TCL_ERROR;
     }
 
-    type = tclmpi_datatype(Tcl_GetString(objv[2]));
-    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
-
-    opstr = Tcl_GetString(objv[3]);
-
-    if (Tcl_GetIntFromObj(interp, objv[4], &root) != TCL_OK) return TCL_ERROR;
+    type = tclmpi_datatype(objv[1]);
+    if (tclmpi_typecheck(interp, type, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[5]));
+    comm = tcl2mpi_comm(objv[5]);
     if (tclmpi_commcheck(interp, comm, objv[0], objv[5]) != TCL_OK) return TCL_ERROR;
 
-    /* special case check for reduction */
-    if (type == TCLMPI_AUTO) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": does not support data type ", Tcl_GetString(objv[2]), NULL);
+    if (Tcl_GetIntFromObj(interp, objv[2], &len) != TCL_OK) return TCL_ERROR;
+    if (len < 0) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid count: ", Tcl_GetString(objv[2]), NULL);
         return TCL_ERROR;
     }
 
-    if (tclmpi_get_op(opstr, &op) != TCL_OK) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown reduction operator: ", opstr, NULL);
+    if (strcmp(Tcl_GetString(objv[3]), "tclmpi::any_source") == 0)
+        source = MPI_ANY_SOURCE;
+    else if (Tcl_GetIntFromObj(interp, objv[3], &source) != TCL_OK)
         return TCL_ERROR;
-    }
-
-    ierr = MPI_Comm_rank(comm, &rank);
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
-    Tcl_IncrRefCount(objv[1]);
-
-    if (type == TCLMPI_INT) {
-        Tcl_Obj **ilist;
-        int *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (int *)Tcl_Alloc(len * sizeof(int));
-        if (rank == root)
-            odata = (int *)Tcl_Alloc(len * sizeof(int));
-        else
-            odata = NULL;
-        for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Int, ilist[i], idata + i, idata[i]);
 
-        ierr   = MPI_Reduce(idata, odata, len, MPI_INT, op, root, comm);
-        result = Tcl_NewListObj(0, NULL);
-        if (rank == root)
-            for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(odata[i]));
-        Tcl_Free((char *)idata);
-        if (rank == root) Tcl_Free((char *)odata);
-
-    } else if (type == TCLMPI_DOUBLE) {
-        Tcl_Obj **ilist;
-        double *idata, *odata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (double *)Tcl_Alloc(len * sizeof(double));
-        if (rank == root)
-            odata = (double *)Tcl_Alloc(len * sizeof(double));
-        else
-            odata = NULL;
-        for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Double, ilist[i], idata + i, idata[i]);
-
-        ierr   = MPI_Reduce(idata, odata, len, MPI_DOUBLE, op, root, comm);
-        result = Tcl_NewListObj(0, NULL);
-        if (rank == root)
-            for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewDoubleObj(odata[i]));
-        Tcl_Free((char *)idata);
-        if (rank == root) Tcl_Free((char *)odata);
+    if (strcmp(Tcl_GetString(objv[4]), "tclmpi::any_tag") == 0)
+        tag = MPI_ANY_TAG;
+    else if (Tcl_GetIntFromObj(interp, objv[4], &tag) != TCL_OK)
+        return TCL_ERROR;
 
-    } else if (type == TCLMPI_INT_INT) {
-        Tcl_Obj **ilist, **ipair;
-        tclmpi_intint_t *idata, *odata;
-        int plen;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (tclmpi_intint_t *)Tcl_Alloc(len * sizeof(tclmpi_intint_t));
-        if (rank == root)
-            odata = (tclmpi_intint_t *)Tcl_Alloc(len * sizeof(tclmpi_intint_t));
-        else
-            odata = NULL;
-        for (i = 0; i < len; ++i) {
-            if (Tcl_ListObjGetElements(interp, ilist[i], &plen, &ipair) != TCL_OK) return TCL_ERROR;
-            if (plen < 2) {
-                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad list format for loc reduction: ", opstr, NULL);
-                return TCL_ERROR;
-            }
+    if ((type != TCLMPI_AUTO) && (type != TCLMPI_BYTES) && (type != TCLMPI_INT) && (type != TCLMPI_DOUBLE)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[1]),
+                         " is not yet implemented.", NULL);
+        return TCL_ERROR;
+    }
+    mtype = tclmpi_mpitype(type);
+    MPI_Type_size(mtype, &esize);
 
-            TCLMPI_CONV_CHECK(Int, ipair[0], &(idata[i].i1), idata[i].i1);
-            if (Tcl_GetIntFromObj(interp, ipair[1], &(idata[i].i2)) != TCL_OK) {
-                Tcl_ResetResult(interp);
-                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad location data for reduction: ", opstr, NULL);
-                return TCL_ERROR;
-            }
-        }
-        ierr   = MPI_Reduce(idata, odata, len, MPI_2INT, op, root, comm);
-        result = Tcl_NewListObj(0, NULL);
-        if (rank == root) {
-            for (i = 0; i < len; ++i) {
-                Tcl_Obj *opair;
-                opair = Tcl_NewListObj(0, NULL);
-                Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i1));
-                Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i2));
-                Tcl_ListObjAppendElement(interp, result, opair);
-            }
-        }
-        Tcl_Free((char *)idata);
-        if (rank == root) Tcl_Free((char *)odata);
+    req = tclmpi_add_req();
+    if (req == NULL) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+        return TCL_ERROR;
+    }
+    req->type    = type;
+    req->len     = len;
+    req->source  = source;
+    req->tag     = tag;
+    req->comm    = comm;
+    req->persist = TCLMPI_RECV_INIT;
+    req->data    = Tcl_Alloc((size_t)len * esize + 1);
+
+    ierr = MPI_Recv_init(req->data, len, mtype, source, tag, comm, req->req);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_del_req(req);
+        return TCL_ERROR;
+    }
 
-    } else if (type == TCLMPI_DOUBLE_INT) {
-        Tcl_Obj **ilist, **ipair;
-        tclmpi_dblint_t *idata, *odata;
-        int plen;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (tclmpi_dblint_t *)Tcl_Alloc(len * sizeof(tclmpi_dblint_t));
-        if (rank == root)
-            odata = (tclmpi_dblint_t *)Tcl_Alloc(len * sizeof(tclmpi_dblint_t));
-        else
-            odata = NULL;
-        for (i = 0; i < len; ++i) {
-            if (Tcl_ListObjGetElements(interp, ilist[i], &plen, &ipair) != TCL_OK) return TCL_ERROR;
-            if (plen < 2) {
-                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad list format for loc reduction: ", opstr, NULL);
-                return TCL_ERROR;
-            }
+    /* return request handle */
+    Tcl_SetObjResult(interp, tclmpi_req_obj(req));
+    return TCL_OK;
+}
 
-            TCLMPI_CONV_CHECK(Double, ipair[0], &(idata[i].d), idata[i].d);
-            if (Tcl_GetIntFromObj(interp, ipair[1], &(idata[i].i)) != TCL_OK) {
-                Tcl_ResetResult(interp);
-                Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": bad location data for reduction: ", opstr, NULL);
-                return TCL_ERROR;
-            }
-        }
-        ierr   = MPI_Reduce(idata, odata, len, MPI_DOUBLE_INT, op, root, comm);
-        result = Tcl_NewListObj(0, NULL);
-        if (rank == root) {
-            for (i = 0; i < len; ++i) {
-                Tcl_Obj *opair;
-                opair = Tcl_NewListObj(0, NULL);
-                Tcl_ListObjAppendElement(interp, opair, Tcl_NewDoubleObj(odata[i].d));
-                Tcl_ListObjAppendElement(interp, opair, Tcl_NewIntObj(odata[i].i));
-                Tcl_ListObjAppendElement(interp, result, opair);
-            }
+/*! Look up an inactive persistent request and check new data for it
+ * \param interp current Tcl interpreter
+ * \param cmd Tcl object with the name of the calling command
+ * \param obj Tcl object with the request handle
+ * \param data Tcl object with new data for a send request or NULL
+ * \param sobj pointer to location for storing the object holding the new data or NULL
+ * \param sdata pointer to location for storing the address of the new data
+ * \return pointer to the request or NULL on errors
+ *
+ * New send data must have the same number of data items as the data
+ * that the request was created with, since the size of a persistent
+ * request cannot be changed. Data for receive requests is ignored.
+ * The new data is only converted here and copied into the send buffer
+ * with tclmpi_start_data, so that a list of requests can be checked
+ * completely before any of them is changed. A request that is already
+ * marked as listed is rejected as a duplicate.
+ */
+static tclmpi_req_t *tclmpi_start_req(Tcl_Interp *interp, Tcl_Obj *cmd, Tcl_Obj *obj, Tcl_Obj *data, Tcl_Obj **sobj,
+                                      void **sdata)
+{
+    tclmpi_req_t *req;
+    int len;
+
+    *sobj = NULL;
+    req   = tclmpi_find_req(obj);
+    if ((req == NULL) || !req->persist) {
+        Tcl_AppendResult(interp, Tcl_GetString(cmd), ": not a persistent request: ", Tcl_GetString(obj), NULL);
+        return NULL;
+    }
+    if (req->active) {
+        Tcl_AppendResult(interp, Tcl_GetString(cmd), ": request is already active: ", Tcl_GetString(obj), NULL);
+        return NULL;
+    }
+    if (req->listed) {
+        Tcl_AppendResult(interp, Tcl_GetString(cmd), ": request is listed more than once: ", Tcl_GetString(obj),
+                         NULL);
+        return NULL;
+    }
+
+    /* the data is held by a private object, so that converting other data cannot invalidate it */
+    if ((data != NULL) && (req->persist == TCLMPI_SEND_INIT)) {
+        *sobj = tclmpi_hold_obj(interp, req->comm, data, req->type, &len, sdata);
+        if (*sobj == NULL) return NULL;
+        Tcl_IncrRefCount(*sobj);
+        if (len != req->len) {
+            Tcl_DecrRefCount(*sobj);
+            *sobj = NULL;
+            Tcl_AppendResult(interp, Tcl_GetString(cmd), ": number of data items does not match request: ",
+                             Tcl_GetString(obj), NULL);
+            return NULL;
         }
-        Tcl_Free((char *)idata);
-        if (rank == root) Tcl_Free((char *)odata);
-    } else {
-        Tcl_DecrRefCount(objv[1]);
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
-                         " is not yet implemented.", NULL);
+    }
+    return req;
+}
+
+/*! Copy new data into the send buffer of a persistent request
+ * \param req pointer to the request
+ * \param sobj object holding the new data from tclmpi_start_req or NULL
+ * \param sdata address of the new data
+ *
+ * The reference to sobj taken by tclmpi_start_req is released.
+ */
+static void tclmpi_start_data(tclmpi_req_t *req, Tcl_Obj *sobj, void *sdata)
+{
+    int esize;
+
+    if (sobj == NULL) return;
+    MPI_Type_size(tclmpi_mpitype(req->type), &esize);
+    memcpy(req->data, sdata, (size_t)req->len * esize);
+    Tcl_DecrRefCount(sobj);
+}
+
+/*! wrapper for MPI_Start()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function starts a persistent request created with TclMPI_Send_init()
+ * or TclMPI_Recv_init(). For send requests, the optional data argument
+ * replaces the contents of the send buffer before the send is started.
+ * The request has to be completed with TclMPI_Wait() before it can be
+ * started again.
+ */
+int TclMPI_Start(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_req_t *req;
+    Tcl_Obj *sobj;
+    void *sdata;
+    int ierr;
+
+    if ((objc < 2) || (objc > 3)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<request> ?data?");
         return TCL_ERROR;
     }
-    Tcl_DecrRefCount(objv[1]);
 
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    req = tclmpi_start_req(interp, objv[0], objv[1], (objc > 2) ? objv[2] : NULL, &sobj, &sdata);
+    if (req == NULL) return TCL_ERROR;
+    tclmpi_start_data(req, sobj, sdata);
 
-    if (result) Tcl_SetObjResult(interp, result);
+    ierr = MPI_Start(req->req);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    req->active = 1;
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Send()
+/*! wrapper for MPI_Startall()
  * \param nodata ignored
  * \param interp current Tcl interpreter
  * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a blocking send operation for TclMPI.
- * The length of the data is inferred from the data object passed to this
- * function and thus a 'count' argument is not needed.
- * In the case of tclmpi::auto, the string representation of the send data
- * is directly passed to MPI_Send() otherwise a copy is made and data converted.
- *
- * If the MPI call failed, an MPI error message is passed up as result
- * instead and a Tcl error is indicated, otherwise nothing is returned.
+ * This function starts a list of persistent requests with a single call
+ * to MPI_Startall(). The optional second argument is a list with new data
+ * for each request, like for TclMPI_Start(). Its elements are ignored for
+ * receive requests. All requests and data are checked before any send
+ * buffer is changed, so no request is started or modified if any of them
+ * is invalid, listed more than once, or has invalid data.
  */
-int TclMPI_Send(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Startall(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
-    MPI_Comm comm;
-    int i, dest, tag, type, len, ierr = MPI_SUCCESS;
+    tclmpi_req_t **reqs;
+    MPI_Request *mpireqs;
+    Tcl_Obj **robjs, **dobjs = NULL, **sobjs;
+    void **sdata;
+    size_t size[4];
+    char *ptr;
+    int i, j, num, ndata = 0, ierr = MPI_SUCCESS;
 
-    if (objc != 6) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <dest> <tag> <comm>");
+    if ((objc < 2) || (objc > 3)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<requests> ?data?");
         return TCL_ERROR;
     }
 
-    type = tclmpi_datatype(Tcl_GetString(objv[2]));
-    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+    if (Tcl_ListObjGetElements(interp, objv[1], &num, &robjs) != TCL_OK) return TCL_ERROR;
+    if ((objc > 2) && (Tcl_ListObjGetElements(interp, objv[2], &ndata, &dobjs) != TCL_OK)) return TCL_ERROR;
+    if ((objc > 2) && (ndata != num)) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": number of data items must match number of requests",
+                         NULL);
+        return TCL_ERROR;
+    }
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[5]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[5]) != TCL_OK) return TCL_ERROR;
+    /* all arrays are carved from the scratch buffer */
+    size[0] = TCLMPI_SCRATCH_ALIGN(num * sizeof(tclmpi_req_t *));
+    size[1] = TCLMPI_SCRATCH_ALIGN(num * sizeof(MPI_Request));
+    size[2] = TCLMPI_SCRATCH_ALIGN(num * sizeof(Tcl_Obj *));
+    size[3] = TCLMPI_SCRATCH_ALIGN(num * sizeof(void *));
+    ptr     = (char *)tclmpi_scratch(interp, size[0] + size[1] + size[2] + size[3]);
+    reqs    = (tclmpi_req_t **)ptr;
+    mpireqs = (MPI_Request *)(ptr += size[0]);
+    sobjs   = (Tcl_Obj **)(ptr += size[1]);
+    sdata   = (void **)(ptr += size[2]);
+
+    /* check all requests and their data first and mark them to detect duplicates */
+    for (i = 0; i < num; ++i) {
+        reqs[i] = tclmpi_start_req(interp, objv[0], robjs[i], dobjs ? dobjs[i] : NULL, &sobjs[i], &sdata[i]);
+        if (reqs[i] == NULL) break;
+        reqs[i]->listed = 1;
+    }
+    for (j = 0; j < i; ++j) reqs[j]->listed = 0;
 
-    if (Tcl_GetIntFromObj(interp, objv[3], &dest) != TCL_OK) return TCL_ERROR;
-    if (Tcl_GetIntFromObj(interp, objv[4], &tag) != TCL_OK) return TCL_ERROR;
+    /* an invalid request has already been reported */
+    if (i < num) {
+        for (j = 0; j < i; ++j) {
+            if (sobjs[j]) Tcl_DecrRefCount(sobjs[j]);
+        }
+        return TCL_ERROR;
+    }
 
-    Tcl_IncrRefCount(objv[1]);
-    if (type == TCLMPI_AUTO) {
-        char *idata;
-        idata = Tcl_GetStringFromObj(objv[1], &len);
-        ierr  = MPI_Send(idata, len, MPI_CHAR, dest, tag, comm);
-    } else if (type == TCLMPI_INT) {
-        Tcl_Obj **ilist;
-        int *idata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (int *)Tcl_Alloc(len * sizeof(int));
-        for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Int, ilist[i], idata + i, idata[i]);
-
-        ierr = MPI_Send(idata, len, MPI_INT, dest, tag, comm);
-        Tcl_Free((char *)idata);
-    } else if (type == TCLMPI_DOUBLE) {
-        Tcl_Obj **ilist;
-        double *idata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (double *)Tcl_Alloc(len * sizeof(double));
-        for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Double, ilist[i], idata + i, idata[i]);
+    for (i = 0; i < num; ++i) {
+        tclmpi_start_data(reqs[i], sobjs[i], sdata[i]);
+        mpireqs[i] = *reqs[i]->req;
+    }
+    ierr = MPI_Startall(num, mpireqs);
+    for (i = 0; i < num; ++i) {
+        *reqs[i]->req   = mpireqs[i];
+        reqs[i]->active = (ierr == MPI_SUCCESS);
+    }
 
-        ierr = MPI_Send(idata, len, MPI_DOUBLE, dest, tag, comm);
-        Tcl_Free((char *)idata);
-    } else {
-        Tcl_DecrRefCount(objv[1]);
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
-                         " is not yet implemented.", NULL);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    return TCL_OK;
+}
+
+/*! wrapper for MPI_Request_free()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function releases a persistent request and its buffer. Active
+ * requests have to be completed with TclMPI_Wait() first, since the
+ * buffer is still in use by MPI.
+ */
+int TclMPI_Request_free(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_req_t *req;
+    int ierr;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<request>");
         return TCL_ERROR;
     }
-    Tcl_DecrRefCount(objv[1]);
 
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    req = tclmpi_find_req(objv[1]);
+    if ((req == NULL) || !req->persist) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": not a persistent request: ", Tcl_GetString(objv[1]), NULL);
+        return TCL_ERROR;
+    }
+    if (req->active) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": request is still active: ", Tcl_GetString(objv[1]), NULL);
+        return TCL_ERROR;
+    }
 
+    ierr = MPI_Request_free(req->req);
+    tclmpi_del_req(req);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Isend()
+/*! wrapper for MPI_Wait()
  * \param nodata ignored
  * \param interp current Tcl interpreter
  * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a non-blocking send operation for TclMPI.
- * The length of the data is inferred from the data object passed to
- * this function and thus a 'count' argument is not needed.  Unlike for
- * the blocking TclMPI_Send, in the case of tclmpi::auto as data a
- * copy has to be made since the string representation of the send data
- * might be invalidated during the send. The command generates a new
- * tclmpi_req_t communication request via tclmpi_add_req and the
- * pointers to the data buffer and the MPI_Request info generated by
- * MPI_Isend is stored in this request list entry for later perusal, see
- * TclMPI_Wait. The generated string label representing this request
- * will be passed on to the calling program as Tcl result. If the MPI
- * call failed, an MPI error message is passed up as result instead and
- * a Tcl error is indicated.
+ * This function implements a wrapper around MPI_Wait for TclMPI. Due to
+ * the design decisions in TclMPI, it works a bit different than
+ * MPI_Wait, particularly for non-blocking receive requests. As
+ * explained in the TclMPI_Irecv documentation, the corresponding
+ * MPI_Irecv may not yet have been posted, so we have to first inspect
+ * the tclmpi_req_t object, if the receive still needs to be posted. If
+ * yes, then we need to do about the same procedure as for a blocking
+ * receive, i.e. call MPI_Mprobe to determine the size of the receive
+ * buffer, allocate that buffer and then post the receive (see
+ * tclmpi_post_req). Then we call MPI_Wait to wait until the non-blocking
+ * receive is completed and the result is passed to the calling procedure
+ * as Tcl return value by tclmpi_req_done, which also removes the
+ * tclmpi_req_t entry from its translation table.
+ *
+ * For non-blocking send requests, MPI_Wait is called and after completion
+ * the send buffer freed and the tclmpi_req_t data released. For
+ * non-blocking collectives, the result was set up as receive buffer when
+ * the request was posted, so it is passed up after MPI_Wait completed.
+ * Persistent requests are not released by MPI_Wait, so that they can be
+ * started again. Waiting on an inactive persistent request returns
+ * immediately, for a persistent receive the received data is copied
+ * from the buffer of the request into a new Tcl object.
+ * The MPI spec allows to call MPI_Wait on non-existing MPI_Requests
+ * and just return immediately. This is handled directly without calling
+ * MPI_Wait, since we cache all generated MPI requests.
  */
-int TclMPI_Isend(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Wait(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
+    Tcl_Obj *result;
+    const char *statvar;
     tclmpi_req_t *req;
-    const char *reqlabel;
-    void *data;
-    MPI_Comm comm;
-    int i, dest, tag, type, len, ierr = MPI_SUCCESS;
+    MPI_Status status;
+    int ierr = MPI_SUCCESS;
 
-    if (objc != 6) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<data> <type> <dest> <tag> <comm>");
+    if ((objc < 2) || (objc > 3)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<request> ?status?");
         return TCL_ERROR;
     }
 
-    type = tclmpi_datatype(Tcl_GetString(objv[2]));
-    if (tclmpi_typecheck(interp, type, objv[0], objv[2]) != TCL_OK) return TCL_ERROR;
+    req = tclmpi_find_req(objv[1]);
+    /* waiting on an illegal request returns immediately */
+    if (req == NULL) return TCL_OK;
+    /* as does waiting on an inactive persistent request */
+    if (req->persist && !req->active) return TCL_OK;
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[5]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[5]) != TCL_OK) return TCL_ERROR;
+    if (objc > 2)
+        statvar = Tcl_GetString(objv[2]);
+    else
+        statvar = NULL;
 
-    if (Tcl_GetIntFromObj(interp, objv[3], &dest) != TCL_OK) return TCL_ERROR;
-    if (Tcl_GetIntFromObj(interp, objv[4], &tag) != TCL_OK) return TCL_ERROR;
+    /* receive not posted so far, we can wait for the message now */
+    if (tclmpi_req_deferred(req)) {
+        ierr = tclmpi_post_req(req, 1);
+        if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+            tclmpi_del_req(req);
+            return TCL_ERROR;
+        }
+    }
 
-    reqlabel = tclmpi_add_req();
-    if (reqlabel == NULL) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+    memset(&status, 0, sizeof(status));
+    ierr = MPI_Wait(req->req, &status);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        if (req->persist) req->active = 0;
         return TCL_ERROR;
     }
-    req       = tclmpi_find_req(reqlabel);
-    req->type = type;
-    data      = NULL;
-    req->len  = TCLMPI_INVALID;
-    req->comm = comm;
+    if (statvar != NULL) tclmpi_set_status(interp, statvar, &status);
 
-    Tcl_IncrRefCount(objv[1]);
-    if (type == TCLMPI_AUTO) {
-        char *idata;
-        data  = Tcl_GetStringFromObj(objv[1], &len);
-        idata = Tcl_Alloc(len);
-        memcpy(idata, data, len);
-        req->data = idata;
-        ierr      = MPI_Isend(idata, len, MPI_CHAR, dest, tag, comm, req->req);
-        data      = idata;
-    } else if (type == TCLMPI_INT) {
-        Tcl_Obj **ilist;
-        int *idata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (int *)Tcl_Alloc(len * sizeof(int));
-        for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Int, ilist[i], idata + i, idata[i]);
-
-        req->data = idata;
-        ierr      = MPI_Isend(idata, len, MPI_INT, dest, tag, comm, req->req);
-        data      = idata;
-    } else if (type == TCLMPI_DOUBLE) {
-        Tcl_Obj **ilist;
-        double *idata;
-        if (Tcl_ListObjGetElements(interp, objv[1], &len, &ilist) != TCL_OK) return TCL_ERROR;
-        idata = (double *)Tcl_Alloc(len * sizeof(double));
-        for (i = 0; i < len; ++i) TCLMPI_CONV_CHECK(Double, ilist[i], idata + i, idata[i]);
+    /* success. pass on the result and clean up. */
+    result = tclmpi_req_done(req, &status);
+    Tcl_SetObjResult(interp, result);
+    Tcl_DecrRefCount(result);
+    return TCL_OK;
+}
 
-        req->data = idata;
-        ierr      = MPI_Isend(idata, len, MPI_DOUBLE, dest, tag, comm, req->req);
-        data      = idata;
-    } else {
-        Tcl_DecrRefCount(objv[1]);
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": support for data type ", Tcl_GetString(objv[2]),
-                         " is not yet implemented.", NULL);
+/*! wrapper for MPI_Waitall()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function waits for the completion of all requests in a list
+ * with a single call to MPI_Waitall, so that MPI can progress all of
+ * them together. Non-blocking receives that were not yet posted, are
+ * posted as soon as a matching message is pending, while MPI_Testsome
+ * keeps progressing the other requests. The results are returned as a
+ * list in the order of the requests and are the same as for TclMPI_Wait().
+ * If a status variable name is given, it is set to a list of status
+ * lists in the format of ``array get``, but only then those are created.
+ */
+int TclMPI_Waitall(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_reqlist_t list;
+    Tcl_Obj *result, *stat;
+    const char *statvar;
+    int i, j, count, ierr = MPI_SUCCESS;
+
+    if ((objc < 2) || (objc > 3)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<requests> ?status?");
         return TCL_ERROR;
     }
-    Tcl_DecrRefCount(objv[1]);
 
+    if (tclmpi_get_reqs(interp, objv[1], &list) != TCL_OK) return TCL_ERROR;
+    statvar = (objc > 2) ? Tcl_GetString(objv[2]) : NULL;
+
+    while (tclmpi_post_reqs(list.num, list.reqs, list.mpireqs, &ierr) > 0) {
+        ierr = MPI_Testsome(list.num, list.mpireqs, &count, list.index, list.status);
+        if (ierr != MPI_SUCCESS) break;
+        for (j = 0; (count != MPI_UNDEFINED) && (j < count); ++j)
+            tclmpi_reqs_done(&list, list.index[j], list.status + j, statvar != NULL);
+    }
+    if (ierr == MPI_SUCCESS) ierr = MPI_Waitall(list.num, list.mpireqs, list.status);
     if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
-        if (data) Tcl_Free((char *)data);
-        tclmpi_del_req(req);
+        tclmpi_free_reqs(&list);
         return TCL_ERROR;
     }
 
-    /* return request handle */
-    Tcl_SetObjResult(interp, Tcl_NewStringObj(reqlabel, -1));
+    result = Tcl_NewListObj(0, NULL);
+    stat   = Tcl_NewListObj(0, NULL);
+    for (i = 0; i < list.num; ++i) {
+        tclmpi_reqs_done(&list, i, list.status + i, statvar != NULL);
+        Tcl_ListObjAppendElement(interp, result, list.result[i]);
+        if (statvar != NULL) Tcl_ListObjAppendElement(interp, stat, list.stat[i]);
+    }
+    tclmpi_free_reqs(&list);
+
+    Tcl_IncrRefCount(stat);
+    if (statvar != NULL) Tcl_SetVar2Ex(interp, statvar, NULL, stat, 0);
+    Tcl_DecrRefCount(stat);
+    Tcl_SetObjResult(interp, result);
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Recv()
+/*! wrapper for MPI_Waitany()
  * \param nodata ignored
  * \param interp current Tcl interpreter
  * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a blocking receive operation for TclMPI.
- * Since the length of the data object is supposed to be automatically
- * adjusted to the amount of data being sent, this function will first
- * call MPI_Probe to identify the amount of storage needed from the
- * MPI_Status object that is populated by MPI_Probe. Then a temporary
- * receive buffer is allocated and then converted back to Tcl objects
- * according to the data type passed to the receive command. Due to this
- * deviation from the MPI C bindings a 'count' argument is not needed.
- * This command returns the received data to the calling procedure. If
- * the MPI call failed, an MPI error message is passed up as result
- * instead and a Tcl error is indicated.
+ * This function waits until any one of the requests in a list is
+ * completed and returns a list with its index in the list of requests
+ * and its result, which is the same as for TclMPI_Wait(). This way, e.g.
+ * a master process can service whichever worker responds first. Deferred
+ * non-blocking receives are handled as in TclMPI_Waitall(). If there are
+ * no active requests in the list, the index is -1 and the result empty.
  */
-int TclMPI_Recv(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Waitany(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
+    tclmpi_reqlist_t list;
     Tcl_Obj *result;
     const char *statvar;
-    MPI_Comm comm;
     MPI_Status status;
-    int i, source, tag, type, len, ierr = MPI_SUCCESS;
-    memset(&status, 0, sizeof(MPI_Status));
+    int idx, flag, ierr = MPI_SUCCESS;
 
-    if ((objc < 5) || (objc > 6)) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<type> <source> <tag> <comm> ?status?");
+    if ((objc < 2) || (objc > 3)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<requests> ?status?");
         return TCL_ERROR;
     }
 
-    type = tclmpi_datatype(Tcl_GetString(objv[1]));
-    if (tclmpi_typecheck(interp, type, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
-
-    comm = tcl2mpi_comm(Tcl_GetString(objv[4]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
-
-    if (strcmp(Tcl_GetString(objv[2]), "tclmpi::any_source") == 0)
-        source = MPI_ANY_SOURCE;
-    else if (Tcl_GetIntFromObj(interp, objv[2], &source) != TCL_OK)
-        return TCL_ERROR;
+    if (tclmpi_get_reqs(interp, objv[1], &list) != TCL_OK) return TCL_ERROR;
+    statvar = (objc > 2) ? Tcl_GetString(objv[2]) : NULL;
 
-    if (strcmp(Tcl_GetString(objv[3]), "tclmpi::any_tag") == 0)
-        tag = MPI_ANY_TAG;
-    else if (Tcl_GetIntFromObj(interp, objv[3], &tag) != TCL_OK)
+    memset(&status, 0, sizeof(status));
+    idx = MPI_UNDEFINED;
+    for (;;) {
+        if (tclmpi_post_reqs(list.num, list.reqs, list.mpireqs, &ierr) == 0) {
+            if (ierr == MPI_SUCCESS) ierr = MPI_Waitany(list.num, list.mpireqs, &idx, &status);
+            break;
+        }
+        ierr = MPI_Testany(list.num, list.mpireqs, &idx, &flag, &status);
+        if ((ierr != MPI_SUCCESS) || (flag && (idx != MPI_UNDEFINED))) break;
+    }
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_free_reqs(&list);
         return TCL_ERROR;
+    }
 
-    if (objc > 5)
-        statvar = Tcl_GetString(objv[5]);
-    else
-        statvar = NULL;
+    result = Tcl_NewListObj(0, NULL);
+    if (idx == MPI_UNDEFINED) {
+        Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(-1));
+        Tcl_ListObjAppendElement(interp, result, Tcl_NewObj());
+    } else {
+        tclmpi_reqs_done(&list, idx, &status, 0);
+        Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(idx));
+        Tcl_ListObjAppendElement(interp, result, list.result[idx]);
+    }
+    tclmpi_free_reqs(&list);
 
-    len = 0;
-    if (type == TCLMPI_AUTO) {
-        char *idata;
-        MPI_Probe(source, tag, comm, &status);
-        MPI_Get_count(&status, MPI_CHAR, &len);
-        idata  = Tcl_Alloc(len);
-        tag    = status.MPI_TAG;
-        source = status.MPI_SOURCE;
-
-        if (statvar != NULL)
-            ierr = MPI_Recv(idata, len, MPI_CHAR, source, tag, comm, &status);
-        else
-            ierr = MPI_Recv(idata, len, MPI_CHAR, source, tag, comm, MPI_STATUS_IGNORE);
+    /* variable traces may run scripts, so the list must be released first */
+    if ((idx != MPI_UNDEFINED) && (statvar != NULL)) tclmpi_set_status(interp, statvar, &status);
 
-        result = Tcl_NewStringObj(idata, len);
-        Tcl_Free(idata);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
 
-    } else if (type == TCLMPI_INT) {
-        int *idata;
-        MPI_Probe(source, tag, comm, &status);
-        MPI_Get_count(&status, MPI_INT, &len);
-        idata  = (int *)Tcl_Alloc(len * sizeof(int));
-        tag    = status.MPI_TAG;
-        source = status.MPI_SOURCE;
+/*! wrapper for MPI_Waitsome()
+ * \param nodata ignored
+ * \param interp current Tcl interpreter
+ * \param objc number of argument objects
+ * \param objv list of argument object
+ * \return TCL_OK or TCL_ERROR
+ *
+ * This function waits until at least one of the requests in a list is
+ * completed and returns a list with an element for each of the requests
+ * completed, in the order of their completion. Each element is a list
+ * with the index of the request and its result, as for TclMPI_Waitany().
+ * If a status variable name is given, it is set to a list of status
+ * lists in the same order. If there are no active requests in the list,
+ * the result is empty.
+ */
+int TclMPI_Waitsome(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    tclmpi_reqlist_t list;
+    Tcl_Obj *result, *stat, *item;
+    const char *statvar;
+    int i, idx, count, ierr = MPI_SUCCESS;
 
-        if (statvar != NULL)
-            ierr = MPI_Recv(idata, len, MPI_INT, source, tag, comm, &status);
-        else
-            ierr = MPI_Recv(idata, len, MPI_INT, source, tag, comm, MPI_STATUS_IGNORE);
+    if ((objc < 2) || (objc > 3)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<requests> ?status?");
+        return TCL_ERROR;
+    }
 
-        result = Tcl_NewListObj(0, NULL);
-        for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(idata[i]));
-        Tcl_Free((char *)idata);
-
-    } else if (type == TCLMPI_DOUBLE) {
-        double *idata;
-        MPI_Probe(source, tag, comm, &status);
-        MPI_Get_count(&status, MPI_DOUBLE, &len);
-        idata  = (double *)Tcl_Alloc(len * sizeof(double));
-        tag    = status.MPI_TAG;
-        source = status.MPI_SOURCE;
-
-        if (statvar != NULL)
-            ierr = MPI_Recv(idata, len, MPI_DOUBLE, source, tag, comm, &status);
-        else
-            ierr = MPI_Recv(idata, len, MPI_DOUBLE, source, tag, comm, MPI_STATUS_IGNORE);
+    if (tclmpi_get_reqs(interp, objv[1], &list) != TCL_OK) return TCL_ERROR;
+    statvar = (objc > 2) ? Tcl_GetString(objv[2]) : NULL;
 
-        result = Tcl_NewListObj(0, NULL);
-        for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewDoubleObj(idata[i]));
-        Tcl_Free((char *)idata);
-    } else {
-        result = Tcl_NewListObj(0, NULL);
+    count = MPI_UNDEFINED;
+    for (;;) {
+        if (tclmpi_post_reqs(list.num, list.reqs, list.mpireqs, &ierr) == 0) {
+            if (ierr == MPI_SUCCESS) ierr = MPI_Waitsome(list.num, list.mpireqs, &count, list.index, list.status);
+            break;
+        }
+        ierr = MPI_Testsome(list.num, list.mpireqs, &count, list.index, list.status);
+        if ((ierr != MPI_SUCCESS) || ((count != MPI_UNDEFINED) && (count > 0))) break;
+    }
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_free_reqs(&list);
+        return TCL_ERROR;
     }
 
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
-
-    if (statvar != NULL) {
-        Tcl_Obj *var;
-        int len_char, len_int, len_double;
-        MPI_Get_count(&status, MPI_CHAR, &len_char);
-        MPI_Get_count(&status, MPI_INT, &len_int);
-        MPI_Get_count(&status, MPI_DOUBLE, &len_double);
-        Tcl_UnsetVar(interp, statvar, 0);
-        var = Tcl_NewStringObj(statvar, -1);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status.MPI_SOURCE), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status.MPI_TAG), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status.MPI_ERROR), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_char), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_char), 0);
+    result = Tcl_NewListObj(0, NULL);
+    stat   = Tcl_NewListObj(0, NULL);
+    for (i = 0; (count != MPI_UNDEFINED) && (i < count); ++i) {
+        idx = list.index[i];
+        tclmpi_reqs_done(&list, idx, list.status + i, statvar != NULL);
+        item = Tcl_NewListObj(0, NULL);
+        Tcl_ListObjAppendElement(interp, item, Tcl_NewIntObj(idx));
+        Tcl_ListObjAppendElement(interp, item, list.result[idx]);
+        Tcl_ListObjAppendElement(interp, result, item);
+        if (statvar != NULL) Tcl_ListObjAppendElement(interp, stat, list.stat[idx]);
     }
+    tclmpi_free_reqs(&list);
 
+    Tcl_IncrRefCount(stat);
+    if (statvar != NULL) Tcl_SetVar2Ex(interp, statvar, NULL, stat, 0);
+    Tcl_DecrRefCount(stat);
     Tcl_SetObjResult(interp, result);
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Iecv()
+/*! wrapper for MPI_Test()
  * \param nodata ignored
  * \param interp current Tcl interpreter
  * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a non-blocking receive operation for TclMPI.
- * Since the length of the data object is supposed to be automatically
- * adjusted to the amount of data being sent, this function needs to be
- * more complex than just a simple wrapper around the corresponding MPI
- * C bindings. It will first call tclmpi_add_req to generate a new entry
- * to the list of registered MPI requests. It will then call MPI_Iprobe
- * to see if a matching send is already in progress and thus the
- * necessary amount of storage required can be inferred from the
- * MPI_Status object that is populated by MPI_Iprobe. If yes, a
- * temporary receive buffer is allocated and the non-blocking receive is
- * posted and all information is transferred to the tclmpi_req_t
- * object. If not, only the arguments of the receive call are registered
- * in the request object for later use.  The command will pass the Tcl
- * string that represents the generated MPI request to the Tcl
- * interpreter as return value. If the MPI call failed, an MPI error
- * message is passed up as result instead and a Tcl error is indicated.
+ * This function checks whether a request is completed without blocking.
+ * It returns a list with a flag (1 or 0) and the result of the request,
+ * which is the same as for TclMPI_Wait() and empty while the request is
+ * not completed. Like for TclMPI_Wait(), a completed request is released
+ * and the status variable is only set on completion. A non-blocking
+ * receive that was not yet posted, is posted when a matching message is
+ * pending, otherwise it is not completed.
  */
-int TclMPI_Irecv(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Test(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
+    Tcl_Obj *result, *data;
     tclmpi_req_t *req;
-    const char *reqlabel;
-    MPI_Comm comm;
     MPI_Status status;
-    int source, tag, type, pending, len, ierr = MPI_SUCCESS;
-
-    if ((objc < 4) || (objc > 5)) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<type> <source> <tag> <comm>");
-        return TCL_ERROR;
-    }
-
-    type = tclmpi_datatype(Tcl_GetString(objv[1]));
-    if (tclmpi_typecheck(interp, type, objv[0], objv[1]) != TCL_OK) return TCL_ERROR;
+    int flag, ierr = MPI_SUCCESS;
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[4]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[4]) != TCL_OK) return TCL_ERROR;
-
-    if (strcmp(Tcl_GetString(objv[2]), "tclmpi::any_source") == 0)
-        source = MPI_ANY_SOURCE;
-    else if (Tcl_GetIntFromObj(interp, objv[2], &source) != TCL_OK)
-        return TCL_ERROR;
-
-    if (strcmp(Tcl_GetString(objv[3]), "tclmpi::any_tag") == 0)
-        tag = MPI_ANY_TAG;
-    else if (Tcl_GetIntFromObj(interp, objv[3], &tag) != TCL_OK)
-        return TCL_ERROR;
-
-    reqlabel = tclmpi_add_req();
-    if (reqlabel == NULL) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": cannot create TclMPI request handle.", NULL);
+    if ((objc < 2) || (objc > 3)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<request> ?status?");
         return TCL_ERROR;
     }
-    req         = tclmpi_find_req(reqlabel);
-    req->type   = type;
-    req->source = source;
-    req->tag    = tag;
-    req->comm   = comm;
-    req->data   = NULL;
-    /* indicate receive */
-    req->len = TCLMPI_NONE;
-
-    pending = len = 0;
 
-    /* check if a matching send is already posted and ready to be received */
-    ierr = MPI_Iprobe(source, tag, comm, &pending, &status);
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
-        tclmpi_del_req(req);
-        return TCL_ERROR;
+    result = Tcl_NewListObj(0, NULL);
+    req    = tclmpi_find_req(objv[1]);
+    flag   = 1;
+
+    /* illegal and inactive persistent requests are completed */
+    if ((req == NULL) || (req->persist && !req->active)) {
+        Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(flag));
+        Tcl_ListObjAppendElement(interp, result, Tcl_NewObj());
+        Tcl_SetObjResult(interp, result);
+        return TCL_OK;
     }
 
-    if (pending != 0) {
-        if (type == TCLMPI_AUTO) {
-            char *idata;
-            MPI_Get_count(&status, MPI_CHAR, &len);
-            idata     = Tcl_Alloc(len);
-            req->data = idata;
-            req->len  = len;
-            tag       = status.MPI_TAG;
-            source    = status.MPI_SOURCE;
-            ierr      = MPI_Irecv(idata, len, MPI_CHAR, source, tag, comm, req->req);
-
-        } else if (type == TCLMPI_INT) {
-            int *idata;
-            MPI_Get_count(&status, MPI_INT, &len);
-            idata     = (int *)Tcl_Alloc(len * sizeof(int));
-            req->data = idata;
-            req->len  = len;
-            tag       = status.MPI_TAG;
-            source    = status.MPI_SOURCE;
-            ierr      = MPI_Irecv(idata, len, MPI_INT, source, tag, comm, req->req);
-
-        } else if (type == TCLMPI_DOUBLE) {
-            double *idata;
-            MPI_Get_count(&status, MPI_DOUBLE, &len);
-            idata     = (double *)Tcl_Alloc(len * sizeof(double));
-            req->data = idata;
-            req->len  = len;
-            tag       = status.MPI_TAG;
-            source    = status.MPI_SOURCE;
-            ierr      = MPI_Irecv(idata, len, MPI_DOUBLE, source, tag, comm, req->req);
-        }
-
-        /* posting the receive failed */
+    if (tclmpi_req_deferred(req)) {
+        ierr = tclmpi_post_req(req, 0);
         if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
-            Tcl_Free((char *)req->data);
+            Tcl_IncrRefCount(result);
+            Tcl_DecrRefCount(result);
             tclmpi_del_req(req);
             return TCL_ERROR;
         }
     }
 
-    /* return request handle */
-    Tcl_SetObjResult(interp, Tcl_NewStringObj(reqlabel, -1));
+    memset(&status, 0, sizeof(status));
+    if (tclmpi_req_deferred(req))
+        flag = 0;
+    else
+        ierr = MPI_Test(req->req, &flag, &status);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        Tcl_IncrRefCount(result);
+        Tcl_DecrRefCount(result);
+        if (req->persist) req->active = 0;
+        return TCL_ERROR;
+    }
+
+    Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(flag));
+    if (flag) {
+        if (objc > 2) tclmpi_set_status(interp, Tcl_GetString(objv[2]), &status);
+        data = tclmpi_req_done(req, &status);
+        Tcl_ListObjAppendElement(interp, result, data);
+        Tcl_DecrRefCount(data);
+    } else
+        Tcl_ListObjAppendElement(interp, result, Tcl_NewObj());
+    Tcl_SetObjResult(interp, result);
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Probe()
+/*! wrapper for MPI_Testall()
  * \param nodata ignored
  * \param interp current Tcl interpreter
  * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a blocking probe operation for TclMPI.
- * Argument flags for source, tag, and communicator are translated
- * into their native MPI equivalents and then MPI_Probe called.
- *
- * Similar to MPI_Probe, generating a status object to inspect the
- * pending receive is optional. If desired, the argument is taken
- * as a variable name which will then be generated as associative
- * array with several entries similar to what MPI_Status contains.
- * Those are source, tag, error status and count, however this is
- * directly provided as multiple entries translated to char, int
- * and double data types (COUNT_CHAR, COUNT_INT, COUNT_DOUBLE).
+ * This function checks whether all requests in a list are completed
+ * without blocking. It returns a list with a flag (1 or 0) and the list
+ * of results as for TclMPI_Waitall(), which is empty unless all requests
+ * are completed. Only then the requests are released and the status
+ * variable is set. A request is not completed while it is a deferred
+ * non-blocking receive without a pending message.
  */
-int TclMPI_Probe(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Testall(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
+    tclmpi_reqlist_t list;
+    Tcl_Obj *result, *data, *stat;
     const char *statvar;
-    MPI_Comm comm;
-    MPI_Status status;
-    int source, tag, ierr = MPI_SUCCESS;
+    int i, flag, ierr = MPI_SUCCESS;
 
-    if ((objc < 4) || (objc > 5)) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<source> <tag> <comm> ?status?");
+    if ((objc < 2) || (objc > 3)) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<requests> ?status?");
         return TCL_ERROR;
     }
 
-    if (strcmp(Tcl_GetString(objv[1]), "tclmpi::any_source") == 0)
-        source = MPI_ANY_SOURCE;
-    else if (Tcl_GetIntFromObj(interp, objv[1], &source) != TCL_OK)
-        return TCL_ERROR;
-
-    if (strcmp(Tcl_GetString(objv[2]), "tclmpi::any_tag") == 0)
-        tag = MPI_ANY_TAG;
-    else if (Tcl_GetIntFromObj(interp, objv[2], &tag) != TCL_OK)
-        return TCL_ERROR;
+    if (tclmpi_get_reqs(interp, objv[1], &list) != TCL_OK) return TCL_ERROR;
+    statvar = (objc > 2) ? Tcl_GetString(objv[2]) : NULL;
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[3]));
-    if (tclmpi_commcheck(interp, comm, objv[0], objv[3]) != TCL_OK) return TCL_ERROR;
-    if (comm == MPI_COMM_NULL) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid communicator: ", Tcl_GetString(objv[3]), NULL);
+    /* MPI_Testall would complete the posted requests even if
+       some receives still have to be posted, so skip it then */
+    flag = 0;
+    if ((tclmpi_post_reqs(list.num, list.reqs, list.mpireqs, &ierr) == 0) && (ierr == MPI_SUCCESS))
+        ierr = MPI_Testall(list.num, list.mpireqs, &flag, list.status);
+    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
+        tclmpi_free_reqs(&list);
         return TCL_ERROR;
     }
 
-    if (objc > 4)
-        statvar = Tcl_GetString(objv[4]);
-    else
-        statvar = NULL;
-
-    if (statvar != NULL) {
-        Tcl_Obj *var;
-        int len_char, len_int, len_double;
-
-        ierr = MPI_Probe(source, tag, comm, &status);
-
-        MPI_Get_count(&status, MPI_CHAR, &len_char);
-        MPI_Get_count(&status, MPI_INT, &len_int);
-        MPI_Get_count(&status, MPI_DOUBLE, &len_double);
-        Tcl_UnsetVar(interp, statvar, 0);
-        var = Tcl_NewStringObj(statvar, -1);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status.MPI_SOURCE), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status.MPI_TAG), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status.MPI_ERROR), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_char), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_char), 0);
-    } else
-        ierr = MPI_Probe(source, tag, comm, MPI_STATUS_IGNORE);
-
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    result = Tcl_NewListObj(0, NULL);
+    data   = Tcl_NewListObj(0, NULL);
+    stat   = Tcl_NewListObj(0, NULL);
+    for (i = 0; flag && (i < list.num); ++i) {
+        tclmpi_reqs_done(&list, i, list.status + i, statvar != NULL);
+        Tcl_ListObjAppendElement(interp, data, list.result[i]);
+        if (statvar != NULL) Tcl_ListObjAppendElement(interp, stat, list.stat[i]);
+    }
+    tclmpi_free_reqs(&list);
 
+    Tcl_IncrRefCount(stat);
+    if (flag && (statvar != NULL)) Tcl_SetVar2Ex(interp, statvar, NULL, stat, 0);
+    Tcl_DecrRefCount(stat);
+    Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(flag));
+    Tcl_ListObjAppendElement(interp, result, data);
+    Tcl_SetObjResult(interp, result);
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Iprobe()
+/*! register a script for the arrival of MPI messages
  * \param nodata ignored
  * \param interp current Tcl interpreter
  * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a non-blocking probe operation for TclMPI.
- * Argument flags for source, tag, and communicator are translated
- * into their native MPI equivalents and then MPI_Iprobe called.
- *
- * Similar to MPI_Probe, generating a status object to inspect the
- * pending receive is optional. If desired, the argument is taken
- * as a variable name which will then be generated as associative
- * array with several entries similar to what MPI_Status contains.
- * Those are source, tag, error status and count, however this is
- * directly provided as multiple entries translated to char, int
- * and double data types (COUNT_CHAR, COUNT_INT, COUNT_DOUBLE).
- *
- * The status flag in MPI_Iprobe that returns true if a request is
- * pending will be passed to the calling routine as Tcl result.
+ * This function works similar to the fileevent command in Tcl for
+ * messages matching source rank, tag and communicator. While such a
+ * message is pending, the script is evaluated from the Tcl event loop
+ * with the source rank and tag of the message appended as arguments.
+ * The script is expected to receive the message, otherwise it will be
+ * evaluated again. MPI is polled through a Tcl event source, see
+ * tclmpi_event_check. An empty script removes the handler and without
+ * a script argument the current script is returned.
  */
-int TclMPI_Iprobe(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Onmessage(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
-    const char *statvar;
+    tclmpi_tsd_t *tsd = TCLMPI_TSD;
+    tclmpi_handler_t *h, **prev;
     MPI_Comm comm;
-    MPI_Status status;
-    int source, tag, ierr, pending;
+    int source, tag;
 
     if ((objc < 4) || (objc > 5)) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<source> <tag> <comm> ?status?");
+        Tcl_WrongNumArgs(interp, 1, objv, "<source> <tag> <comm> ?script?");
         return TCL_ERROR;
     }
 
@@ -2673,283 +7163,134 @@ int TclMPI_Iprobe(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *cons
     else if (Tcl_GetIntFromObj(interp, objv[2], &tag) != TCL_OK)
         return TCL_ERROR;
 
-    comm = tcl2mpi_comm(Tcl_GetString(objv[3]));
+    comm = tcl2mpi_comm(objv[3]);
     if (tclmpi_commcheck(interp, comm, objv[0], objv[3]) != TCL_OK) return TCL_ERROR;
-    if (comm == MPI_COMM_NULL) {
-        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": invalid communicator: ", Tcl_GetString(objv[3]), NULL);
-        return TCL_ERROR;
-    }
 
-    if (objc > 4)
-        statvar = Tcl_GetString(objv[4]);
-    else
-        statvar = NULL;
-    pending = 0;
+    for (prev = &tsd->msg_handlers; (h = *prev) != NULL; prev = &h->next) {
+        if ((h->interp == interp) && (h->source == source) && (h->tag == tag) && (h->comm == comm)) break;
+    }
 
-    if (statvar != NULL) {
-        Tcl_Obj *var;
-        int len_char, len_int, len_double;
+    /* query the current script */
+    if (objc == 4) {
+        if (h != NULL) Tcl_SetObjResult(interp, h->script);
+        return TCL_OK;
+    }
 
-        ierr = MPI_Iprobe(source, tag, comm, &pending, &status);
+    /* remove the handler */
+    if (Tcl_GetCharLength(objv[4]) == 0) {
+        if (h != NULL) {
+            *prev = h->next;
+            Tcl_DeleteEvents(tclmpi_event_delete, h);
+            Tcl_DecrRefCount(h->script);
+            Tcl_Free((char *)h);
+        }
+        return TCL_OK;
+    }
 
-        MPI_Get_count(&status, MPI_CHAR, &len_char);
-        MPI_Get_count(&status, MPI_INT, &len_int);
-        MPI_Get_count(&status, MPI_DOUBLE, &len_double);
-        Tcl_UnsetVar(interp, statvar, 0);
-        var = Tcl_NewStringObj(statvar, -1);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status.MPI_SOURCE), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status.MPI_TAG), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status.MPI_ERROR), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_char), 0);
-        Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_char), 0);
+    if (h == NULL) {
+        h = (tclmpi_handler_t *)Tcl_Alloc(sizeof(tclmpi_handler_t));
+        memset(h, 0, sizeof(tclmpi_handler_t));
+        h->interp         = interp;
+        h->source         = source;
+        h->tag            = tag;
+        h->comm           = comm;
+        h->next           = tsd->msg_handlers;
+        tsd->msg_handlers = h;
     } else
-        ierr = MPI_Iprobe(source, tag, comm, &pending, MPI_STATUS_IGNORE);
-
-    if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
-
-    Tcl_SetObjResult(interp, Tcl_NewIntObj(pending));
+        Tcl_DecrRefCount(h->script);
+    h->script = objv[4];
+    Tcl_IncrRefCount(h->script);
+    tclmpi_event_start();
     return TCL_OK;
 }
 
-/*! wrapper for MPI_Wait()
+/*! register a script for the completion of an MPI request
  * \param nodata ignored
  * \param interp current Tcl interpreter
  * \param objc number of argument objects
  * \param objv list of argument object
  * \return TCL_OK or TCL_ERROR
  *
- * This function implements a wrapper around MPI_Wait for TclMPI. Due to
- * the design decisions in TclMPI, it works a bit different than
- * MPI_Wait, particularly for non-blocking receive requests. As
- * explained in the TclMPI_Irecv documentation, the corresponding
- * MPI_Irecv may not yet have been posted, so we have to first inspect
- * the tclmpi_req_t object, if the receive still needs to be posted. If
- * yes, then we need to do about the same procedure as for a blocking
- * receive, i.e. call MPI_Probe to determine the size of the receive
- * buffer, allocate that buffer and then post a blocking receive. If
- * no, we call MPI_Wait to wait until the non-blocking receive is
- * completed. In both cases, the result needed to be converted to Tcl
- * objects and passed to the calling procedure as Tcl return
- * values. Then the receive buffers can be deleted and the tclmpi_req_t
- * entry removed from it translation table.
- *
- * For non-blocking send requests, MPI_Wait is called and after completion
- * the send buffer freed and the tclmpi_req_t data released.
- * The MPI spec allows to call MPI_Wait on non-existing MPI_Requests
- * and just return immediately. This is handled directly without calling
- * MPI_Wait, since we cache all generated MPI requests.
+ * When the request is completed, the script is evaluated once from the
+ * Tcl event loop with the request and the data that TclMPI_Wait() would
+ * return appended as arguments. The request is released before, same as
+ * by TclMPI_Wait(). If the request fails, the error message is appended
+ * as third argument and the request is kept. Completion is detected through the Tcl event source
+ * with MPI_Testsome, see tclmpi_event_check. An empty script removes the
+ * handler and without a script argument the current script is returned.
  */
-int TclMPI_Wait(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+int TclMPI_Oncomplete(ClientData nodata, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
-    Tcl_Obj *result;
-    const char *statvar;
+    tclmpi_tsd_t *tsd = TCLMPI_TSD;
+    tclmpi_handler_t *h, **prev;
     tclmpi_req_t *req;
-    MPI_Status status;
-    int ierr = MPI_SUCCESS;
 
     if ((objc < 2) || (objc > 3)) {
-        Tcl_WrongNumArgs(interp, 1, objv, "<request> ?status?");
+        Tcl_WrongNumArgs(interp, 1, objv, "<request> ?script?");
         return TCL_ERROR;
     }
 
-    req = tclmpi_find_req(Tcl_GetString(objv[1]));
-    /* waiting on an illegal request returns immediately */
-    if (req == NULL) return TCL_OK;
-
-    if (objc > 2)
-        statvar = Tcl_GetString(objv[2]);
-    else
-        statvar = NULL;
-
-    /* handle non-blocking send requests */
-    if (req->len == TCLMPI_INVALID) {
-        if (statvar != NULL) {
-            Tcl_Obj *var;
-            int len_char, len_int, len_double;
-
-            memset(&status, 0, sizeof(status));
-            ierr = MPI_Wait(req->req, &status);
-
-            MPI_Get_count(&status, MPI_CHAR, &len_char);
-            MPI_Get_count(&status, MPI_INT, &len_int);
-            MPI_Get_count(&status, MPI_DOUBLE, &len_double);
-            Tcl_UnsetVar(interp, statvar, 0);
-            var = Tcl_NewStringObj(statvar, -1);
-            Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status.MPI_SOURCE), 0);
-            Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status.MPI_TAG), 0);
-            Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status.MPI_ERROR), 0);
-            Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
-            Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_int), 0);
-            Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_double), 0);
-        } else
-            ierr = MPI_Wait(req->req, MPI_STATUS_IGNORE);
+    req = tclmpi_find_req(objv[1]);
+    if (req == NULL) {
+        Tcl_AppendResult(interp, Tcl_GetString(objv[0]), ": unknown request: ", Tcl_GetString(objv[1]), NULL);
+        return TCL_ERROR;
+    }
 
-        if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
+    for (prev = &tsd->req_handlers; (h = *prev) != NULL; prev = &h->next) {
+        if (h->id == req->id) break;
+    }
 
-        /* success. clean up. */
-        Tcl_Free((char *)req->data);
-        tclmpi_del_req(req);
-        Tcl_SetResult(interp, NULL, NULL);
+    /* query the current script */
+    if (objc == 2) {
+        if (h != NULL) Tcl_SetObjResult(interp, h->script);
         return TCL_OK;
+    }
 
-    } else {
-        /* handle receive */
-        int i, len, tag, source;
-
-        /* already posted non-blocking receive */
-        if (req->data != NULL) {
-
-            if (statvar != NULL) {
-                Tcl_Obj *var;
-                int len_char, len_int, len_double;
-
-                memset(&status, 0, sizeof(status));
-                ierr = MPI_Wait(req->req, &status);
-                MPI_Get_count(&status, MPI_CHAR, &len_char);
-                MPI_Get_count(&status, MPI_INT, &len_int);
-                MPI_Get_count(&status, MPI_DOUBLE, &len_double);
-                Tcl_UnsetVar(interp, statvar, 0);
-                var = Tcl_NewStringObj(statvar, -1);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status.MPI_SOURCE), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status.MPI_TAG), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status.MPI_ERROR), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_int), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_double), 0);
-            } else
-                ierr = MPI_Wait(req->req, MPI_STATUS_IGNORE);
-
-            if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) return TCL_ERROR;
-
-            if (req->type == TCLMPI_AUTO) {
-                result = Tcl_NewStringObj((const char *)req->data, req->len);
-            } else if (req->type == TCLMPI_INT) {
-                int *idata = (int *)req->data;
-                result     = Tcl_NewListObj(0, NULL);
-                for (i = 0; i < req->len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(idata[i]));
-            } else if (req->type == TCLMPI_DOUBLE) {
-                double *idata = (double *)req->data;
-                result        = Tcl_NewListObj(0, NULL);
-                for (i = 0; i < req->len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewDoubleObj(idata[i]));
-            } else {
-                result = Tcl_NewListObj(0, NULL);
-            }
-            Tcl_SetObjResult(interp, result);
-
-        } else {
-
-            /* receive not posted so far, we can do a blocking receive now */
-            if (req->type == TCLMPI_AUTO) {
-                char *idata;
-
-                memset(&status, 0, sizeof(status));
-                MPI_Probe(req->source, req->tag, req->comm, &status);
-                MPI_Get_count(&status, MPI_CHAR, &len);
-                idata  = Tcl_Alloc(len);
-                tag    = status.MPI_TAG;
-                source = status.MPI_SOURCE;
-
-                if (statvar != NULL)
-                    ierr = MPI_Recv(idata, len, MPI_CHAR, source, tag, req->comm, &status);
-                else
-                    ierr = MPI_Recv(idata, len, MPI_CHAR, source, tag, req->comm, MPI_STATUS_IGNORE);
-
-                req->data = idata;
-                result    = Tcl_NewStringObj(idata, len);
-
-            } else if (req->type == TCLMPI_INT) {
-                int *idata;
-
-                memset(&status, 0, sizeof(status));
-                MPI_Probe(req->source, req->tag, req->comm, &status);
-                MPI_Get_count(&status, MPI_INT, &len);
-                idata  = (int *)Tcl_Alloc(len * sizeof(int));
-                tag    = status.MPI_TAG;
-                source = status.MPI_SOURCE;
-
-                if (statvar != NULL)
-                    ierr = MPI_Recv(idata, len, MPI_INT, source, tag, req->comm, &status);
-                else
-                    ierr = MPI_Recv(idata, len, MPI_INT, source, tag, req->comm, MPI_STATUS_IGNORE);
-
-                result = Tcl_NewListObj(0, NULL);
-                for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewIntObj(idata[i]));
-                req->data = idata;
-
-            } else if (req->type == TCLMPI_DOUBLE) {
-                double *idata;
-
-                memset(&status, 0, sizeof(status));
-                MPI_Probe(req->source, req->tag, req->comm, &status);
-                MPI_Get_count(&status, MPI_DOUBLE, &len);
-                idata  = (double *)Tcl_Alloc(len * sizeof(double));
-                tag    = status.MPI_TAG;
-                source = status.MPI_SOURCE;
-
-                if (statvar != NULL)
-                    ierr = MPI_Recv(idata, len, MPI_DOUBLE, source, tag, req->comm, &status);
-                else
-                    ierr = MPI_Recv(idata, len, MPI_DOUBLE, source, tag, req->comm, MPI_STATUS_IGNORE);
-
-                result = Tcl_NewListObj(0, NULL);
-                for (i = 0; i < len; ++i) Tcl_ListObjAppendElement(interp, result, Tcl_NewDoubleObj(idata[i]));
-                req->data = idata;
-            } else {
-                result = Tcl_NewListObj(0, NULL);
-            }
-
-            if (tclmpi_errcheck(interp, ierr, objv[0]) != TCL_OK) {
-                if (req->data) Tcl_Free((char *)req->data);
-                tclmpi_del_req(req);
-                return TCL_ERROR;
-            }
-
-            if (statvar != NULL) {
-                Tcl_Obj *var;
-                int len_char, len_int, len_double;
-                MPI_Get_count(&status, MPI_CHAR, &len_char);
-                MPI_Get_count(&status, MPI_INT, &len_int);
-                MPI_Get_count(&status, MPI_DOUBLE, &len_double);
-                Tcl_UnsetVar(interp, statvar, 0);
-                var = Tcl_NewStringObj(statvar, -1);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_SOURCE", -1), Tcl_NewIntObj(status.MPI_SOURCE), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_TAG", -1), Tcl_NewIntObj(status.MPI_TAG), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("MPI_ERROR", -1), Tcl_NewIntObj(status.MPI_ERROR), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_CHAR", -1), Tcl_NewIntObj(len_char), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_INT", -1), Tcl_NewIntObj(len_int), 0);
-                Tcl_ObjSetVar2(interp, var, Tcl_NewStringObj("COUNT_DOUBLE", -1), Tcl_NewIntObj(len_double), 0);
-            }
-            Tcl_SetObjResult(interp, result);
+    /* remove the handler */
+    if (Tcl_GetCharLength(objv[2]) == 0) {
+        if (h != NULL) {
+            *prev = h->next;
+            Tcl_DecrRefCount(h->script);
+            Tcl_Free((char *)h);
         }
-
-        /* success. clean up. */
-        Tcl_Free((char *)req->data);
-        tclmpi_del_req(req);
         return TCL_OK;
     }
+
+    if (h == NULL) {
+        h = (tclmpi_handler_t *)Tcl_Alloc(sizeof(tclmpi_handler_t));
+        memset(h, 0, sizeof(tclmpi_handler_t));
+        h->id             = req->id;
+        h->next           = tsd->req_handlers;
+        tsd->req_handlers = h;
+    } else
+        Tcl_DecrRefCount(h->script);
+    h->interp = interp;
+    h->script = objv[2];
+    Tcl_IncrRefCount(h->script);
+    tclmpi_event_start();
+    return TCL_OK;
 }
+
 /*!
  * @}
  */
 
-/*! initialize TclMPI extensions and do one time init
- * \param interp pointer to current Tcl interpreter
+/*! Initialize the communicator map list with the predefined communicators
  *
- * This hooks up the commands provided by TclMPI into the provided
- * interpreter and also initializes the predefined communicators
- * tclmpi::comm_world, tclmpi::comm_self, and tclmpi::comm_null and its
- * corresponding MPI counterparts.
+ * The list is created with entries for tclmpi::comm_world, tclmpi::comm_self,
+ * and tclmpi::comm_null and their corresponding MPI counterparts.
+ * Must be called with tclmpi_comm_mutex held.
  */
-static void tclmpi_init_api(Tcl_Interp *interp)
+static void tclmpi_init_comms()
 {
     char *label;
     tclmpi_comm_t *comm;
 
-    /* add world, self, and null communicator to translation table */
     comm        = (tclmpi_comm_t *)Tcl_Alloc(sizeof(tclmpi_comm_t));
     comm->next  = NULL;
     comm->valid = 1;
+    comm->rank  = -1;
+    comm->size  = -1;
     comm->comm  = MPI_COMM_WORLD;
     label       = (char *)Tcl_Alloc(TCLMPI_LABEL_SIZE);
     strncpy(label, "tclmpi::comm_world", TCLMPI_LABEL_SIZE);
@@ -2959,6 +7300,8 @@ static void tclmpi_init_api(Tcl_Interp *interp)
     comm        = (tclmpi_comm_t *)Tcl_Alloc(sizeof(tclmpi_comm_t));
     comm->next  = NULL;
     comm->valid = 1;
+    comm->rank  = -1;
+    comm->size  = -1;
     comm->comm  = MPI_COMM_SELF;
     label       = (char *)Tcl_Alloc(TCLMPI_LABEL_SIZE);
     strncpy(label, "tclmpi::comm_self", TCLMPI_LABEL_SIZE);
@@ -2968,6 +7311,8 @@ static void tclmpi_init_api(Tcl_Interp *interp)
     comm        = (tclmpi_comm_t *)Tcl_Alloc(sizeof(tclmpi_comm_t));
     comm->next  = NULL;
     comm->valid = 1;
+    comm->rank  = -1;
+    comm->size  = -1;
     comm->comm  = MPI_COMM_NULL;
     label       = (char *)Tcl_Alloc(TCLMPI_LABEL_SIZE);
     strncpy(label, "tclmpi::comm_null", TCLMPI_LABEL_SIZE);
@@ -2975,8 +7320,50 @@ static void tclmpi_init_api(Tcl_Interp *interp)
     first_comm->next->next = comm;
     last_comm              = comm;
     memset(&MPI_COMM_INVALID, 0xff, sizeof(MPI_Comm));
+}
+
+/*! initialize TclMPI extensions and do one time init
+ * \param interp pointer to current Tcl interpreter
+ *
+ * This hooks up the commands provided by TclMPI into the provided
+ * interpreter and attaches its private state. When the first interpreter
+ * loads TclMPI, it also initializes the predefined communicators with
+ * tclmpi_init_comms and the request table.
+ */
+static void tclmpi_init_api(Tcl_Interp *interp)
+{
+    tclmpi_interp_t *state;
+
+    /* attach the per interpreter state */
+    state               = (tclmpi_interp_t *)Tcl_Alloc(sizeof(tclmpi_interp_t));
+    state->conv_handler = TCLMPI_ERROR;
+    state->scratch      = NULL;
+    state->scratch_size = 0;
+    Tcl_SetAssocData(interp, TCLMPI_ASSOC_KEY, tclmpi_interp_delete, state);
+
+    /* add world, self, and null communicator to translation table.
+       this is done only once, since the table is shared by all
+       interpreters and threads that load TclMPI. */
+    Tcl_MutexLock(&tclmpi_comm_mutex);
+    if (first_comm == NULL) tclmpi_init_comms();
+    Tcl_MutexUnlock(&tclmpi_comm_mutex);
+    Tcl_MutexLock(&tclmpi_req_mutex);
+    if (!tclmpi_req_init) {
+        Tcl_InitHashTable(&tclmpi_req_table, TCL_ONE_WORD_KEYS);
+        tclmpi_req_init = 1;
+    }
+    Tcl_MutexUnlock(&tclmpi_req_mutex);
+
+    /* types of numbers that can be read without conversion */
+    tclmpi_int_objtype    = Tcl_GetObjType("int");
+    tclmpi_double_objtype = Tcl_GetObjType("double");
+#if TCL_MAJOR_VERSION < 9
+    tclmpi_list_objtype = Tcl_GetObjType("list");
+#endif
 
     Tcl_CreateObjCommand(interp, "tclmpi::init", TclMPI_Init, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::query_thread", TclMPI_Query_thread, (ClientData)NULL,
+                         (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::initialized", TclMPI_Initialized, (ClientData)NULL,
                          (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::conv_set", TclMPI_Conv_set, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
@@ -2992,16 +7379,53 @@ static void tclmpi_init_api(Tcl_Interp *interp)
     Tcl_CreateObjCommand(interp, "tclmpi::bcast", TclMPI_Bcast, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::allreduce", TclMPI_Allreduce, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::reduce", TclMPI_Reduce, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::scan", TclMPI_Scan, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::exscan", TclMPI_Exscan, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::reduce_scatter_block", TclMPI_Reduce_scatter_block, (ClientData)NULL,
+                         (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::scatter", TclMPI_Scatter, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::allgather", TclMPI_Allgather, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::gather", TclMPI_Gather, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::scatterv", TclMPI_Scatterv, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::allgatherv", TclMPI_Allgatherv, (ClientData)NULL,
+                         (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::gatherv", TclMPI_Gatherv, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::alltoall", TclMPI_Alltoall, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::alltoallv", TclMPI_Alltoallv, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+#if MPI_VERSION >= 3
+    Tcl_CreateObjCommand(interp, "tclmpi::ibarrier", TclMPI_Ibarrier, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::ibcast", TclMPI_Ibcast, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::iallreduce", TclMPI_Iallreduce, (ClientData)NULL,
+                         (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::ireduce", TclMPI_Ireduce, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::iallgather", TclMPI_Iallgather, (ClientData)NULL,
+                         (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::igather", TclMPI_Igather, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+#endif
     Tcl_CreateObjCommand(interp, "tclmpi::send", TclMPI_Send, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::isend", TclMPI_Isend, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::recv", TclMPI_Recv, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::irecv", TclMPI_Irecv, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::probe", TclMPI_Probe, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::iprobe", TclMPI_Iprobe, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::sendrecv", TclMPI_Sendrecv, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::sendrecv_replace", TclMPI_Sendrecv_replace, (ClientData)NULL,
+                         (Tcl_CmdDeleteProc *)NULL);
     Tcl_CreateObjCommand(interp, "tclmpi::wait", TclMPI_Wait, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::waitall", TclMPI_Waitall, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::waitany", TclMPI_Waitany, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::waitsome", TclMPI_Waitsome, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::test", TclMPI_Test, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::testall", TclMPI_Testall, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::onmessage", TclMPI_Onmessage, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::oncomplete", TclMPI_Oncomplete, (ClientData)NULL,
+                         (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::send_init", TclMPI_Send_init, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::recv_init", TclMPI_Recv_init, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::start", TclMPI_Start, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::startall", TclMPI_Startall, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+    Tcl_CreateObjCommand(interp, "tclmpi::request_free", TclMPI_Request_free, (ClientData)NULL,
+                         (Tcl_CmdDeleteProc *)NULL);
 }
 
 /*! register the package as a plugin with the Tcl interpreter
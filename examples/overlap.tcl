@@ -0,0 +1,100 @@
+#!/usr/bin/tclsh
+# benchmark for overlapping communication with computation.
+# rank 0 sends a large message to rank 1 with non-blocking calls while
+# both ranks compute for as long as the transfer alone takes. without
+# a progress thread, many MPI libraries only move the data once the
+# script calls tclmpi::wait. compare the output of:
+#   mpirun -np 2 tclsh overlap.tcl
+#   mpirun -np 2 tclsh overlap.tcl 100
+
+package require tclmpi
+
+set tv microseconds
+set master 0
+
+# parse command line
+set progress 0
+if {[llength $argv] > 0} {
+    set progress [lindex $argv 0]
+}
+if {![string is integer -strict $progress] || ($progress < 0)} {
+    puts {usage: overlap.tcl [<progress interval in microseconds>]}
+    exit 1
+}
+
+# initialize MPI, with a progress thread if requested
+if {$progress > 0} {
+    ::tclmpi::init -progress $progress
+} else {
+    ::tclmpi::init
+}
+
+set comm tclmpi::comm_world
+set size [::tclmpi::comm_size $comm]
+set rank [::tclmpi::comm_rank $comm]
+
+if {$size != 2} {
+    if {$rank == $master} {puts "overlap.tcl needs to be run with 2 processes"}
+    ::tclmpi::finalize
+    exit 1
+}
+
+# busy loop that does not call into MPI
+proc compute {usec} {
+    set tend [expr {[clock microseconds] + $usec}]
+    set x 0.0
+    while {[clock microseconds] < $tend} {
+        for {set i 0} {$i < 100} {incr i} {set x [expr {$x + sin($i)}]}
+    }
+    return $x
+}
+
+# post the transfer, compute for the given time, and wait for it
+proc transfer {data num usec} {
+    global rank comm
+    if {$rank == 0} {
+        set req [::tclmpi::isend $data tclmpi::bytes 1 0 $comm]
+    } else {
+        set req [::tclmpi::irecv tclmpi::bytes 0 0 $comm -maxcount $num]
+    }
+    if {$usec > 0} {compute $usec}
+    ::tclmpi::wait $req
+}
+
+if {$rank == $master} {
+    if {$progress > 0} {
+        puts "progress thread interval: $progress us"
+    } else {
+        puts "no progress thread"
+    }
+    puts [format "%10s %12s %12s %12s %10s" bytes "comm/us" "compute/us" "both/us" "overlap"]
+}
+
+for {set num 65536} {$num <= 67108864} {set num [expr {$num*4}]} {
+    set data [string repeat x $num]
+    # warm up
+    transfer $data $num 0
+
+    # communication only
+    ::tclmpi::barrier $comm
+    set tstart [clock $tv]
+    transfer $data $num 0
+    set tcomm [::tclmpi::allreduce [expr {[clock $tv]-$tstart}] tclmpi::int tclmpi::max $comm]
+
+    # communication overlapped with computation of the same length
+    ::tclmpi::barrier $comm
+    set tstart [clock $tv]
+    transfer $data $num $tcomm
+    set tboth [::tclmpi::allreduce [expr {[clock $tv]-$tstart}] tclmpi::int tclmpi::max $comm]
+
+    # fraction of the communication time hidden behind the computation
+    set overlap [expr {100.0*(2*$tcomm - $tboth)/$tcomm}]
+    if {$overlap < 0.0} {set overlap 0.0}
+    if {$rank == $master} {
+        puts [format "%10d %12d %12d %12d %9.1f%%" $num $tcomm $tcomm $tboth $overlap]
+    }
+}
+
+# close out TclMPI
+::tclmpi::finalize
+exit 0
@@ -0,0 +1,63 @@
+#!/usr/bin/tclsh
+# benchmark for handling many outstanding non-blocking requests.
+# the time per request should not depend on the number of requests.
+
+package require tclmpi
+
+set tv microseconds
+set master 0
+
+# initialize MPI
+::tclmpi::init
+
+set comm tclmpi::comm_self
+set rank [::tclmpi::comm_rank tclmpi::comm_world]
+
+# parse command line
+set maxnum 100000
+if {[llength $argv] > 0} {
+    set maxnum [lindex $argv 0]
+}
+if {![string is integer -strict $maxnum] || ($maxnum < 10)} {
+    if {$rank == $master} {puts {usage: reqbench.tcl [<max requests>]}}
+    ::tclmpi::finalize
+    exit 1
+}
+
+if {$rank == $master} {
+    puts [format "%10s %12s %12s %12s" requests "isend/us" "irecv/us" "wait/us"]
+}
+
+for {set num 10} {$num <= $maxnum} {set num [expr {$num*10}]} {
+    set sreq {}
+    set rreq {}
+
+    # post all sends to ourselves, then all receives
+    set tstart [clock $tv]
+    for {set i 0} {$i < $num} {incr i} {
+        lappend sreq [::tclmpi::isend $i tclmpi::int 0 $i $comm]
+    }
+    set tsend [expr {double([clock $tv]-$tstart)/$num}]
+
+    set tstart [clock $tv]
+    for {set i 0} {$i < $num} {incr i} {
+        lappend rreq [::tclmpi::irecv tclmpi::int 0 $i $comm]
+    }
+    set trecv [expr {double([clock $tv]-$tstart)/$num}]
+
+    # complete requests in the order they were posted
+    set tstart [clock $tv]
+    foreach s $sreq r $rreq {
+        ::tclmpi::wait $s
+        ::tclmpi::wait $r
+    }
+    set twait [expr {double([clock $tv]-$tstart)/$num/2}]
+
+    if {$rank == $master} {
+        puts [format "%10d %12.3f %12.3f %12.3f" $num $tsend $trecv $twait]
+    }
+}
+
+# close out TclMPI
+::tclmpi::finalize
+exit 0
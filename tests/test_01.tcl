@@ -39,10 +39,25 @@ run_error  [list ::tclmpi::finalize] \
 run_return [list ::tclmpi::initialized] 0
 run_error  [list ::tclmpi::initialized 0] \
     [list "wrong # args: should be \"::tclmpi::initialized\""]
+run_error  [list ::tclmpi::query_thread] \
+    {{calling ::tclmpi::query_thread outside of tclmpi::init and tclmpi::finalize is erroneous.}}
 run_error  [list ::tclmpi::init 0] \
-    [list "wrong # args: should be \"::tclmpi::init\""]
-run_return [list ::tclmpi::init] {}
+    [list "wrong # args: should be \"::tclmpi::init ?-thread <level>? ?-progress <usec>? ?-convthreads <num>?\""]
+run_error  [list ::tclmpi::init -thread] \
+    [list "wrong # args: should be \"::tclmpi::init ?-thread <level>? ?-progress <usec>? ?-convthreads <num>?\""]
+run_error  [list ::tclmpi::init -progress] \
+    [list "wrong # args: should be \"::tclmpi::init ?-thread <level>? ?-progress <usec>? ?-convthreads <num>?\""]
+run_error  [list ::tclmpi::init -progress 100 -thread] \
+    [list "wrong # args: should be \"::tclmpi::init ?-thread <level>? ?-progress <usec>? ?-convthreads <num>?\""]
+run_error  [list ::tclmpi::init -progress xx] {{expected integer but got "xx"}}
+run_error  [list ::tclmpi::init -progress 0] {{::tclmpi::init: invalid progress interval: 0}}
+run_error  [list ::tclmpi::init -thread xxx] {{::tclmpi::init: unknown thread level: xxx}}
+run_error  [list ::tclmpi::init -convthreads 0] {{::tclmpi::init: invalid number of conversion threads: 0}}
+run_return [list ::tclmpi::init -thread serialized -convthreads 4] {}
 run_return [list ::tclmpi::initialized] 1
+run_error  [list ::tclmpi::query_thread 0] \
+    [list "wrong # args: should be \"::tclmpi::query_thread\""]
+run_return [list ::tclmpi::query_thread] {serialized}
 run_error  [list ::tclmpi::init] \
     {{calling ::tclmpi::init multiple times is erroneous.}}
 
@@ -163,6 +178,62 @@ run_return [list ::tclmpi::bcast {-1 2 +3 2.0 7 016}             \
                 $int 0 $comm] {{-1 2 3 0 7 14}}
 run_return [list ::tclmpi::bcast {-1e5 1.1 1.2d0 0.2e-1 0.06E+28 0x22} \
                 $double 0 $self] {{-100000.0 1.1 0.0 0.02 6e+26 34.0}}
+run_return [list ::tclmpi::bcast [binary format a4S abcd 0x4142] \
+                $bytes 0 $self] {abcdab}
+
+# lists of numbers in pure string representation are parsed directly
+set numstr [join {1 -2 +3 2147483647 -2147483648} "\t\n "]
+run_return [list ::tclmpi::bcast $numstr $int 0 $self] {{1 -2 3 2147483647 -2147483648}}
+run_return [list tcl::unsupported::representation $numstr] {{pure string}}
+set numstr [join {0.5 -1e3 +2 .25 5. 1E-2 -0} " "]
+run_return [list ::tclmpi::bcast $numstr $double 0 $self] {{0.5 -1000.0 2.0 0.25 5.0 0.01 -0.0}}
+run_return [list ::tclmpi::bcast [join {010 -0 2147483648} " "] $int 0 $self] {{8 0 -2147483648}}
+run_return [list ::tclmpi::bcast [join {010 1e400 2} " "] $double 0 $self] {{8.0 inf 2.0}}
+::tclmpi::conv_set tclmpi::error
+run_error  [list ::tclmpi::bcast [join {1 2 x3} " "] $int 0 $self] {{expected integer but got "x3"}}
+run_error  [list ::tclmpi::bcast [join {1 2 3.5} " "] $int 0 $self] {{expected integer but got "3.5"}}
+::tclmpi::conv_set tclmpi::tozero
+unset numstr
+
+# large lists that are converted by multiple threads
+proc big_list {num type} {
+    set list {}
+    for {set i 0} {$i < $num} {incr i} {
+        if {$type eq "int"} {
+            lappend list [expr {$i - $num/2}]
+        } else {
+            lappend list [expr {0.25*$i}]
+        }
+    }
+    return $list
+}
+proc big_check {name type} {
+    upvar #0 $name list
+    set res [::tclmpi::bcast $list tclmpi::$type 0 tclmpi::comm_self]
+    return [list [llength $res] [string equal $res $list]]
+}
+proc big_index {name type index} {
+    upvar #0 $name list
+    return [lindex [::tclmpi::bcast $list tclmpi::$type 0 tclmpi::comm_self] $index]
+}
+set bigint [big_list 600000 int]
+set bigdbl [big_list 600000 double]
+run_return [list big_check bigint int] {{600000 1}}
+run_return [list big_check bigdbl double] {{600000 1}}
+run_return [list big_index bigint double 599999] {299999.0}
+lset bigint 400000 xx
+lset bigdbl 500000 2
+lset bigdbl 500001 {2.5}
+run_return [list big_index bigint int 400000] {0}
+run_return [list big_index bigint int 400001] {100001}
+run_return [list big_index bigdbl double 500000] {2.0}
+run_return [list big_index bigdbl double 500001] {2.5}
+run_return [list big_index bigdbl double 500002] {125000.5}
+::tclmpi::conv_set tclmpi::error
+run_error  [list big_index bigint int 0] {{expected integer but got "xx"}}
+run_error  [list big_index bigdbl int 0] {{expected integer but got "0.0"}}
+::tclmpi::conv_set tclmpi::tozero
+unset bigint bigdbl
 
 # scatter
 set numargs \
@@ -176,6 +247,8 @@ run_error  [list ::tclmpi::scatter {} $auto 0 comm0] \
     {{::tclmpi::scatter: unknown communicator: comm0}}
 run_error  [list ::tclmpi::scatter {} $auto 0 $null] \
     {{::tclmpi::scatter: does not support data type tclmpi::auto}}
+run_error  [list ::tclmpi::scatter {1 2} $int 0 $null] \
+    {::tclmpi::scatter: invalid communicator}
 run_error  [list ::tclmpi::scatter {{xx 11} {1 2 3} {}} $int 1 $comm] \
     {::tclmpi::scatter: mpi invalid root}
 run_error  [list ::tclmpi::scatter {} tclmpi::real 0 $comm]    \
@@ -202,6 +275,8 @@ run_error  [list ::tclmpi::allgather {} $auto comm0] \
     {{::tclmpi::allgather: unknown communicator: comm0}}
 run_error  [list ::tclmpi::allgather {} $auto $null] \
     {{::tclmpi::allgather: does not support data type tclmpi::auto}}
+run_error  [list ::tclmpi::allgather {1 2} $int $null] \
+    {::tclmpi::allgather: invalid communicator}
 run_error  [list ::tclmpi::allgather {} tclmpi::real $comm]  \
     {{::tclmpi::allgather: invalid data type: tclmpi::real}}
 
@@ -227,6 +302,8 @@ run_error  [list ::tclmpi::gather {} $auto 0 comm0] \
     {{::tclmpi::gather: unknown communicator: comm0}}
 run_error  [list ::tclmpi::gather {} $auto 0 $null] \
     {{::tclmpi::gather: does not support data type tclmpi::auto}}
+run_error  [list ::tclmpi::gather {1 2} $int 0 $null] \
+    {::tclmpi::gather: invalid communicator}
 run_error  [list ::tclmpi::gather {{xx 11} {1 2 3} {}} $int 1 $comm] \
     {::tclmpi::gather: mpi invalid root}
 run_error  [list ::tclmpi::gather {} tclmpi::real 0 $comm]    \
@@ -242,6 +319,87 @@ run_return [list ::tclmpi::gather {-1 2 +3 2.0 7 016}             \
 run_return [list ::tclmpi::gather {-1e5 1.1 1.2d0 0.2e-1 0.06E+28 0x22} \
                 $double 0 $self] {{-100000.0 1.1 0.0 0.02 6e+26 34.0}}
 
+# gatherv
+set numargs \
+    "wrong # args: should be \"::tclmpi::gatherv <data> <type> <root> <comm>\""
+run_error  [list ::tclmpi::gatherv] [list $numargs]
+run_error  [list ::tclmpi::gatherv {} $auto 0] [list $numargs]
+run_error  [list ::tclmpi::gatherv {} $auto 0 $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::gatherv {} $auto 0 comm0] \
+    {{::tclmpi::gatherv: unknown communicator: comm0}}
+run_error  [list ::tclmpi::gatherv {1 2} $int 0 $null] \
+    {::tclmpi::gatherv: invalid communicator}
+run_error  [list ::tclmpi::gatherv {} $intint 0 $comm] \
+    {{::tclmpi::gatherv: support for data type tclmpi::intint is not yet implemented}}
+run_error  [list ::tclmpi::gatherv {1 2 3} $int 1 $comm] \
+    {::tclmpi::gatherv: mpi invalid root}
+run_error  [list ::tclmpi::gatherv {} tclmpi::real 0 $comm]    \
+    {{::tclmpi::gatherv: invalid data type: tclmpi::real}}
+run_return [list ::tclmpi::gatherv {hello world} $auto 0 $comm] {{{hello world}}}
+run_return [list ::tclmpi::gatherv {{xx 11} 2.5 yy 1} $double 0 $self] \
+    {{{0.0 2.5 0.0 1.0}}}
+run_return [list ::tclmpi::gatherv {} $int 0 $comm] {{{}}}
+
+# allgatherv
+set numargs \
+    "wrong # args: should be \"::tclmpi::allgatherv <data> <type> <comm>\""
+run_error  [list ::tclmpi::allgatherv] [list $numargs]
+run_error  [list ::tclmpi::allgatherv {} $auto] [list $numargs]
+run_error  [list ::tclmpi::allgatherv {} $auto $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::allgatherv {} $auto comm0] \
+    {{::tclmpi::allgatherv: unknown communicator: comm0}}
+run_error  [list ::tclmpi::allgatherv {} $dblint $comm] \
+    {{::tclmpi::allgatherv: support for data type tclmpi::dblint is not yet implemented}}
+run_return [list ::tclmpi::allgatherv {hello world} $auto $self] {{{hello world}}}
+run_return [list ::tclmpi::allgatherv {1 2 yy 016} $int $comm] {{{1 2 0 14}}}
+
+# scatterv
+set numargs \
+    "wrong # args: should be \"::tclmpi::scatterv <data> <type> <root> <comm>\""
+run_error  [list ::tclmpi::scatterv] [list $numargs]
+run_error  [list ::tclmpi::scatterv {} $auto 0] [list $numargs]
+run_error  [list ::tclmpi::scatterv {} $auto 0 $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::scatterv {} $auto 0 comm0] \
+    {{::tclmpi::scatterv: unknown communicator: comm0}}
+run_error  [list ::tclmpi::scatterv {{1 2}} $int 0 $null] \
+    {::tclmpi::scatterv: invalid communicator}
+run_error  [list ::tclmpi::scatterv {a b} $auto 0 $comm] \
+    {{::tclmpi::scatterv: number of list elements must be the same as the number of processes}}
+run_return [list ::tclmpi::scatterv {{hello world}} $auto 0 $comm] {{hello world}}
+run_return [list ::tclmpi::scatterv {{1 2 yy}} $int 0 $self] {{1 2 0}}
+
+# alltoall
+set numargs \
+    "wrong # args: should be \"::tclmpi::alltoall <data> <type> <comm>\""
+run_error  [list ::tclmpi::alltoall] [list $numargs]
+run_error  [list ::tclmpi::alltoall {} $auto] [list $numargs]
+run_error  [list ::tclmpi::alltoall {} $auto $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::alltoall {} $auto comm0] \
+    {{::tclmpi::alltoall: unknown communicator: comm0}}
+run_error  [list ::tclmpi::alltoall {} $intint $comm] \
+    {{::tclmpi::alltoall: support for data type tclmpi::intint is not yet implemented}}
+run_error  [list ::tclmpi::alltoall {a b} $auto $comm] \
+    {{::tclmpi::alltoall: number of list elements must be the same as the number of processes}}
+run_return [list ::tclmpi::alltoall {{hello world}} $auto $comm] {{{hello world}}}
+run_return [list ::tclmpi::alltoall {{1 2 yy}} $int $self] {{{1 2 0}}}
+run_return [list ::tclmpi::alltoall {{0.5 2}} $double $comm] {{{0.5 2.0}}}
+
+# alltoallv
+set numargs \
+    "wrong # args: should be \"::tclmpi::alltoallv <data> <type> <comm>\""
+run_error  [list ::tclmpi::alltoallv] [list $numargs]
+run_error  [list ::tclmpi::alltoallv {} $auto] [list $numargs]
+run_error  [list ::tclmpi::alltoallv {} $auto $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::alltoallv {} $auto comm0] \
+    {{::tclmpi::alltoallv: unknown communicator: comm0}}
+run_error  [list ::tclmpi::alltoallv {} $intint $comm] \
+    {{::tclmpi::alltoallv: support for data type tclmpi::intint is not yet implemented}}
+run_error  [list ::tclmpi::alltoallv {a b} $auto $comm] \
+    {{::tclmpi::alltoallv: number of list elements must be the same as the number of processes}}
+run_return [list ::tclmpi::alltoallv {{hello world}} $auto $comm] {{{hello world}}}
+run_return [list ::tclmpi::alltoallv {{1 2 yy}} $int $self] {{{1 2 0}}}
+run_return [list ::tclmpi::alltoallv {{0.5 2}} $double $comm] {{{0.5 2.0}}}
+
 # allreduce
 set numargs \
     "wrong # args: should be \"::tclmpi::allreduce <data> <type> <op> <comm>\""
@@ -253,6 +411,8 @@ run_error  [list ::tclmpi::allreduce {} $auto tclmpi::prod $comm xxx] \
     [list $numargs]
 run_error  [list ::tclmpi::allreduce {} $auto tclmpi::max $comm]      \
     {{::tclmpi::allreduce: does not support data type tclmpi::auto}}
+run_error  [list ::tclmpi::allreduce {} $bytes tclmpi::max $comm]    \
+    {{::tclmpi::allreduce: does not support data type tclmpi::bytes}}
 run_error  [list ::tclmpi::allreduce {} $int tclmpi::max comm0]       \
     {{::tclmpi::allreduce: unknown communicator: comm0}}
 run_error  [list ::tclmpi::allreduce {} $int tclmpi::maxloc $comm]    \
@@ -297,6 +457,20 @@ run_return [list ::tclmpi::allreduce {{xx 11} {1 2 3} 2.5 yy 1}      \
 run_return [list ::tclmpi::allreduce {-1 2 +3 2.0 7 016}             \
                 $int tclmpi::prod $comm] {{-1 2 3 0 7 14}}
 
+# native data vectors returned from collectives can be passed on directly
+set idata [::tclmpi::allreduce {-1 2 +3 016} $int tclmpi::sum $comm]
+set ddata [::tclmpi::allreduce {0.5 2 -1e3} $double tclmpi::sum $comm]
+run_return [list ::tclmpi::allreduce $idata $int tclmpi::max $comm] {{-1 2 3 14}}
+run_return [list ::tclmpi::allreduce $idata $double tclmpi::sum $comm] \
+    {{-1.0 2.0 3.0 14.0}}
+run_return [list ::tclmpi::allreduce $ddata $double tclmpi::min $comm] \
+    {{0.5 2.0 -1000.0}}
+run_return [list ::tclmpi::allreduce $ddata $int tclmpi::sum $comm] {{0 0 0}}
+run_return [list lindex $ddata 2] {-1000.0}
+run_return [list llength $idata] {4}
+run_return [list lrange $idata 1 2] {{2 3}}
+run_return [list lreverse $ddata] {{-1000.0 2.0 0.5}}
+
 # reduce
 set numargs \
     "wrong # args: should be \"::tclmpi::reduce <data> <type> <op> <root> <comm>\""
@@ -345,6 +519,341 @@ run_error  [list ::tclmpi::reduce {{2 1.1} {-1 -1}} $dblint \
 run_return [list ::tclmpi::reduce {{2 1 0} {1.0 1 0 0}} $dblint \
                 tclmpi::minloc 0 $comm] {{{2.0 1} {1.0 1}}}
 
+# scan
+set numargs \
+    "wrong # args: should be \"::tclmpi::scan <data> <type> <op> <comm>\""
+run_error  [list ::tclmpi::scan] [list $numargs]
+run_error  [list ::tclmpi::scan {} $auto tclmpi::sum] [list $numargs]
+run_error  [list ::tclmpi::scan {} $auto tclmpi::sum $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::scan {} $auto tclmpi::max $comm] \
+    {{::tclmpi::scan: does not support data type tclmpi::auto}}
+run_error  [list ::tclmpi::scan {} $int tclmpi::max comm0] \
+    {{::tclmpi::scan: unknown communicator: comm0}}
+run_error  [list ::tclmpi::scan {} $int tclmpi::maxloc $comm] \
+    {::tclmpi::scan: invalid mpi op}
+run_error  [list ::tclmpi::scan {{}} $int tclmpi::gamma $comm] \
+    {{::tclmpi::scan: unknown reduction operator: tclmpi::gamma}}
+run_error  [list ::tclmpi::scan {2 0 1 1} $intint tclmpi::maxloc $comm] \
+    {{::tclmpi::scan: bad list format for loc reduction: tclmpi::maxloc}}
+run_error  [list ::tclmpi::scan {{2 1.1} {-1 -1}} $dblint tclmpi::maxloc $comm] \
+    {{::tclmpi::scan: bad location data for reduction: tclmpi::maxloc}}
+run_return [list ::tclmpi::scan {1 2 yy} $int tclmpi::sum $comm] {{1 2 0}}
+run_return [list ::tclmpi::scan {0.5 -2} $double tclmpi::prod $self] {{0.5 -2.0}}
+run_return [list ::tclmpi::scan {{2 1 0} {1.0 1 0 0}} $dblint tclmpi::minloc $comm] \
+    {{{2.0 1} {1.0 1}}}
+
+# exscan
+set numargs \
+    "wrong # args: should be \"::tclmpi::exscan <data> <type> <op> <comm>\""
+run_error  [list ::tclmpi::exscan] [list $numargs]
+run_error  [list ::tclmpi::exscan {} $auto tclmpi::sum] [list $numargs]
+run_error  [list ::tclmpi::exscan {} $auto tclmpi::sum $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::exscan {} $auto tclmpi::max $comm] \
+    {{::tclmpi::exscan: does not support data type tclmpi::auto}}
+run_error  [list ::tclmpi::exscan {} $int tclmpi::max comm0] \
+    {{::tclmpi::exscan: unknown communicator: comm0}}
+run_error  [list ::tclmpi::exscan {} $int tclmpi::maxloc $comm] \
+    {::tclmpi::exscan: invalid mpi op}
+run_error  [list ::tclmpi::exscan {{}} $int tclmpi::gamma $comm] \
+    {{::tclmpi::exscan: unknown reduction operator: tclmpi::gamma}}
+run_error  [list ::tclmpi::exscan {2 0 1 1} $intint tclmpi::maxloc $comm] \
+    {{::tclmpi::exscan: bad list format for loc reduction: tclmpi::maxloc}}
+run_error  [list ::tclmpi::exscan {{2 1.1} {-1 -1}} $dblint tclmpi::maxloc $comm] \
+    {{::tclmpi::exscan: bad location data for reduction: tclmpi::maxloc}}
+run_return [list ::tclmpi::exscan {1 2 yy} $int tclmpi::sum $comm] {}
+run_return [list ::tclmpi::exscan {{2 1} {1 0}} $intint tclmpi::minloc $comm] {}
+
+# reduce_scatter_block
+set numargs \
+    "wrong # args: should be \"::tclmpi::reduce_scatter_block <data> <type> <op> <comm>\""
+run_error  [list ::tclmpi::reduce_scatter_block] [list $numargs]
+run_error  [list ::tclmpi::reduce_scatter_block {} $auto tclmpi::sum] [list $numargs]
+run_error  [list ::tclmpi::reduce_scatter_block {} $auto tclmpi::sum $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::reduce_scatter_block {} $auto tclmpi::max $comm] \
+    {{::tclmpi::reduce_scatter_block: does not support data type tclmpi::auto}}
+run_error  [list ::tclmpi::reduce_scatter_block {} $int tclmpi::max comm0] \
+    {{::tclmpi::reduce_scatter_block: unknown communicator: comm0}}
+run_error  [list ::tclmpi::reduce_scatter_block {} $int tclmpi::maxloc $comm] \
+    {::tclmpi::reduce_scatter_block: invalid mpi op}
+run_error  [list ::tclmpi::reduce_scatter_block {{}} $int tclmpi::gamma $comm] \
+    {{::tclmpi::reduce_scatter_block: unknown reduction operator: tclmpi::gamma}}
+run_error  [list ::tclmpi::reduce_scatter_block {2 0 1 1} $intint tclmpi::maxloc $comm] \
+    {{::tclmpi::reduce_scatter_block: bad list format for loc reduction: tclmpi::maxloc}}
+run_error  [list ::tclmpi::reduce_scatter_block {{2 1.1} {-1 -1}} $dblint tclmpi::maxloc $comm] \
+    {{::tclmpi::reduce_scatter_block: bad location data for reduction: tclmpi::maxloc}}
+run_return [list ::tclmpi::reduce_scatter_block {1 2 yy} $int tclmpi::sum $comm] {{1 2 0}}
+run_return [list ::tclmpi::reduce_scatter_block {0.5 -2} $double tclmpi::prod $self] {{0.5 -2.0}}
+run_return [list ::tclmpi::reduce_scatter_block {{2 1 0} {1.0 1 0 0}} $dblint tclmpi::minloc $comm] \
+    {{{2.0 1} {1.0 1}}}
+
+# non-blocking collectives
+set numargs "wrong # args: should be \"::tclmpi::ibarrier <comm>\""
+run_error  [list ::tclmpi::ibarrier] [list $numargs]
+run_error  [list ::tclmpi::ibarrier $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::ibarrier comm0] {{::tclmpi::ibarrier: unknown communicator: comm0}}
+run_return [list ::tclmpi::ibarrier $comm] {tclmpi::req0}
+run_return [list ::tclmpi::wait tclmpi::req0] {}
+set numargs \
+    "wrong # args: should be \"::tclmpi::ibcast <data> <type> <root> <comm>\""
+run_error  [list ::tclmpi::ibcast] [list $numargs]
+run_error  [list ::tclmpi::ibcast {} $auto 0] [list $numargs]
+run_error  [list ::tclmpi::ibcast {} $auto 0 comm0] \
+    {{::tclmpi::ibcast: unknown communicator: comm0}}
+run_error  [list ::tclmpi::ibcast {} $intint 0 $comm] \
+    {{::tclmpi::ibcast: support for data type tclmpi::intint is not yet implemented}}
+run_return [list ::tclmpi::ibcast {hello world} $auto 0 $comm] {tclmpi::req1}
+run_return [list ::tclmpi::wait tclmpi::req1] {{hello world}}
+set numargs \
+    "wrong # args: should be \"::tclmpi::iallreduce <data> <type> <op> <comm>\""
+run_error  [list ::tclmpi::iallreduce] [list $numargs]
+run_error  [list ::tclmpi::iallreduce {} $int tclmpi::sum] [list $numargs]
+run_error  [list ::tclmpi::iallreduce {} $auto tclmpi::sum $comm] \
+    {{::tclmpi::iallreduce: does not support data type tclmpi::auto}}
+run_error  [list ::tclmpi::iallreduce {} $int tclmpi::gamma $comm] \
+    {{::tclmpi::iallreduce: unknown reduction operator: tclmpi::gamma}}
+run_return [list ::tclmpi::iallreduce {1 2 yy} $int tclmpi::sum $comm] {tclmpi::req2}
+run_return [list ::tclmpi::wait tclmpi::req2] {{1 2 0}}
+set numargs \
+    "wrong # args: should be \"::tclmpi::ireduce <data> <type> <op> <root> <comm>\""
+run_error  [list ::tclmpi::ireduce] [list $numargs]
+run_error  [list ::tclmpi::ireduce {} $int tclmpi::sum $comm] [list $numargs]
+run_error  [list ::tclmpi::ireduce {2 0 1 1} $intint tclmpi::maxloc 0 $comm] \
+    {{::tclmpi::ireduce: bad list format for loc reduction: tclmpi::maxloc}}
+run_return [list ::tclmpi::ireduce {{2 1 0} {1.0 1 0 0}} $dblint tclmpi::minloc 0 $comm] \
+    {tclmpi::req3}
+run_return [list ::tclmpi::wait tclmpi::req3] {{{2.0 1} {1.0 1}}}
+set numargs \
+    "wrong # args: should be \"::tclmpi::iallgather <data> <type> <comm>\""
+run_error  [list ::tclmpi::iallgather] [list $numargs]
+run_error  [list ::tclmpi::iallgather {} $int $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::iallgather {} $auto $comm] \
+    {{::tclmpi::iallgather: does not support data type tclmpi::auto}}
+run_return [list ::tclmpi::iallgather {0.5 -2} $double $self] {tclmpi::req4}
+run_return [list ::tclmpi::wait tclmpi::req4] {{0.5 -2.0}}
+set numargs \
+    "wrong # args: should be \"::tclmpi::igather <data> <type> <root> <comm>\""
+run_error  [list ::tclmpi::igather] [list $numargs]
+run_error  [list ::tclmpi::igather {} $int $comm] [list $numargs]
+run_error  [list ::tclmpi::igather {} $intint 0 $comm] \
+    {{::tclmpi::igather: support for data type tclmpi::intint is not yet implemented}}
+run_return [list ::tclmpi::igather {1 2} $int 0 $comm] {tclmpi::req5}
+run_return [list ::tclmpi::wait tclmpi::req5] {{1 2}}
+
+# persistent requests
+set numargs \
+    "wrong # args: should be \"::tclmpi::send_init <data> <type> <dest> <tag> <comm>\""
+run_error  [list ::tclmpi::send_init] [list $numargs]
+run_error  [list ::tclmpi::send_init {} $int 0 0] [list $numargs]
+run_error  [list ::tclmpi::send_init {} $int 0 0 comm0] \
+    {{::tclmpi::send_init: unknown communicator: comm0}}
+run_error  [list ::tclmpi::send_init {} $intint 0 0 $self] \
+    {{::tclmpi::send_init: support for data type tclmpi::intint is not yet implemented}}
+run_return [list ::tclmpi::send_init {1 2 3} $int 0 1 $self] {tclmpi::req6}
+set numargs \
+    "wrong # args: should be \"::tclmpi::recv_init <type> <count> <source> <tag> <comm>\""
+run_error  [list ::tclmpi::recv_init] [list $numargs]
+run_error  [list ::tclmpi::recv_init $int 3 0 1] [list $numargs]
+run_error  [list ::tclmpi::recv_init $int -1 0 1 $self] {{::tclmpi::recv_init: invalid count: -1}}
+run_return [list ::tclmpi::recv_init $int 3 tclmpi::any_source 1 $self] {tclmpi::req7}
+set numargs "wrong # args: should be \"::tclmpi::start <request> ?data?\""
+run_error  [list ::tclmpi::start] [list $numargs]
+run_error  [list ::tclmpi::start tclmpi::req6 {} xxx] [list $numargs]
+run_error  [list ::tclmpi::start tclmpi::req5] {{::tclmpi::start: not a persistent request: tclmpi::req5}}
+run_error  [list ::tclmpi::start tclmpi::req6 {1 2}] \
+    {{::tclmpi::start: number of data items does not match request: tclmpi::req6}}
+run_return [list ::tclmpi::start tclmpi::req7] {}
+run_error  [list ::tclmpi::start tclmpi::req7] {{::tclmpi::start: request is already active: tclmpi::req7}}
+run_error  [list ::tclmpi::request_free tclmpi::req7] \
+    {{::tclmpi::request_free: request is still active: tclmpi::req7}}
+run_return [list ::tclmpi::start tclmpi::req6] {}
+run_return [list ::tclmpi::wait tclmpi::req7] {{1 2 3}}
+run_return [list ::tclmpi::wait tclmpi::req6] {}
+run_return [list ::tclmpi::wait tclmpi::req6] {}
+set numargs "wrong # args: should be \"::tclmpi::startall <requests> ?data?\""
+run_error  [list ::tclmpi::startall] [list $numargs]
+run_error  [list ::tclmpi::startall {tclmpi::req6 tclmpi::req7} {{4 5 6}}] \
+    {{::tclmpi::startall: number of data items must match number of requests}}
+run_error  [list ::tclmpi::startall {tclmpi::req6 tclmpi::req5}] \
+    {{::tclmpi::startall: not a persistent request: tclmpi::req5}}
+run_error  [list ::tclmpi::startall {tclmpi::req6 tclmpi::req7 tclmpi::req6}] \
+    {{::tclmpi::startall: request is listed more than once: tclmpi::req6}}
+run_error  [list ::tclmpi::startall {tclmpi::req6 tclmpi::req5} {{7 8 9} {}}] \
+    {{::tclmpi::startall: not a persistent request: tclmpi::req5}}
+run_return [list ::tclmpi::startall {tclmpi::req7 tclmpi::req6}] {}
+run_return [list ::tclmpi::wait tclmpi::req7] {{1 2 3}}
+run_return [list ::tclmpi::wait tclmpi::req6] {}
+run_return [list ::tclmpi::startall {tclmpi::req7 tclmpi::req6} {{} {4 5 6}}] {}
+run_return [list ::tclmpi::wait tclmpi::req7] {{4 5 6}}
+run_return [list ::tclmpi::wait tclmpi::req6] {}
+set numargs "wrong # args: should be \"::tclmpi::request_free <request>\""
+run_error  [list ::tclmpi::request_free] [list $numargs]
+run_error  [list ::tclmpi::request_free tclmpi::req5] \
+    {{::tclmpi::request_free: not a persistent request: tclmpi::req5}}
+run_return [list ::tclmpi::request_free tclmpi::req6] {}
+run_return [list ::tclmpi::request_free tclmpi::req7] {}
+run_error  [list ::tclmpi::start tclmpi::req6] {{::tclmpi::start: not a persistent request: tclmpi::req6}}
+
+# combined send and receive
+set numargs "wrong # args: should be \"::tclmpi::sendrecv <data> <type> <dest> <sendtag>\
+ <source> <recvtag> <comm> ?status?\""
+run_error  [list ::tclmpi::sendrecv] [list $numargs]
+run_error  [list ::tclmpi::sendrecv {} $int 0 0 0 0] [list $numargs]
+run_error  [list ::tclmpi::sendrecv {} $int 0 0 0 0 comm0] \
+    {{::tclmpi::sendrecv: unknown communicator: comm0}}
+run_error  [list ::tclmpi::sendrecv {} xxx 0 0 0 0 $self] {{::tclmpi::sendrecv: invalid data type: xxx}}
+run_error  [list ::tclmpi::sendrecv {} $dblint 0 0 0 0 $self] \
+    {{::tclmpi::sendrecv: support for data type tclmpi::dblint is not yet implemented}}
+run_return [list ::tclmpi::sendrecv {1 2 3} $int 0 5 0 5 $self] {{1 2 3}}
+run_return [list ::tclmpi::sendrecv {hello world} $auto 0 5 tclmpi::any_source tclmpi::any_tag $self] \
+    {{hello world}}
+set numargs "wrong # args: should be \"::tclmpi::sendrecv_replace <data> <type> <dest> <sendtag>\
+ <source> <recvtag> <comm> ?status?\""
+run_error  [list ::tclmpi::sendrecv_replace] [list $numargs]
+run_error  [list ::tclmpi::sendrecv_replace {} $int 0 0 0 0 comm0] \
+    {{::tclmpi::sendrecv_replace: unknown communicator: comm0}}
+run_return [list ::tclmpi::sendrecv_replace {0.5 -1} $double 0 5 0 5 $self] {{0.5 -1.0}}
+
+# list access to received int and double vectors
+set ivec [::tclmpi::sendrecv {4 -5 6 7} $int 0 6 0 6 $self]
+set dvec [::tclmpi::sendrecv {1.5 -2 3e2} $double 0 6 0 6 $self]
+run_return [list lindex $ivec 3] {7}
+run_return [list lrange $ivec 1 2] {{-5 6}}
+run_return [list lreverse $ivec] {{7 6 -5 4}}
+run_return [list lindex $dvec 0] {1.5}
+run_return [list lrange $dvec 1 end] {{-2.0 300.0}}
+run_return [list lreverse $dvec] {{300.0 -2.0 1.5}}
+
+# waitall, waitany, waitsome, test and testall
+set numargs "wrong # args: should be \"::tclmpi::waitall <requests> ?status?\""
+run_error  [list ::tclmpi::waitall] [list $numargs]
+run_error  [list ::tclmpi::waitall {} status xxx] [list $numargs]
+run_error  [list ::tclmpi::waitall "\{"] {{unmatched open brace in list}}
+run_return [list ::tclmpi::waitall {}] {}
+run_return [list ::tclmpi::irecv $int 0 11 $self] {tclmpi::req8}
+run_return [list ::tclmpi::isend {1 2} $int 0 11 $self] {tclmpi::req9}
+run_return [list ::tclmpi::waitall {tclmpi::req8 tclmpi::req9 tclmpi::req0} status] {{{1 2} {} {}}}
+set numargs "wrong # args: should be \"::tclmpi::test <request> ?status?\""
+run_error  [list ::tclmpi::test] [list $numargs]
+run_error  [list ::tclmpi::test tclmpi::req0 status xxx] [list $numargs]
+run_return [list ::tclmpi::test tclmpi::req0] {{1 {}}}
+run_return [list ::tclmpi::irecv $auto 0 12 $self] {tclmpi::req10}
+run_return [list ::tclmpi::test tclmpi::req10] {{0 {}}}
+run_return [list ::tclmpi::isend {hello} $auto 0 12 $self] {tclmpi::req11}
+run_return [list ::tclmpi::test tclmpi::req10 status] {{1 hello}}
+run_return [list ::tclmpi::test tclmpi::req11] {{1 {}}}
+set numargs "wrong # args: should be \"::tclmpi::testall <requests> ?status?\""
+run_error  [list ::tclmpi::testall] [list $numargs]
+run_return [list ::tclmpi::irecv $double 0 13 $self] {tclmpi::req12}
+run_return [list ::tclmpi::testall {tclmpi::req12}] {{0 {}}}
+run_return [list ::tclmpi::isend {0.5} $double 0 13 $self] {tclmpi::req13}
+run_return [list ::tclmpi::testall {tclmpi::req12 tclmpi::req13} status] {{1 {0.5 {}}}}
+set numargs "wrong # args: should be \"::tclmpi::waitany <requests> ?status?\""
+run_error  [list ::tclmpi::waitany] [list $numargs]
+run_return [list ::tclmpi::waitany {}] {{-1 {}}}
+run_return [list ::tclmpi::irecv $int 0 14 $self] {tclmpi::req14}
+run_return [list ::tclmpi::irecv $int 0 15 $self] {tclmpi::req15}
+run_return [list ::tclmpi::isend {7} $int 0 15 $self] {tclmpi::req16}
+run_return [list ::tclmpi::waitany {tclmpi::req14 tclmpi::req15} status] {{1 7}}
+run_return [list ::tclmpi::waitany {tclmpi::req16}] {{0 {}}}
+set numargs "wrong # args: should be \"::tclmpi::waitsome <requests> ?status?\""
+run_error  [list ::tclmpi::waitsome] [list $numargs]
+run_return [list ::tclmpi::waitsome {tclmpi::req15}] {}
+run_return [list ::tclmpi::isend {8 9} $int 0 14 $self] {tclmpi::req17}
+run_return [list ::tclmpi::waitsome {tclmpi::req14} status] {{{0 {8 9}}}}
+run_return [list ::tclmpi::waitall {tclmpi::req17}] {{{}}}
+
+# irecv with a capacity hint
+set numargs "wrong # args: should be \"::tclmpi::irecv <type> <source> <tag> <comm> ?-maxcount <num>?\""
+run_error  [list ::tclmpi::irecv] [list $numargs]
+run_error  [list ::tclmpi::irecv $int 0 16 $self -maxcount] [list $numargs]
+run_error  [list ::tclmpi::irecv $int 0 16 $self -count 4] [list $numargs]
+run_error  [list ::tclmpi::irecv $int 0 16 $self -maxcount xx] {{expected integer but got "xx"}}
+run_error  [list ::tclmpi::irecv $int 0 16 $self -maxcount -1] {{::tclmpi::irecv: invalid count: -1}}
+run_return [list ::tclmpi::irecv $int 0 16 $self -maxcount 10] {tclmpi::req18}
+run_return [list ::tclmpi::isend {1 2 3} $int 0 16 $self] {tclmpi::req19}
+run_return [list ::tclmpi::wait tclmpi::req18] {{1 2 3}}
+run_return [list ::tclmpi::wait tclmpi::req19] {}
+run_return [list ::tclmpi::irecv $auto 0 17 $self -maxcount 20] {tclmpi::req20}
+run_return [list ::tclmpi::irecv $bytes 0 18 $self -maxcount 20] {tclmpi::req21}
+run_return [list ::tclmpi::isend {hello world} $auto 0 17 $self] {tclmpi::req22}
+run_return [list ::tclmpi::isend {hello} $bytes 0 18 $self] {tclmpi::req23}
+run_return [list ::tclmpi::waitall {tclmpi::req20 tclmpi::req21 tclmpi::req22 tclmpi::req23}] \
+    {{{hello world} hello {} {}}}
+
+# event loop integration
+proc on_msg {source tag} {
+    set ::msg [list $source $tag [::tclmpi::recv tclmpi::int $source $tag tclmpi::comm_self]]
+}
+proc on_done {req data} {
+    set ::done [list $req $data]
+}
+set numargs "wrong # args: should be \"::tclmpi::onmessage <source> <tag> <comm> ?script?\""
+run_error  [list ::tclmpi::onmessage] [list $numargs]
+run_error  [list ::tclmpi::onmessage 0 19] [list $numargs]
+run_error  [list ::tclmpi::onmessage 0 19 $self on_msg xxx] [list $numargs]
+run_error  [list ::tclmpi::onmessage 0 19 comm0] {{::tclmpi::onmessage: unknown communicator: comm0}}
+run_error  [list ::tclmpi::onmessage 0 xx $self] {{expected integer but got "xx"}}
+run_return [list ::tclmpi::onmessage 0 19 $self] {}
+run_return [list ::tclmpi::onmessage 0 19 $self on_msg] {}
+run_return [list ::tclmpi::onmessage 0 19 $self] {on_msg}
+run_return [list ::tclmpi::isend {1 2} $int 0 19 $self] {tclmpi::req24}
+run_return [list vwait ::msg] {}
+run_return [list set ::msg] {{0 19 {1 2}}}
+run_return [list ::tclmpi::onmessage 0 19 $self {}] {}
+run_return [list ::tclmpi::onmessage 0 19 $self] {}
+run_return [list ::tclmpi::wait tclmpi::req24] {}
+set numargs "wrong # args: should be \"::tclmpi::oncomplete <request> ?script?\""
+run_error  [list ::tclmpi::oncomplete] [list $numargs]
+run_error  [list ::tclmpi::oncomplete tclmpi::req24 on_done xxx] [list $numargs]
+run_error  [list ::tclmpi::oncomplete tclmpi::req24] {{::tclmpi::oncomplete: unknown request: tclmpi::req24}}
+run_return [list ::tclmpi::irecv $int 0 20 $self] {tclmpi::req25}
+run_return [list ::tclmpi::oncomplete tclmpi::req25 on_done] {}
+run_return [list ::tclmpi::oncomplete tclmpi::req25] {on_done}
+run_return [list ::tclmpi::isend {3} $int 0 20 $self] {tclmpi::req26}
+run_return [list vwait ::done] {}
+run_return [list set ::done] {{tclmpi::req25 3}}
+run_error  [list ::tclmpi::oncomplete tclmpi::req25] {{::tclmpi::oncomplete: unknown request: tclmpi::req25}}
+run_return [list ::tclmpi::wait tclmpi::req26] {}
+
+# coroutine aware commands
+proc co_task {} {
+    set ::cores [tclmpi::co::recv tclmpi::int 0 21 tclmpi::comm_self]
+}
+run_return [list coroutine cotask co_task] {}
+run_return [list info commands cotask] {cotask}
+run_return [list tclmpi::co::send {4 5} $int 0 21 $self] {}
+run_return [list vwait ::cores] {}
+run_return [list set ::cores] {{4 5}}
+run_return [list info commands cotask] {}
+run_return [list tclmpi::co::allreduce {1 2} $int tclmpi::sum $self] {{1 2}}
+run_error  [list tclmpi::co::recv $int 0 21 $self -maxcount] \
+    {{wrong # args: should be "::tclmpi::irecv <type> <source> <tag> <comm> ?-maxcount <num>?"}}
+
+# many outstanding requests and reductions of pure strings
+proc many_reqs {num} {
+    set reqs {}
+    for {set i 0} {$i < $num} {incr i} {
+        lappend reqs [::tclmpi::irecv tclmpi::int 0 $i tclmpi::comm_self]
+    }
+    for {set i 0} {$i < $num} {incr i} {
+        lappend reqs [::tclmpi::isend [list $i] tclmpi::int 0 $i tclmpi::comm_self]
+    }
+    set res [::tclmpi::waitall $reqs]
+    set sum [::tclmpi::allreduce [lrange $res 0 $num-1] tclmpi::int tclmpi::max tclmpi::comm_self]
+    return [list [llength $res] [tcl::mathop::+ {*}$sum]]
+}
+run_return [list many_reqs 100] {{200 4950}}
+proc dup_reqs {cmd} {
+    set r [::tclmpi::irecv tclmpi::int 0 1 tclmpi::comm_self]
+    set s [::tclmpi::isend {1 2} tclmpi::int 0 1 tclmpi::comm_self]
+    return [::tclmpi::$cmd [list $s $s $r $r]]
+}
+run_return [list dup_reqs waitall] {{{} {} {1 2} {}}}
+run_return [list dup_reqs testall] {{1 {{} {} {1 2} {}}}}
+run_return [list dup_reqs waitsome] {{{0 {}} {2 {1 2}}}}
+run_return [list ::tclmpi::allreduce [join {1 2 3} " "] $double tclmpi::sum $self] {{1.0 2.0 3.0}}
+run_return [list ::tclmpi::reduce [join {4 5} " "] $int tclmpi::sum 0 $self] {{4 5}}
+
 # probe
 set numargs \
     "wrong # args: should be \"::tclmpi::probe <source> <tag> <comm> ?status?\""
@@ -52,9 +52,24 @@ run_return [list conv_set tclmpi::tozero] {}
 run_return [list conv_get] {{tclmpi::tozero}}
 
 # init
+run_error  [list query_thread] \
+    {{calling query_thread outside of tclmpi::init and tclmpi::finalize is erroneous.}}
 run_error  [list init 0] \
-    [list "wrong # args: should be \"init\""]
-run_return [list init] {}
+    [list "wrong # args: should be \"init ?-thread <level>? ?-progress <usec>? ?-convthreads <num>?\""]
+run_error  [list init -thread] \
+    [list "wrong # args: should be \"init ?-thread <level>? ?-progress <usec>? ?-convthreads <num>?\""]
+run_error  [list init -progress] \
+    [list "wrong # args: should be \"init ?-thread <level>? ?-progress <usec>? ?-convthreads <num>?\""]
+run_error  [list init -progress 100 -thread] \
+    [list "wrong # args: should be \"init ?-thread <level>? ?-progress <usec>? ?-convthreads <num>?\""]
+run_error  [list init -progress xx] {{expected integer but got "xx"}}
+run_error  [list init -progress 0] {{init: invalid progress interval: 0}}
+run_error  [list init -thread xxx] {{init: unknown thread level: xxx}}
+run_error  [list init -convthreads 0] {{init: invalid number of conversion threads: 0}}
+run_return [list init -thread serialized -convthreads 4] {}
+run_error  [list query_thread 0] \
+    [list "wrong # args: should be \"query_thread\""]
+run_return [list query_thread] {serialized}
 run_error  [list init] \
     {{calling init multiple times is erroneous.}}
 
@@ -171,6 +186,62 @@ run_return [list bcast {-1 2 +3 2.0 7 016}             \
                 $int 0 $comm] {{-1 2 3 0 7 14}}
 run_return [list bcast {-1e5 1.1 1.2d0 0.2e-1 0.06E+28 0x22} \
                 $double 0 $self] {{-100000.0 1.1 0.0 0.02 6e+26 34.0}}
+run_return [list bcast [binary format a4S abcd 0x4142] \
+                $bytes 0 $self] {abcdab}
+
+# lists of numbers in pure string representation are parsed directly
+set numstr [join {1 -2 +3 2147483647 -2147483648} "\t\n "]
+run_return [list bcast $numstr $int 0 $self] {{1 -2 3 2147483647 -2147483648}}
+run_return [list tcl::unsupported::representation $numstr] {{pure string}}
+set numstr [join {0.5 -1e3 +2 .25 5. 1E-2 -0} " "]
+run_return [list bcast $numstr $double 0 $self] {{0.5 -1000.0 2.0 0.25 5.0 0.01 -0.0}}
+run_return [list bcast [join {010 -0 2147483648} " "] $int 0 $self] {{8 0 -2147483648}}
+run_return [list bcast [join {010 1e400 2} " "] $double 0 $self] {{8.0 inf 2.0}}
+conv_set tclmpi::error
+run_error  [list bcast [join {1 2 x3} " "] $int 0 $self] {{expected integer but got "x3"}}
+run_error  [list bcast [join {1 2 3.5} " "] $int 0 $self] {{expected integer but got "3.5"}}
+conv_set tclmpi::tozero
+unset numstr
+
+# large lists that are converted by multiple threads
+proc big_list {num type} {
+    set list {}
+    for {set i 0} {$i < $num} {incr i} {
+        if {$type eq "int"} {
+            lappend list [expr {$i - $num/2}]
+        } else {
+            lappend list [expr {0.25*$i}]
+        }
+    }
+    return $list
+}
+proc big_check {name type} {
+    upvar #0 $name list
+    set res [bcast $list tclmpi::$type 0 tclmpi::comm_self]
+    return [list [llength $res] [string equal $res $list]]
+}
+proc big_index {name type index} {
+    upvar #0 $name list
+    return [lindex [bcast $list tclmpi::$type 0 tclmpi::comm_self] $index]
+}
+set bigint [big_list 600000 int]
+set bigdbl [big_list 600000 double]
+run_return [list big_check bigint int] {{600000 1}}
+run_return [list big_check bigdbl double] {{600000 1}}
+run_return [list big_index bigint double 599999] {299999.0}
+lset bigint 400000 xx
+lset bigdbl 500000 2
+lset bigdbl 500001 {2.5}
+run_return [list big_index bigint int 400000] {0}
+run_return [list big_index bigint int 400001] {100001}
+run_return [list big_index bigdbl double 500000] {2.0}
+run_return [list big_index bigdbl double 500001] {2.5}
+run_return [list big_index bigdbl double 500002] {125000.5}
+conv_set tclmpi::error
+run_error  [list big_index bigint int 0] {{expected integer but got "xx"}}
+run_error  [list big_index bigdbl int 0] {{expected integer but got "0.0"}}
+conv_set tclmpi::tozero
+unset bigint bigdbl
 
 # scatter
 set numargs \
@@ -184,6 +255,8 @@ run_error  [list scatter {} $auto 0 comm0] \
     {{scatter: unknown communicator: comm0}}
 run_error  [list scatter {} $auto 0 $null] \
     {{scatter: does not support data type tclmpi::auto}}
+run_error  [list scatter {1 2} $int 0 $null] \
+    {scatter: invalid communicator}
 run_error  [list scatter {{xx 11} {1 2 3} {}} $int 1 $comm] \
     {scatter: invalid root}
 run_error  [list scatter {} tclmpi::real 0 $comm]    \
@@ -210,6 +283,8 @@ run_error  [list allgather {} $auto comm0] \
     {{allgather: unknown communicator: comm0}}
 run_error  [list allgather {} $auto $null] \
     {{allgather: does not support data type tclmpi::auto}}
+run_error  [list allgather {1 2} $int $null] \
+    {allgather: invalid communicator}
 run_error  [list allgather {} tclmpi::real $comm]    \
     {{allgather: invalid data type: tclmpi::real}}
 
@@ -235,6 +310,8 @@ run_error  [list gather {} $auto 0 comm0] \
     {{gather: unknown communicator: comm0}}
 run_error  [list gather {} $auto 0 $null] \
     {{gather: does not support data type tclmpi::auto}}
+run_error  [list gather {1 2} $int 0 $null] \
+    {gather: invalid communicator}
 run_error  [list gather {{xx 11} {1 2 3} {}} $int 1 $comm] \
     {gather: invalid root}
 run_error  [list gather {} tclmpi::real 0 $comm]    \
@@ -250,6 +327,87 @@ run_return [list gather {-1 2 +3 2.0 7 016}             \
 run_return [list gather {-1e5 1.1 1.2d0 0.2e-1 0.06E+28 0x22} \
                 $double 0 $self] {{-100000.0 1.1 0.0 0.02 6e+26 34.0}}
 
+# gatherv
+set numargs \
+    "wrong # args: should be \"gatherv <data> <type> <root> <comm>\""
+run_error  [list gatherv] [list $numargs]
+run_error  [list gatherv {} $auto 0] [list $numargs]
+run_error  [list gatherv {} $auto 0 $comm xxx] [list $numargs]
+run_error  [list gatherv {} $auto 0 comm0] \
+    {{gatherv: unknown communicator: comm0}}
+run_error  [list gatherv {1 2} $int 0 $null] \
+    {gatherv: invalid communicator}
+run_error  [list gatherv {} $intint 0 $comm] \
+    {{gatherv: support for data type tclmpi::intint is not yet implemented}}
+run_error  [list gatherv {1 2 3} $int 1 $comm] \
+    {gatherv: invalid root}
+run_error  [list gatherv {} tclmpi::real 0 $comm]    \
+    {{gatherv: invalid data type: tclmpi::real}}
+run_return [list gatherv {hello world} $auto 0 $comm] {{{hello world}}}
+run_return [list gatherv {{xx 11} 2.5 yy 1} $double 0 $self] \
+    {{{0.0 2.5 0.0 1.0}}}
+run_return [list gatherv {} $int 0 $comm] {{{}}}
+
+# allgatherv
+set numargs \
+    "wrong # args: should be \"allgatherv <data> <type> <comm>\""
+run_error  [list allgatherv] [list $numargs]
+run_error  [list allgatherv {} $auto] [list $numargs]
+run_error  [list allgatherv {} $auto $comm xxx] [list $numargs]
+run_error  [list allgatherv {} $auto comm0] \
+    {{allgatherv: unknown communicator: comm0}}
+run_error  [list allgatherv {} $dblint $comm] \
+    {{allgatherv: support for data type tclmpi::dblint is not yet implemented}}
+run_return [list allgatherv {hello world} $auto $self] {{{hello world}}}
+run_return [list allgatherv {1 2 yy 016} $int $comm] {{{1 2 0 14}}}
+
+# scatterv
+set numargs \
+    "wrong # args: should be \"scatterv <data> <type> <root> <comm>\""
+run_error  [list scatterv] [list $numargs]
+run_error  [list scatterv {} $auto 0] [list $numargs]
+run_error  [list scatterv {} $auto 0 $comm xxx] [list $numargs]
+run_error  [list scatterv {} $auto 0 comm0] \
+    {{scatterv: unknown communicator: comm0}}
+run_error  [list scatterv {{1 2}} $int 0 $null] \
+    {scatterv: invalid communicator}
+run_error  [list scatterv {a b} $auto 0 $comm] \
+    {{scatterv: number of list elements must be the same as the number of processes}}
+run_return [list scatterv {{hello world}} $auto 0 $comm] {{hello world}}
+run_return [list scatterv {{1 2 yy}} $int 0 $self] {{1 2 0}}
+
+# alltoall
+set numargs \
+    "wrong # args: should be \"alltoall <data> <type> <comm>\""
+run_error  [list alltoall] [list $numargs]
+run_error  [list alltoall {} $auto] [list $numargs]
+run_error  [list alltoall {} $auto $comm xxx] [list $numargs]
+run_error  [list alltoall {} $auto comm0] \
+    {{alltoall: unknown communicator: comm0}}
+run_error  [list alltoall {} $intint $comm] \
+    {{alltoall: support for data type tclmpi::intint is not yet implemented}}
+run_error  [list alltoall {a b} $auto $comm] \
+    {{alltoall: number of list elements must be the same as the number of processes}}
+run_return [list alltoall {{hello world}} $auto $comm] {{{hello world}}}
+run_return [list alltoall {{1 2 yy}} $int $self] {{{1 2 0}}}
+run_return [list alltoall {{0.5 2}} $double $comm] {{{0.5 2.0}}}
+
+# alltoallv
+set numargs \
+    "wrong # args: should be \"alltoallv <data> <type> <comm>\""
+run_error  [list alltoallv] [list $numargs]
+run_error  [list alltoallv {} $auto] [list $numargs]
+run_error  [list alltoallv {} $auto $comm xxx] [list $numargs]
+run_error  [list alltoallv {} $auto comm0] \
+    {{alltoallv: unknown communicator: comm0}}
+run_error  [list alltoallv {} $intint $comm] \
+    {{alltoallv: support for data type tclmpi::intint is not yet implemented}}
+run_error  [list alltoallv {a b} $auto $comm] \
+    {{alltoallv: number of list elements must be the same as the number of processes}}
+run_return [list alltoallv {{hello world}} $auto $comm] {{{hello world}}}
+run_return [list alltoallv {{1 2 yy}} $int $self] {{{1 2 0}}}
+run_return [list alltoallv {{0.5 2}} $double $comm] {{{0.5 2.0}}}
+
 # allreduce
 set numargs \
     "wrong # args: should be \"allreduce <data> <type> <op> <comm>\""
@@ -260,6 +418,8 @@ run_error  [list allreduce {} $auto $mpi_sum] [list $numargs]
 run_error  [list allreduce {} $auto $mpi_prod $comm xxx] [list $numargs]
 run_error  [list allreduce {} $auto $mpi_max $comm]      \
     {{allreduce: does not support data type tclmpi::auto}}
+run_error  [list allreduce {} $bytes $mpi_max $comm]     \
+    {{allreduce: does not support data type tclmpi::bytes}}
 run_error  [list allreduce {} $int $mpi_max comm0]       \
     {{allreduce: unknown communicator: comm0}}
 run_error  [list allreduce {} $int $mpi_maxloc $comm]    \
@@ -303,6 +463,20 @@ run_return [list allreduce {{xx 11} {1 2 3} 2.5 yy 1}      \
 run_return [list allreduce {-1 2 +3 2.0 7 016}             \
                 $int tclmpi::prod $comm] {{-1 2 3 0 7 14}}
 
+# native data vectors returned from collectives can be passed on directly
+set idata [allreduce {-1 2 +3 016} $int tclmpi::sum $comm]
+set ddata [allreduce {0.5 2 -1e3} $double tclmpi::sum $comm]
+run_return [list allreduce $idata $int tclmpi::max $comm] {{-1 2 3 14}}
+run_return [list allreduce $idata $double tclmpi::sum $comm] \
+    {{-1.0 2.0 3.0 14.0}}
+run_return [list allreduce $ddata $double tclmpi::min $comm] \
+    {{0.5 2.0 -1000.0}}
+run_return [list allreduce $ddata $int tclmpi::sum $comm] {{0 0 0}}
+run_return [list lindex $ddata 2] {-1000.0}
+run_return [list llength $idata] {4}
+run_return [list lrange $idata 1 2] {{2 3}}
+run_return [list lreverse $ddata] {{-1000.0 2.0 0.5}}
+
 # reduce
 set numargs \
     "wrong # args: should be \"reduce <data> <type> <op> <root> <comm>\""
@@ -349,6 +523,341 @@ run_error  [list reduce {{2 1.1} {-1 -1}} $dblint \
 run_return [list reduce {{2 1 0} {1.0 1 0 0}} $dblint \
                 $mpi_minloc 0 $comm] {{{2.0 1} {1.0 1}}}
 
+# scan
+set numargs \
+    "wrong # args: should be \"::tclmpi::scan <data> <type> <op> <comm>\""
+run_error  [list ::tclmpi::scan] [list $numargs]
+run_error  [list ::tclmpi::scan {} $auto $mpi_sum] [list $numargs]
+run_error  [list ::tclmpi::scan {} $auto $mpi_sum $comm xxx] [list $numargs]
+run_error  [list ::tclmpi::scan {} $auto $mpi_max $comm] \
+    {{scan: does not support data type tclmpi::auto}}
+run_error  [list ::tclmpi::scan {} $int $mpi_max comm0] \
+    {{scan: unknown communicator: comm0}}
+run_error  [list ::tclmpi::scan {} $int $mpi_maxloc $comm] \
+    {scan: invalid mpi op}
+run_error  [list ::tclmpi::scan {{}} $int tclmpi::gamma $comm] \
+    {{scan: unknown reduction operator: tclmpi::gamma}}
+run_error  [list ::tclmpi::scan {2 0 1 1} $intint $mpi_maxloc $comm] \
+    {{scan: bad list format for loc reduction: tclmpi::maxloc}}
+run_error  [list ::tclmpi::scan {{2 1.1} {-1 -1}} $dblint $mpi_maxloc $comm] \
+    {{scan: bad location data for reduction: tclmpi::maxloc}}
+run_return [list ::tclmpi::scan {1 2 yy} $int $mpi_sum $comm] {{1 2 0}}
+run_return [list ::tclmpi::scan {0.5 -2} $double $mpi_prod $self] {{0.5 -2.0}}
+run_return [list ::tclmpi::scan {{2 1 0} {1.0 1 0 0}} $dblint $mpi_minloc $comm] \
+    {{{2.0 1} {1.0 1}}}
+
+# exscan
+set numargs \
+    "wrong # args: should be \"exscan <data> <type> <op> <comm>\""
+run_error  [list exscan] [list $numargs]
+run_error  [list exscan {} $auto $mpi_sum] [list $numargs]
+run_error  [list exscan {} $auto $mpi_sum $comm xxx] [list $numargs]
+run_error  [list exscan {} $auto $mpi_max $comm] \
+    {{exscan: does not support data type tclmpi::auto}}
+run_error  [list exscan {} $int $mpi_max comm0] \
+    {{exscan: unknown communicator: comm0}}
+run_error  [list exscan {} $int $mpi_maxloc $comm] \
+    {exscan: invalid mpi op}
+run_error  [list exscan {{}} $int tclmpi::gamma $comm] \
+    {{exscan: unknown reduction operator: tclmpi::gamma}}
+run_error  [list exscan {2 0 1 1} $intint $mpi_maxloc $comm] \
+    {{exscan: bad list format for loc reduction: tclmpi::maxloc}}
+run_error  [list exscan {{2 1.1} {-1 -1}} $dblint $mpi_maxloc $comm] \
+    {{exscan: bad location data for reduction: tclmpi::maxloc}}
+run_return [list exscan {1 2 yy} $int $mpi_sum $comm] {}
+run_return [list exscan {{2 1} {1 0}} $intint $mpi_minloc $comm] {}
+
+# reduce_scatter_block
+set numargs \
+    "wrong # args: should be \"reduce_scatter_block <data> <type> <op> <comm>\""
+run_error  [list reduce_scatter_block] [list $numargs]
+run_error  [list reduce_scatter_block {} $auto $mpi_sum] [list $numargs]
+run_error  [list reduce_scatter_block {} $auto $mpi_sum $comm xxx] [list $numargs]
+run_error  [list reduce_scatter_block {} $auto $mpi_max $comm] \
+    {{reduce_scatter_block: does not support data type tclmpi::auto}}
+run_error  [list reduce_scatter_block {} $int $mpi_max comm0] \
+    {{reduce_scatter_block: unknown communicator: comm0}}
+run_error  [list reduce_scatter_block {} $int $mpi_maxloc $comm] \
+    {reduce_scatter_block: invalid mpi op}
+run_error  [list reduce_scatter_block {{}} $int tclmpi::gamma $comm] \
+    {{reduce_scatter_block: unknown reduction operator: tclmpi::gamma}}
+run_error  [list reduce_scatter_block {2 0 1 1} $intint $mpi_maxloc $comm] \
+    {{reduce_scatter_block: bad list format for loc reduction: tclmpi::maxloc}}
+run_error  [list reduce_scatter_block {{2 1.1} {-1 -1}} $dblint $mpi_maxloc $comm] \
+    {{reduce_scatter_block: bad location data for reduction: tclmpi::maxloc}}
+run_return [list reduce_scatter_block {1 2 yy} $int $mpi_sum $comm] {{1 2 0}}
+run_return [list reduce_scatter_block {0.5 -2} $double $mpi_prod $self] {{0.5 -2.0}}
+run_return [list reduce_scatter_block {{2 1 0} {1.0 1 0 0}} $dblint $mpi_minloc $comm] \
+    {{{2.0 1} {1.0 1}}}
+
+# non-blocking collectives
+set numargs "wrong # args: should be \"ibarrier <comm>\""
+run_error  [list ibarrier] [list $numargs]
+run_error  [list ibarrier $comm xxx] [list $numargs]
+run_error  [list ibarrier comm0] {{ibarrier: unknown communicator: comm0}}
+run_return [list ibarrier $comm] {tclmpi::req0}
+run_return [list wait tclmpi::req0] {}
+set numargs \
+    "wrong # args: should be \"ibcast <data> <type> <root> <comm>\""
+run_error  [list ibcast] [list $numargs]
+run_error  [list ibcast {} $auto 0] [list $numargs]
+run_error  [list ibcast {} $auto 0 comm0] \
+    {{ibcast: unknown communicator: comm0}}
+run_error  [list ibcast {} $intint 0 $comm] \
+    {{ibcast: support for data type tclmpi::intint is not yet implemented}}
+run_return [list ibcast {hello world} $auto 0 $comm] {tclmpi::req1}
+run_return [list wait tclmpi::req1] {{hello world}}
+set numargs \
+    "wrong # args: should be \"iallreduce <data> <type> <op> <comm>\""
+run_error  [list iallreduce] [list $numargs]
+run_error  [list iallreduce {} $int $mpi_sum] [list $numargs]
+run_error  [list iallreduce {} $auto $mpi_sum $comm] \
+    {{iallreduce: does not support data type tclmpi::auto}}
+run_error  [list iallreduce {} $int tclmpi::gamma $comm] \
+    {{iallreduce: unknown reduction operator: tclmpi::gamma}}
+run_return [list iallreduce {1 2 yy} $int $mpi_sum $comm] {tclmpi::req2}
+run_return [list wait tclmpi::req2] {{1 2 0}}
+set numargs \
+    "wrong # args: should be \"ireduce <data> <type> <op> <root> <comm>\""
+run_error  [list ireduce] [list $numargs]
+run_error  [list ireduce {} $int $mpi_sum $comm] [list $numargs]
+run_error  [list ireduce {2 0 1 1} $intint $mpi_maxloc 0 $comm] \
+    {{ireduce: bad list format for loc reduction: tclmpi::maxloc}}
+run_return [list ireduce {{2 1 0} {1.0 1 0 0}} $dblint $mpi_minloc 0 $comm] \
+    {tclmpi::req3}
+run_return [list wait tclmpi::req3] {{{2.0 1} {1.0 1}}}
+set numargs \
+    "wrong # args: should be \"iallgather <data> <type> <comm>\""
+run_error  [list iallgather] [list $numargs]
+run_error  [list iallgather {} $int $comm xxx] [list $numargs]
+run_error  [list iallgather {} $auto $comm] \
+    {{iallgather: does not support data type tclmpi::auto}}
+run_return [list iallgather {0.5 -2} $double $self] {tclmpi::req4}
+run_return [list wait tclmpi::req4] {{0.5 -2.0}}
+set numargs \
+    "wrong # args: should be \"igather <data> <type> <root> <comm>\""
+run_error  [list igather] [list $numargs]
+run_error  [list igather {} $int $comm] [list $numargs]
+run_error  [list igather {} $intint 0 $comm] \
+    {{igather: support for data type tclmpi::intint is not yet implemented}}
+run_return [list igather {1 2} $int 0 $comm] {tclmpi::req5}
+run_return [list wait tclmpi::req5] {{1 2}}
+
+# persistent requests
+set numargs \
+    "wrong # args: should be \"send_init <data> <type> <dest> <tag> <comm>\""
+run_error  [list send_init] [list $numargs]
+run_error  [list send_init {} $int 0 0] [list $numargs]
+run_error  [list send_init {} $int 0 0 comm0] \
+    {{send_init: unknown communicator: comm0}}
+run_error  [list send_init {} $intint 0 0 $self] \
+    {{send_init: support for data type tclmpi::intint is not yet implemented}}
+run_return [list send_init {1 2 3} $int 0 1 $self] {tclmpi::req6}
+set numargs \
+    "wrong # args: should be \"recv_init <type> <count> <source> <tag> <comm>\""
+run_error  [list recv_init] [list $numargs]
+run_error  [list recv_init $int 3 0 1] [list $numargs]
+run_error  [list recv_init $int -1 0 1 $self] {{recv_init: invalid count: -1}}
+run_return [list recv_init $int 3 tclmpi::any_source 1 $self] {tclmpi::req7}
+set numargs "wrong # args: should be \"start <request> ?data?\""
+run_error  [list start] [list $numargs]
+run_error  [list start tclmpi::req6 {} xxx] [list $numargs]
+run_error  [list start tclmpi::req5] {{start: not a persistent request: tclmpi::req5}}
+run_error  [list start tclmpi::req6 {1 2}] \
+    {{start: number of data items does not match request: tclmpi::req6}}
+run_return [list start tclmpi::req7] {}
+run_error  [list start tclmpi::req7] {{start: request is already active: tclmpi::req7}}
+run_error  [list request_free tclmpi::req7] \
+    {{request_free: request is still active: tclmpi::req7}}
+run_return [list start tclmpi::req6] {}
+run_return [list wait tclmpi::req7] {{1 2 3}}
+run_return [list wait tclmpi::req6] {}
+run_return [list wait tclmpi::req6] {}
+set numargs "wrong # args: should be \"startall <requests> ?data?\""
+run_error  [list startall] [list $numargs]
+run_error  [list startall {tclmpi::req6 tclmpi::req7} {{4 5 6}}] \
+    {{startall: number of data items must match number of requests}}
+run_error  [list startall {tclmpi::req6 tclmpi::req5}] \
+    {{startall: not a persistent request: tclmpi::req5}}
+run_error  [list startall {tclmpi::req6 tclmpi::req7 tclmpi::req6}] \
+    {{startall: request is listed more than once: tclmpi::req6}}
+run_error  [list startall {tclmpi::req6 tclmpi::req5} {{7 8 9} {}}] \
+    {{startall: not a persistent request: tclmpi::req5}}
+run_return [list startall {tclmpi::req7 tclmpi::req6}] {}
+run_return [list wait tclmpi::req7] {{1 2 3}}
+run_return [list wait tclmpi::req6] {}
+run_return [list startall {tclmpi::req7 tclmpi::req6} {{} {4 5 6}}] {}
+run_return [list wait tclmpi::req7] {{4 5 6}}
+run_return [list wait tclmpi::req6] {}
+set numargs "wrong # args: should be \"request_free <request>\""
+run_error  [list request_free] [list $numargs]
+run_error  [list request_free tclmpi::req5] \
+    {{request_free: not a persistent request: tclmpi::req5}}
+run_return [list request_free tclmpi::req6] {}
+run_return [list request_free tclmpi::req7] {}
+run_error  [list start tclmpi::req6] {{start: not a persistent request: tclmpi::req6}}
+
+# combined send and receive
+set numargs "wrong # args: should be \"sendrecv <data> <type> <dest> <sendtag>\
+ <source> <recvtag> <comm> ?status?\""
+run_error  [list sendrecv] [list $numargs]
+run_error  [list sendrecv {} $int 0 0 0 0] [list $numargs]
+run_error  [list sendrecv {} $int 0 0 0 0 comm0] \
+    {{sendrecv: unknown communicator: comm0}}
+run_error  [list sendrecv {} xxx 0 0 0 0 $self] {{sendrecv: invalid data type: xxx}}
+run_error  [list sendrecv {} $dblint 0 0 0 0 $self] \
+    {{sendrecv: support for data type tclmpi::dblint is not yet implemented}}
+run_return [list sendrecv {1 2 3} $int 0 5 0 5 $self] {{1 2 3}}
+run_return [list sendrecv {hello world} $auto 0 5 tclmpi::any_source tclmpi::any_tag $self] \
+    {{hello world}}
+set numargs "wrong # args: should be \"sendrecv_replace <data> <type> <dest> <sendtag>\
+ <source> <recvtag> <comm> ?status?\""
+run_error  [list sendrecv_replace] [list $numargs]
+run_error  [list sendrecv_replace {} $int 0 0 0 0 comm0] \
+    {{sendrecv_replace: unknown communicator: comm0}}
+run_return [list sendrecv_replace {0.5 -1} $double 0 5 0 5 $self] {{0.5 -1.0}}
+
+# list access to received int and double vectors
+set ivec [sendrecv {4 -5 6 7} $int 0 6 0 6 $self]
+set dvec [sendrecv {1.5 -2 3e2} $double 0 6 0 6 $self]
+run_return [list lindex $ivec 3] {7}
+run_return [list lrange $ivec 1 2] {{-5 6}}
+run_return [list lreverse $ivec] {{7 6 -5 4}}
+run_return [list lindex $dvec 0] {1.5}
+run_return [list lrange $dvec 1 end] {{-2.0 300.0}}
+run_return [list lreverse $dvec] {{300.0 -2.0 1.5}}
+
+# waitall, waitany, waitsome, test and testall
+set numargs "wrong # args: should be \"waitall <requests> ?status?\""
+run_error  [list waitall] [list $numargs]
+run_error  [list waitall {} status xxx] [list $numargs]
+run_error  [list waitall "\{"] {{unmatched open brace in list}}
+run_return [list waitall {}] {}
+run_return [list irecv $int 0 11 $self] {tclmpi::req8}
+run_return [list isend {1 2} $int 0 11 $self] {tclmpi::req9}
+run_return [list waitall {tclmpi::req8 tclmpi::req9 tclmpi::req0} status] {{{1 2} {} {}}}
+set numargs "wrong # args: should be \"test <request> ?status?\""
+run_error  [list test] [list $numargs]
+run_error  [list test tclmpi::req0 status xxx] [list $numargs]
+run_return [list test tclmpi::req0] {{1 {}}}
+run_return [list irecv $auto 0 12 $self] {tclmpi::req10}
+run_return [list test tclmpi::req10] {{0 {}}}
+run_return [list isend {hello} $auto 0 12 $self] {tclmpi::req11}
+run_return [list test tclmpi::req10 status] {{1 hello}}
+run_return [list test tclmpi::req11] {{1 {}}}
+set numargs "wrong # args: should be \"testall <requests> ?status?\""
+run_error  [list testall] [list $numargs]
+run_return [list irecv $double 0 13 $self] {tclmpi::req12}
+run_return [list testall {tclmpi::req12}] {{0 {}}}
+run_return [list isend {0.5} $double 0 13 $self] {tclmpi::req13}
+run_return [list testall {tclmpi::req12 tclmpi::req13} status] {{1 {0.5 {}}}}
+set numargs "wrong # args: should be \"waitany <requests> ?status?\""
+run_error  [list waitany] [list $numargs]
+run_return [list waitany {}] {{-1 {}}}
+run_return [list irecv $int 0 14 $self] {tclmpi::req14}
+run_return [list irecv $int 0 15 $self] {tclmpi::req15}
+run_return [list isend {7} $int 0 15 $self] {tclmpi::req16}
+run_return [list waitany {tclmpi::req14 tclmpi::req15} status] {{1 7}}
+run_return [list waitany {tclmpi::req16}] {{0 {}}}
+set numargs "wrong # args: should be \"waitsome <requests> ?status?\""
+run_error  [list waitsome] [list $numargs]
+run_return [list waitsome {tclmpi::req15}] {}
+run_return [list isend {8 9} $int 0 14 $self] {tclmpi::req17}
+run_return [list waitsome {tclmpi::req14} status] {{{0 {8 9}}}}
+run_return [list waitall {tclmpi::req17}] {{{}}}
+
+# irecv with a capacity hint
+set numargs "wrong # args: should be \"irecv <type> <source> <tag> <comm> ?-maxcount <num>?\""
+run_error  [list irecv] [list $numargs]
+run_error  [list irecv $int 0 16 $self -maxcount] [list $numargs]
+run_error  [list irecv $int 0 16 $self -count 4] [list $numargs]
+run_error  [list irecv $int 0 16 $self -maxcount xx] {{expected integer but got "xx"}}
+run_error  [list irecv $int 0 16 $self -maxcount -1] {{irecv: invalid count: -1}}
+run_return [list irecv $int 0 16 $self -maxcount 10] {tclmpi::req18}
+run_return [list isend {1 2 3} $int 0 16 $self] {tclmpi::req19}
+run_return [list wait tclmpi::req18] {{1 2 3}}
+run_return [list wait tclmpi::req19] {}
+run_return [list irecv $auto 0 17 $self -maxcount 20] {tclmpi::req20}
+run_return [list irecv $bytes 0 18 $self -maxcount 20] {tclmpi::req21}
+run_return [list isend {hello world} $auto 0 17 $self] {tclmpi::req22}
+run_return [list isend {hello} $bytes 0 18 $self] {tclmpi::req23}
+run_return [list waitall {tclmpi::req20 tclmpi::req21 tclmpi::req22 tclmpi::req23}] \
+    {{{hello world} hello {} {}}}
+
+# event loop integration
+proc on_msg {source tag} {
+    set ::msg [list $source $tag [recv tclmpi::int $source $tag tclmpi::comm_self]]
+}
+proc on_done {req data} {
+    set ::done [list $req $data]
+}
+set numargs "wrong # args: should be \"onmessage <source> <tag> <comm> ?script?\""
+run_error  [list onmessage] [list $numargs]
+run_error  [list onmessage 0 19] [list $numargs]
+run_error  [list onmessage 0 19 $self on_msg xxx] [list $numargs]
+run_error  [list onmessage 0 19 comm0] {{onmessage: unknown communicator: comm0}}
+run_error  [list onmessage 0 xx $self] {{expected integer but got "xx"}}
+run_return [list onmessage 0 19 $self] {}
+run_return [list onmessage 0 19 $self on_msg] {}
+run_return [list onmessage 0 19 $self] {on_msg}
+run_return [list isend {1 2} $int 0 19 $self] {tclmpi::req24}
+run_return [list vwait ::msg] {}
+run_return [list set ::msg] {{0 19 {1 2}}}
+run_return [list onmessage 0 19 $self {}] {}
+run_return [list onmessage 0 19 $self] {}
+run_return [list wait tclmpi::req24] {}
+set numargs "wrong # args: should be \"oncomplete <request> ?script?\""
+run_error  [list oncomplete] [list $numargs]
+run_error  [list oncomplete tclmpi::req24 on_done xxx] [list $numargs]
+run_error  [list oncomplete tclmpi::req24] {{oncomplete: unknown request: tclmpi::req24}}
+run_return [list irecv $int 0 20 $self] {tclmpi::req25}
+run_return [list oncomplete tclmpi::req25 on_done] {}
+run_return [list oncomplete tclmpi::req25] {on_done}
+run_return [list isend {3} $int 0 20 $self] {tclmpi::req26}
+run_return [list vwait ::done] {}
+run_return [list set ::done] {{tclmpi::req25 3}}
+run_error  [list oncomplete tclmpi::req25] {{oncomplete: unknown request: tclmpi::req25}}
+run_return [list wait tclmpi::req26] {}
+
+# coroutine aware commands
+proc co_task {} {
+    set ::cores [tclmpi::co::recv tclmpi::int 0 21 tclmpi::comm_self]
+}
+run_return [list coroutine cotask co_task] {}
+run_return [list info commands cotask] {cotask}
+run_return [list tclmpi::co::send {4 5} $int 0 21 $self] {}
+run_return [list vwait ::cores] {}
+run_return [list set ::cores] {{4 5}}
+run_return [list info commands cotask] {}
+run_return [list tclmpi::co::allreduce {1 2} $int tclmpi::sum $self] {{1 2}}
+run_error  [list tclmpi::co::recv $int 0 21 $self -maxcount] \
+    {{wrong # args: should be "::tclmpi::irecv <type> <source> <tag> <comm> ?-maxcount <num>?"}}
+
+# many outstanding requests and reductions of pure strings
+proc many_reqs {num} {
+    set reqs {}
+    for {set i 0} {$i < $num} {incr i} {
+        lappend reqs [::tclmpi::irecv tclmpi::int 0 $i tclmpi::comm_self]
+    }
+    for {set i 0} {$i < $num} {incr i} {
+        lappend reqs [::tclmpi::isend [list $i] tclmpi::int 0 $i tclmpi::comm_self]
+    }
+    set res [::tclmpi::waitall $reqs]
+    set sum [::tclmpi::allreduce [lrange $res 0 $num-1] tclmpi::int tclmpi::max tclmpi::comm_self]
+    return [list [llength $res] [tcl::mathop::+ {*}$sum]]
+}
+run_return [list many_reqs 100] {{200 4950}}
+proc dup_reqs {cmd} {
+    set r [::tclmpi::irecv tclmpi::int 0 1 tclmpi::comm_self]
+    set s [::tclmpi::isend {1 2} tclmpi::int 0 1 tclmpi::comm_self]
+    return [::tclmpi::$cmd [list $s $s $r $r]]
+}
+run_return [list dup_reqs waitall] {{{} {} {1 2} {}}}
+run_return [list dup_reqs testall] {{1 {{} {} {1 2} {}}}}
+run_return [list dup_reqs waitsome] {{{0 {}} {2 {1 2}}}}
+run_return [list allreduce [join {1 2 3} " "] $double tclmpi::sum $self] {{1.0 2.0 3.0}}
+run_return [list reduce [join {4 5} " "] $int tclmpi::sum 0 $self] {{4 5}}
+
 # probe
 set numargs \
     "wrong # args: should be \"probe <source> <tag> <comm> ?status?\""
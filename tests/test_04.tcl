@@ -14,7 +14,8 @@
 # import and initialize test harness
 source harness.tcl
 namespace import tclmpi_test::*
-par_init
+# run the tests with a background progress thread
+par_init -progress 1000
 
 # import all API from namespace
 namespace import tclmpi::*
@@ -126,6 +127,11 @@ par_error [list [list set i 0]  \
 par_return [list [list comm_free tclmpi::comm3] \
                 [list set i 0] ] \
     [list {} {0}]
+# a freed communicator must not be found via a cached lookup
+par_error [list [list barrier $split2]  \
+                [list barrier $split2] ] \
+    [list {{barrier: unknown communicator: tclmpi::comm2}} \
+         {{barrier: unknown communicator: tclmpi::comm2}}]
 
 # bcast
 set idata [list {xx 11} {1 2 3} {}]
@@ -227,6 +233,103 @@ par_error [list [list gather {016 {1 2 3} 2.0} $double 0 $comm] \
                 [list gather {2.0 7 0xff yy} $double 0 $comm]] \
     [list [list $odata] [list $odata]]
 
+# data that is too large to be sent together with its length
+set idata {}
+set odata {}
+set ddata {}
+for {set i 0} {$i < 400} {incr i} {
+    lappend idata $i
+    lappend ddata [expr {double($i)}]
+    if {$i < 200} {lappend odata $i}
+}
+set rdata [string repeat "tclmpi " 200]
+par_return [list [list bcast $idata $int 0 $comm] \
+                [list bcast {} $int 0 $comm]] \
+    [list [list $idata] [list $idata]]
+par_return [list [list bcast {} $auto 1 $comm] \
+                [list bcast $rdata $auto 1 $comm]] \
+    [list [list $rdata] [list $rdata]]
+par_return [list [list scatter $idata $int 0 $comm] \
+                [list scatter {} $int 0 $comm]] \
+    [list [list $odata] [list [lrange $idata 200 end]]]
+par_return [list [list allgather $odata $int $comm] \
+                [list allgather [lrange $idata 200 end] $int $comm]] \
+    [list [list $idata] [list $idata]]
+par_error  [list [list bcast $idata $double 0 $comm] \
+                [list bcast {} $auto 0 $comm]] \
+    [list [list $ddata] {bcast: message truncated}]
+
+# data with a different length on each rank
+set sdata [list {hello} {tcl mpi world}]
+set idata [list {1 2 3} {}]
+set ddata [list {0.5} {1.5 2.5 3.5 4.5}]
+par_return [list [list gatherv [lindex $sdata 0] $auto 0 $comm] \
+                [list gatherv [lindex $sdata 1] $auto 0 $comm]] \
+    [list [list $sdata] {}]
+par_return [list [list gatherv [lindex $idata 0] $int 1 $comm] \
+                [list gatherv [lindex $idata 1] $int 1 $comm]] \
+    [list {} [list $idata]]
+par_return [list [list allgatherv [lindex $ddata 0] $double $comm] \
+                [list allgatherv [lindex $ddata 1] $double $comm]] \
+    [list [list $ddata] [list $ddata]]
+par_return [list [list allgatherv [lindex $sdata 0] $auto $comm] \
+                [list allgatherv [lindex $sdata 1] $auto $comm]] \
+    [list [list $sdata] [list $sdata]]
+par_return [list [list scatterv {} $double 1 $comm] \
+                [list scatterv $ddata $double 1 $comm]] \
+    [list [list [lindex $ddata 0]] [list [lindex $ddata 1]]]
+par_return [list [list scatterv $sdata $auto 0 $comm] \
+                [list scatterv {} $auto 0 $comm]] \
+    [list [list [lindex $sdata 0]] [list [lindex $sdata 1]]]
+par_return [list [list scatterv $idata $int 0 $comm] \
+                [list scatterv {} $int 0 $comm]] \
+    [list [list [lindex $idata 0]] {}]
+set msg "scatterv: number of list elements must be the same as the number of processes"
+par_error  [list [list scatterv $sdata $auto 1 $comm] \
+                [list scatterv [list {x}] $auto 1 $comm]] \
+    [list [list $msg] [list $msg]]
+par_return [list [list conv_set tclmpi::error] [list conv_set tclmpi::error]] [list {} {}]
+par_error  [list [list gatherv {1 x} $int 0 $comm] \
+                [list gatherv {2 3} $int 0 $comm]] \
+    [list {{expected integer but got}} \
+         {{gatherv: data conversion failed on another process}}]
+par_error  [list [list allgatherv {0.5 1.5} $double $comm] \
+                [list allgatherv {x} $double $comm]] \
+    [list {{allgatherv: data conversion failed on another process}} \
+         {{expected floating-point number but got}}]
+par_error  [list [list scatterv {} $int 1 $comm] \
+                [list scatterv {{1 2} {x}} $int 1 $comm]] \
+    [list {{scatterv: data conversion failed on the root process}} \
+         {{expected integer but got}}]
+par_return [list [list conv_set tclmpi::tozero] [list conv_set tclmpi::tozero]] [list {} {}]
+
+# all-to-all exchange
+par_return [list [list alltoall {{0 1} {2 3}} $int $comm] \
+                [list alltoall {{4 5} {6 7}} $int $comm]] \
+    [list {{{0 1} {4 5}}} {{{2 3} {6 7}}}]
+par_error  [list [list alltoall {{0 1} {2 3}} $int $comm] \
+                [list alltoall {{4 5} 6} $int $comm]] \
+    [list {{alltoall: number of data items must be the same}} \
+         {{alltoall: number of data items must be the same}}]
+par_return [list [list conv_set tclmpi::error] [list conv_set tclmpi::error]] [list {} {}]
+par_error  [list [list alltoall {{0 1} {2 x}} $int $comm] \
+                [list alltoall {{4 5} {6 7}} $int $comm]] \
+    [list {{expected integer but got}} \
+         {{alltoall: data conversion failed on another process}}]
+par_return [list [list conv_set tclmpi::tozero] [list conv_set tclmpi::tozero]] [list {} {}]
+par_return [list [list alltoallv [list {} [lindex $sdata 0]] $auto $comm] \
+                [list alltoallv [list {x y} [lindex $sdata 1]] $auto $comm]] \
+    [list [list [list {} {x y}]] [list $sdata]]
+par_return [list [list alltoallv [list {} [lindex $ddata 0]] $double $comm] \
+                [list alltoallv [list {1 2 3} [lindex $ddata 1]] $double $comm]] \
+    [list [list [list {} {1.0 2.0 3.0}]] [list [list [lindex $ddata 0] [lindex $ddata 1]]]]
+par_return [list [list conv_set tclmpi::error] [list conv_set tclmpi::error]] [list {} {}]
+par_error  [list [list alltoallv {{0 1} {2 3}} $int $comm] \
+                [list alltoallv {{4 5} {6 x}} $int $comm]] \
+    [list {{alltoallv: data conversion failed on another process}} \
+         {{expected integer but got}}]
+par_return [list [list conv_set tclmpi::tozero] [list conv_set tclmpi::tozero]] [list {} {}]
+
 # allreduce
 set idata {0 1 3 0 1 10}
 set odata {1 -1 0 0 1 18}
@@ -382,6 +485,33 @@ par_return [list [list reduce $idata $double $mpi_prod 1 $comm] \
                 [list reduce $odata $double $mpi_prod 1 $comm]] \
     [list {} [list $rdata]]
 
+# prefix reductions and reduce_scatter_block
+set msg "reduce_scatter_block: number of data items must be divisible"
+set idata {1 2 3 4}
+set odata {10 20 30 40}
+par_return [list [list ::tclmpi::scan $idata $int $mpi_sum $comm] \
+                [list ::tclmpi::scan $odata $int $mpi_sum $comm]] \
+    [list [list $idata] {{11 22 33 44}}]
+par_return [list [list exscan $idata $int $mpi_sum $comm] \
+                [list exscan $odata $int $mpi_sum $comm]] \
+    [list {} [list $idata]]
+par_return [list [list exscan {0.5 2.5} $double $mpi_max $comm] \
+                [list exscan {1.5 1.0} $double $mpi_max $comm]] \
+    [list {} {{0.5 2.5}}]
+par_return [list [list reduce_scatter_block $idata $int $mpi_sum $comm] \
+                [list reduce_scatter_block $odata $int $mpi_sum $comm]] \
+    [list {{11 22}} {{33 44}}]
+par_return [list [list ::tclmpi::scan {{5 0} {1 0}} $intint $mpi_maxloc $comm] \
+                [list ::tclmpi::scan {{3 1} {7 1}} $intint $mpi_maxloc $comm]] \
+    [list {{{5 0} {1 0}}} {{{5 0} {7 1}}}]
+par_error  [list [list reduce_scatter_block {1 2 3} $int $mpi_sum $comm] \
+                [list reduce_scatter_block {1 2 3} $int $mpi_sum $comm]] \
+    [list [list $msg] [list $msg]]
+par_error  [list [list reduce_scatter_block {1 2 3 4} $int $mpi_sum $comm] \
+                [list reduce_scatter_block {1 2} $int $mpi_sum $comm]] \
+    [list {{reduce_scatter_block: number of data items must be the same on all processes}} \
+         {{reduce_scatter_block: number of data items must be the same on all processes}}]
+
 # send/recv both blocking
 set idata [list 0 1 2 {3 4} 4 5 6]
 par_return [list [list send $idata $auto 1 666 $comm] \
@@ -395,6 +525,29 @@ par_return [list [list send $idata $double 1 666 $comm] \
                 [list recv $double 0 $any_tag $comm] ]  \
     [list {} [list $rdata]]
 
+# native data vectors can be passed on without conversion
+set idata [allreduce {1 2 3} $int tclmpi::sum $comm]
+par_return [list [list send $idata $int 1 666 $comm] \
+                [list recv $int 0 666 $comm] ] [list {} {{2 4 6}}]
+par_return [list [list recv $double 1 $any_tag $comm] \
+                [list send $idata $double 0 666 $comm] ] \
+    [list {{2.0 4.0 6.0}} {}]
+par_return [list [list bcast $idata $double 0 $comm] \
+                [list bcast {} $double 0 $comm] ] \
+    [list {{2.0 4.0 6.0}} {{2.0 4.0 6.0}}]
+
+# binary data is transferred from and to byte arrays without re-encoding
+set idata [binary format a4S abcd 0x4142]
+par_return [list [list send $idata $bytes 1 666 $comm] \
+                [list recv $bytes 0 666 $comm] ] [list {} {abcdab}]
+par_return [list [list bcast {} $bytes 1 $comm] \
+                [list bcast $idata $bytes 1 $comm] ] \
+    [list {abcdab} {abcdab}]
+set idata [encoding convertto utf-8 "\u00e4"]
+par_return [list [list recv $auto 1 666 $comm] \
+                [list send $idata $bytes 0 666 $comm] ] \
+    [list "\u00e4" {}]
+
 # pairs
 set idata {{-016 0} {2 0} {1.5 0} {2 -1} {two 0} {0x22 0}}
 set odata {{1 1} {-1 1} {-10 1} {0 1} {1 1} {18 1}}
@@ -467,6 +620,209 @@ par_return [list [list wait $req2] \
 par_return [list [list set i 0] [list wait $req2 status]] \
     [list {0} {{0 1 2 0 4 5 6}}]
 
+# non-blocking receive of binary data
+set req3 tclmpi::req3
+set idata [binary format a4S abcd 0x4142]
+par_return [list [list send $idata $bytes 1 66 $comm] \
+                [list irecv $bytes 0 66 $comm]] \
+    [list {} $req3]
+par_return [list [list set i 0] [list wait $req3]] \
+    [list {0} {abcdab}]
+
+# non-blocking send of a data vector, that changes its type before completion
+set vdata [allreduce {1 2 3} $int $mpi_sum $self]
+par_return [list [list isend $vdata $int 1 66 $comm] \
+                [list recv $int 0 66 $comm]] \
+    [list $req3 {{1 2 3}}]
+par_return [list [list lsort -decreasing $vdata] [list set i 0]] \
+    [list {3 2 1} {0}]
+par_return [list [list wait $req3] [list set i 0]] \
+    [list {} {0}]
+
+# non-blocking collectives
+set req4 tclmpi::req4
+set req5 tclmpi::req5
+set req6 tclmpi::req6
+set req7 tclmpi::req7
+set req8 tclmpi::req8
+set req9 tclmpi::req9
+set idata {1 2 3 4}
+set odata {10 20 30 40}
+par_return [list [list ibcast $idata $int 0 $comm] \
+                [list ibcast {} $int 0 $comm]] \
+    [list $req4 $req4]
+par_return [list [list iallreduce $idata $int $mpi_sum $comm] \
+                [list iallreduce $odata $int $mpi_sum $comm]] \
+    [list $req5 $req5]
+par_return [list [list wait $req5] [list wait $req4]] \
+    [list {{11 22 33 44}} [list $idata]]
+par_return [list [list wait $req4] [list wait $req5]] \
+    [list [list $idata] {{11 22 33 44}}]
+par_return [list [list igather $idata $int 1 $comm] \
+                [list igather $odata $int 1 $comm]] \
+    [list $req6 $req6]
+par_return [list [list ireduce {{5 0} {1 0}} $intint $mpi_maxloc 0 $comm] \
+                [list ireduce {{3 1} {7 1}} $intint $mpi_maxloc 0 $comm]] \
+    [list $req7 $req7]
+par_return [list [list ibarrier $comm] [list ibarrier $comm]] \
+    [list $req8 $req8]
+par_return [list [list wait $req6] [list wait $req6]] \
+    [list {} [list [concat $idata $odata]]]
+par_return [list [list wait $req7] [list wait $req7]] \
+    [list {{{5 0} {7 1}}} {}]
+par_return [list [list wait $req8] [list wait $req8]] \
+    [list {} {}]
+par_return [list [list iallgather {0.5} $double $comm] \
+                [list iallgather {1.5} $double $comm]] \
+    [list $req9 $req9]
+par_return [list [list wait $req9] [list wait $req9]] \
+    [list {{0.5 1.5}} {{0.5 1.5}}]
+par_return [list [list ibcast {} $auto 1 $comm] \
+                [list ibcast {hello world} $auto 1 $comm]] \
+    [list tclmpi::req10 tclmpi::req10]
+par_return [list [list wait tclmpi::req10] [list wait tclmpi::req10]] \
+    [list {{hello world}} {{hello world}}]
+par_error  [list [list ibcast $idata $double 0 $comm] \
+                [list ibcast {} $auto 0 $comm]] \
+    [list tclmpi::req11 {ibcast: message truncated}]
+par_return [list [list wait tclmpi::req11] [list set i 0]] \
+    [list {{1.0 2.0 3.0 4.0}} {0}]
+
+# persistent requests for a repeated exchange
+set sreq0 tclmpi::req12
+set rreq0 tclmpi::req13
+set sreq1 tclmpi::req11
+set rreq1 tclmpi::req12
+par_return [list [list send_init $idata $int 1 3 $comm] \
+                [list send_init $odata $int 0 3 $comm]] \
+    [list $sreq0 $sreq1]
+par_return [list [list recv_init $int 4 1 3 $comm] \
+                [list recv_init $int 4 $any_source 3 $comm]] \
+    [list $rreq0 $rreq1]
+par_return [list [list startall [list $rreq0 $sreq0]] \
+                [list startall [list $rreq1 $sreq1]]] \
+    [list {} {}]
+par_return [list [list wait $rreq0] [list wait $rreq1]] \
+    [list [list $odata] [list $idata]]
+par_return [list [list wait $sreq0] [list wait $sreq1]] \
+    [list {} {}]
+par_return [list [list startall [list $rreq0 $sreq0] {{} {5 6 7 8}}] \
+                [list startall [list $rreq1 $sreq1] {{} {50 60 70 80}}]] \
+    [list {} {}]
+par_return [list [list wait $rreq0] [list wait $rreq1]] \
+    [list {{50 60 70 80}} {{5 6 7 8}}]
+par_return [list [list wait $sreq0] [list wait $sreq1]] \
+    [list {} {}]
+par_return [list [list request_free $sreq0] [list request_free $sreq1]] \
+    [list {} {}]
+par_return [list [list request_free $rreq0] [list request_free $rreq1]] \
+    [list {} {}]
+par_return [list [list send_init {hello world} $auto 1 4 $comm] \
+                [list recv_init $auto 20 0 $any_tag $comm]] \
+    [list tclmpi::req14 tclmpi::req13]
+par_return [list [list start tclmpi::req14] [list start tclmpi::req13]] \
+    [list {} {}]
+par_return [list [list wait tclmpi::req14] [list wait tclmpi::req13]] \
+    [list {} {{hello world}}]
+par_return [list [list request_free tclmpi::req14] [list request_free tclmpi::req13]] \
+    [list {} {}]
+
+# combined send and receive
+par_return [list [list sendrecv $idata $int 1 7 1 8 $comm] \
+                [list sendrecv $odata $int 0 8 $any_source 7 $comm]] \
+    [list [list $odata] [list $idata]]
+par_return [list [list sendrecv {1 2} $double 1 7 1 7 $comm] \
+                [list sendrecv {0.5 1 1.5} $double 0 7 0 7 $comm]] \
+    [list {{0.5 1.0 1.5}} {{1.0 2.0}}]
+par_return [list [list sendrecv_replace {hello} $auto 1 9 1 9 $comm] \
+                [list sendrecv_replace {world} $auto 0 9 0 $any_tag $comm]] \
+    [list {world} {hello}]
+par_error  [list [list sendrecv_replace {1} $int 1 9 1 9 $comm] \
+                [list sendrecv_replace {2 3} $int 0 9 0 9 $comm]] \
+    [list {sendrecv_replace: message truncated} {1}]
+
+# waiting for and testing multiple requests
+par_return [list [list irecv $int 1 21 $comm] \
+                [list isend {1 2 3} $int 0 22 $comm]] \
+    [list tclmpi::req15 tclmpi::req14]
+par_return [list [list irecv $int 1 22 $comm] \
+                [list isend {4 5} $int 0 21 $comm]] \
+    [list tclmpi::req16 tclmpi::req15]
+par_return [list [list waitall {tclmpi::req15 tclmpi::req16}] \
+                [list waitall {tclmpi::req14 tclmpi::req15} status]] \
+    [list {{{4 5} {1 2 3}}} {{{} {}}}]
+par_return [list [list irecv $auto $any_source 23 $comm] \
+                [list isend {hello} $auto 0 24 $comm]] \
+    [list tclmpi::req17 tclmpi::req16]
+par_return [list [list irecv $auto $any_source 24 $comm] \
+                [list wait tclmpi::req16]] \
+    [list tclmpi::req18 {}]
+par_return [list [list waitany {tclmpi::req17 tclmpi::req18} status] \
+                [list test tclmpi::req16]] \
+    [list {{1 hello}} {{1 {}}}]
+par_return [list [list test tclmpi::req17] [list set i 0]] \
+    [list {{0 {}}} {0}]
+par_return [list [list waitsome {tclmpi::req18 tclmpi::req17}] \
+                [list isend {world} $auto 0 23 $comm]] \
+    [list {{{1 world}}} tclmpi::req17]
+par_return [list [list testall {}] [list waitall {tclmpi::req17}]] \
+    [list {{1 {}}} {{{}}}]
+
+# irecv with a capacity hint
+par_return [list [list irecv $double 1 31 $comm -maxcount 100] \
+                [list irecv $int 0 32 $comm -maxcount 2]] \
+    [list tclmpi::req19 tclmpi::req18]
+par_return [list [list send {1 2 3} $int 1 32 $comm] \
+                [list send {0.5 1.5} $double 0 31 $comm]] \
+    [list {} {}]
+par_error  [list [list wait tclmpi::req19] [list wait tclmpi::req18]] \
+    [list {{0.5 1.5}} {wait: message truncated}]
+
+# event loop integration
+proc on_msg {source tag} {
+    set ::msg [list $source $tag [recv tclmpi::int $source $tag tclmpi::comm_world]]
+}
+proc on_done {req data} {
+    set ::done [list $req $data]
+}
+par_return [list [list onmessage $any_source 40 $comm on_msg] \
+                [list send {5 6} $int 0 40 $comm]] \
+    [list {} {}]
+par_return [list [list vwait ::msg] [list set i 0]] [list {} 0]
+par_return [list [list set ::msg] [list onmessage $any_source 40 $comm]] \
+    [list {{1 40 {5 6}}} {}]
+par_return [list [list onmessage $any_source 40 $comm {}] \
+                [list irecv $int 0 41 $comm]] \
+    [list {} tclmpi::req19]
+par_return [list [list send {7} $int 1 41 $comm] \
+                [list oncomplete tclmpi::req19 on_done]] \
+    [list {} {}]
+par_return [list [list set i 0] [list vwait ::done]] [list 0 {}]
+par_return [list [list set i 0] [list set ::done]] [list 0 {{tclmpi::req19 7}}]
+
+# coroutine aware commands
+set codone 0
+proc co_recv {tag} {
+    set ::co($tag) [tclmpi::co::recv tclmpi::int 1 $tag tclmpi::comm_world]
+    incr ::codone
+}
+proc co_waitfor {num} {
+    while {$::codone < $num} {vwait ::codone}
+}
+proc co_sum {} {
+    set ::cosum [tclmpi::co::allreduce {1 2} tclmpi::int tclmpi::sum tclmpi::comm_world]
+}
+par_return [list [list coroutine co50 co_recv 50] [list set i 0]] [list {} 0]
+par_return [list [list coroutine co51 co_recv 51] [list tclmpi::co::send {51} $int 0 51 $comm]] \
+    [list {} {}]
+par_return [list [list co_waitfor 1] [list tclmpi::co::send {50} $int 0 50 $comm]] [list {} {}]
+par_return [list [list co_waitfor 2] [list set i 0]] [list {} 0]
+par_return [list [list array get ::co 50] [list array get ::co 51]] [list {50 50} {}]
+par_return [list [list array get ::co 51] [list set i 0]] [list {51 51} 0]
+par_return [list [list coroutine cosum co_sum] [list coroutine cosum co_sum]] [list {} {}]
+par_return [list [list vwait ::cosum] [list vwait ::cosum]] [list {} {}]
+par_return [list [list set ::cosum] [list set ::cosum]] [list {{2 4}} {{2 4}}]
+
 # print results and exit
 finalize
 test_summary 04